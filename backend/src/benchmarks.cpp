@@ -0,0 +1,408 @@
+#include "message_bus.hpp"
+#include "ring_buffer.hpp"
+#include "logger.hpp"
+#include "tick_codec.hpp"
+#include "synthetic_feed.hpp"
+#include <benchmark/benchmark.h>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Micro-benchmarks for the ring buffer, MessageBus and tick codec hot paths.
+//
+// Run before and after touching ring_buffer.hpp or message_bus.cpp, e.g.
+//   ./benchmarks --benchmark_format=json --benchmark_out=bench.json --benchmark_repetitions=5
+// Threads are pinned round-robin over the available CPUs (the benchmark thread
+// takes CPU 0, helpers start at CPU 1) so runs are comparable.
+
+using namespace lockfree;
+
+namespace {
+
+constexpr std::size_t RING_SIZE = 1024;
+using Ring = RingBuffer<uint64_t, RING_SIZE>;
+using WrapperRing = RingBuffer<MessageWrapper, RING_SIZE>;
+
+void pin_to_cpu(unsigned index) {
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+MarketData sample_tick(uint64_t i) {
+    MarketData md{};
+    std::strncpy(md.symbol, "BENCH", sizeof(md.symbol) - 1);
+    md.price = 100.0 + static_cast<double>(i % 100) * 0.01;
+    md.volume = 1.0;
+    md.timestamp = static_cast<int64_t>(i);
+    std::strncpy(md.source, "BENCH", sizeof(md.source) - 1);
+    return md;
+}
+
+// MessageBus over a fresh shared memory segment with a running consumer thread
+class BusFixture {
+public:
+    explicit BusFixture(int subscribers, std::atomic<uint64_t>& delivered) {
+        const std::string name = "bench_bus";
+        SharedMemory::remove(name);
+        const std::size_t ring_bytes = sizeof(RingBuffer<MessageWrapper, MessageBus::DEFAULT_RING_BUFFER_SIZE>);
+        bus_ = std::make_unique<MessageBus>(name, (ring_bytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE);
+        for (int i = 0; i < subscribers; ++i) {
+            bus_->subscribe<MarketData>("market_data", [&delivered](const MarketData&) {
+                delivered.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        consumer_ = std::thread([this]() {
+            pin_to_cpu(1);
+            bus_->process_messages(running_);
+        });
+    }
+
+    ~BusFixture() {
+        running_ = false;
+        consumer_.join();
+        bus_.reset();
+        SharedMemory::remove("bench_bus");
+    }
+
+    MessageBus& bus() { return *bus_; }
+
+    void wait_processed(uint64_t target) {
+        while (bus_->get_processed_count() < target) {
+            std::this_thread::yield();
+        }
+    }
+
+    // The benchmark thread is the only producer, so once this returns its
+    // next wanted publishes cannot fail and nothing is counted as dropped
+    void wait_for_space(std::size_t wanted = 1) const {
+        while (bus_->get_capacity() - bus_->get_size() < wanted) {
+        }
+    }
+
+private:
+    std::unique_ptr<MessageBus> bus_;
+    std::atomic<bool> running_{true};
+    std::thread consumer_;
+};
+
+} // namespace
+
+// Uncontended write + read on one thread: the cost of the index/sequence protocol itself
+static void BM_RingBufferWriteRead(benchmark::State& state) {
+    pin_to_cpu(0);
+    auto ring = std::make_unique<Ring>();
+    uint64_t value = 0;
+    for (auto _ : state) {
+        ring->write(value);
+        ring->read(value);
+        benchmark::DoNotOptimize(value);
+        ++value;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RingBufferWriteRead);
+
+// Same with the real bus payload, which is what the consumer copies out of the slot
+static void BM_RingBufferWriteReadMessage(benchmark::State& state) {
+    pin_to_cpu(0);
+    auto ring = std::make_unique<WrapperRing>();
+    MessageWrapper in;
+    to_wire(sample_tick(0), in);
+    MessageWrapper out;
+    for (auto _ : state) {
+        ring->write(in);
+        ring->read(out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(MessageWrapper));
+}
+BENCHMARK(BM_RingBufferWriteReadMessage);
+
+// Producer on this thread, consumer on another: sustained SPSC throughput
+static void BM_RingBufferSpscThroughput(benchmark::State& state) {
+    const uint64_t batch = static_cast<uint64_t>(state.range(0));
+    pin_to_cpu(0);
+    auto ring = std::make_unique<Ring>();
+    std::atomic<uint64_t> consumed{0};
+    std::atomic<bool> running{true};
+    std::thread consumer([&]() {
+        pin_to_cpu(1);
+        uint64_t value;
+        uint64_t count = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            if (ring->read(value)) {
+                consumed.store(++count, std::memory_order_release);
+            }
+        }
+    });
+
+    uint64_t produced = 0;
+    for (auto _ : state) {
+        for (uint64_t i = 0; i < batch; ++i) {
+            while (!ring->write(produced)) {
+            }
+            ++produced;
+        }
+        while (consumed.load(std::memory_order_acquire) < produced) {
+        }
+    }
+    running = false;
+    consumer.join();
+    state.SetItemsProcessed(static_cast<int64_t>(produced));
+}
+BENCHMARK(BM_RingBufferSpscThroughput)->Arg(1 << 16)->UseRealTime();
+
+// Round trip through two rings; half of the reported time is the one-way hand-off latency
+static void BM_RingBufferPingPong(benchmark::State& state) {
+    pin_to_cpu(0);
+    auto ping = std::make_unique<Ring>();
+    auto pong = std::make_unique<Ring>();
+    std::atomic<bool> running{true};
+    std::thread echo([&]() {
+        pin_to_cpu(1);
+        uint64_t value;
+        while (running.load(std::memory_order_relaxed)) {
+            if (ping->read(value)) {
+                while (!pong->write(value)) {
+                }
+            }
+        }
+    });
+
+    uint64_t value = 0;
+    for (auto _ : state) {
+        while (!ping->write(value)) {
+        }
+        while (!pong->read(value)) {
+        }
+        ++value;
+    }
+    running = false;
+    echo.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RingBufferPingPong)->UseRealTime();
+
+// N producers contending on write_index_ while this thread consumes
+static void BM_RingBufferMultiProducer(benchmark::State& state) {
+    const int producers = static_cast<int>(state.range(0));
+    constexpr uint64_t per_iteration = 1 << 14;
+    pin_to_cpu(0);
+    auto ring = std::make_unique<Ring>();
+    std::atomic<uint64_t> generation{0};
+    std::atomic<int> finished{0};
+    std::atomic<bool> running{true};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            pin_to_cpu(static_cast<unsigned>(p + 1));
+            uint64_t seen = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                if (generation.load(std::memory_order_acquire) == seen) {
+                    continue;
+                }
+                ++seen;
+                for (uint64_t i = 0; i < per_iteration / producers; ++i) {
+                    while (!ring->write(i)) {
+                    }
+                }
+                finished.fetch_add(1, std::memory_order_release);
+            }
+        });
+    }
+
+    const uint64_t expected = per_iteration / producers * producers;
+    uint64_t total = 0;
+    uint64_t value;
+    for (auto _ : state) {
+        finished.store(0, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+        uint64_t received = 0;
+        while (received < expected) {
+            if (ring->read(value)) {
+                ++received;
+            }
+        }
+        while (finished.load(std::memory_order_acquire) < producers) {
+        }
+        total += received;
+    }
+    running = false;
+    for (auto& t : threads) {
+        t.join();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(total));
+}
+BENCHMARK(BM_RingBufferMultiProducer)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+// publish() one tick at a time, waiting while the consumer catches up
+static void BM_MessageBusPublish(benchmark::State& state) {
+    const uint64_t batch = static_cast<uint64_t>(state.range(0));
+    pin_to_cpu(0);
+    std::atomic<uint64_t> delivered{0};
+    BusFixture fixture(1, delivered);
+    std::vector<MarketData> ticks;
+    for (uint64_t i = 0; i < batch; ++i) {
+        ticks.push_back(sample_tick(i));
+    }
+
+    uint64_t published = 0;
+    for (auto _ : state) {
+        for (const auto& tick : ticks) {
+            fixture.wait_for_space();
+            fixture.bus().publish("market_data", tick);
+        }
+        published += batch;
+        fixture.wait_processed(published);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(published));
+    state.counters["dropped"] = static_cast<double>(fixture.bus().get_dropped_count());
+}
+BENCHMARK(BM_MessageBusPublish)->Arg(256)->UseRealTime();
+
+// publish_batch() over the same ticks, one ring claim per PUBLISH_CHUNK;
+// submits no more than fits
+static void BM_MessageBusPublishBatch(benchmark::State& state) {
+    const uint64_t batch = static_cast<uint64_t>(state.range(0));
+    pin_to_cpu(0);
+    std::atomic<uint64_t> delivered{0};
+    BusFixture fixture(1, delivered);
+    std::vector<MarketData> ticks;
+    for (uint64_t i = 0; i < batch; ++i) {
+        ticks.push_back(sample_tick(i));
+    }
+
+    uint64_t published = 0;
+    for (auto _ : state) {
+        std::size_t offset = 0;
+        while (offset < ticks.size()) {
+            const std::size_t wanted = std::min<std::size_t>(ticks.size() - offset, MessageBus::PUBLISH_CHUNK);
+            fixture.wait_for_space(wanted);
+            offset += fixture.bus().publish_batch("market_data", ticks.data() + offset, wanted);
+        }
+        published += batch;
+        fixture.wait_processed(published);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(published));
+    state.counters["dropped"] = static_cast<double>(fixture.bus().get_dropped_count());
+}
+BENCHMARK(BM_MessageBusPublishBatch)->Arg(256)->UseRealTime();
+
+// One message delivered to N subscriber callbacks on the consumer thread
+static void BM_MessageBusFanOut(benchmark::State& state) {
+    const int subscribers = static_cast<int>(state.range(0));
+    constexpr uint64_t batch = 256;
+    pin_to_cpu(0);
+    std::atomic<uint64_t> delivered{0};
+    BusFixture fixture(subscribers, delivered);
+    const MarketData tick = sample_tick(0);
+
+    uint64_t published = 0;
+    for (auto _ : state) {
+        for (uint64_t i = 0; i < batch; ++i) {
+            fixture.wait_for_space();
+            fixture.bus().publish("market_data", tick);
+        }
+        published += batch;
+        fixture.wait_processed(published);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(published));
+    state.counters["deliveries_per_second"] = benchmark::Counter(
+        static_cast<double>(delivered.load()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MessageBusFanOut)->Arg(1)->Arg(4)->Arg(16)->Arg(64)->UseRealTime();
+
+// Random-walk ticks over 16 symbols at a jittered ~1 ms cadence, the shape of
+// a replay capture
+struct TickSample {
+    std::vector<int64_t> timestamps_ns, prices, volumes;
+    std::vector<uint16_t> symbol_ids;
+
+    explicit TickSample(std::size_t rows)
+        : timestamps_ns(rows), prices(rows), volumes(rows), symbol_ids(rows) {
+        std::mt19937_64 rng(42);
+        std::vector<int64_t> last(16, 4312345);
+        int64_t t = 1700000000000000000;
+        for (std::size_t i = 0; i < rows; ++i) {
+            const auto id = static_cast<uint16_t>(rng() % 16);
+            t += 1000000 + static_cast<int64_t>(rng() % 1000);
+            last[id] += static_cast<int64_t>(rng() % 7) - 3;
+            timestamps_ns[i] = t;
+            prices[i] = last[id];
+            volumes[i] = static_cast<int64_t>(rng() % 1000) * 1000000;
+            symbol_ids[i] = id;
+        }
+    }
+
+    TickColumns columns() const {
+        return {timestamps_ns.data(), prices.data(), volumes.data(), symbol_ids.data(), symbol_ids.size()};
+    }
+};
+
+static void BM_TickCodecEncode(benchmark::State& state) {
+    const TickSample sample(static_cast<std::size_t>(state.range(0)));
+    std::vector<uint8_t> encoded;
+    for (auto _ : state) {
+        encoded.clear();
+        encode_tick_block(sample.columns(), encoded);
+        benchmark::DoNotOptimize(encoded.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.counters["bytes_per_row"] = static_cast<double>(encoded.size()) / static_cast<double>(state.range(0));
+}
+BENCHMARK(BM_TickCodecEncode)->Arg(65536);
+
+static void BM_TickCodecDecode(benchmark::State& state) {
+    const std::size_t rows = static_cast<std::size_t>(state.range(0));
+    const TickSample sample(rows);
+    std::vector<uint8_t> encoded;
+    encode_tick_block(sample.columns(), encoded);
+    TickSample out(rows);
+    for (auto _ : state) {
+        const bool ok = decode_tick_block(encoded.data(), encoded.size(), rows, out.timestamps_ns.data(),
+                                          out.prices.data(), out.volumes.data(), out.symbol_ids.data());
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    // Raw columns are 26 bytes per row
+    state.counters["compression_ratio"] = static_cast<double>(rows * 26) / static_cast<double>(encoded.size());
+}
+BENCHMARK(BM_TickCodecDecode)->Arg(65536);
+
+// Synthetic ticks per second over range(0) Zipf-weighted symbols, with the
+// default bursts and random walk
+static void BM_SyntheticFeed(benchmark::State& state) {
+    SyntheticFeedConfig config;
+    config.symbols = static_cast<uint32_t>(state.range(0));
+    config.rows = 0;
+    SyntheticFeed feed(config);
+    SyntheticTick tick{};
+    for (auto _ : state) {
+        feed.next(tick);
+        benchmark::DoNotOptimize(tick);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_SyntheticFeed)->Arg(100)->Arg(10000);
+
+int main(int argc, char** argv) {
+    // Keep MessageBus construction chatter out of the results
+    Logger::instance().set_level(LogLevel::WARN);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
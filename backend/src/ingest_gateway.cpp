@@ -0,0 +1,288 @@
+#include "ingest_gateway.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "logger.hpp"
+#include <stdexcept>
+#include <vector>
+#include <boost/beast/core/flat_buffer.hpp>
+
+namespace lockfree {
+
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+class IngestGateway::Connection : public std::enable_shared_from_this<Connection> {
+public:
+    static constexpr std::size_t READ_CHUNK = 256 * 1024;
+
+    Connection(tcp::socket socket, IngestGateway& gateway)
+        : socket_(std::move(socket))
+        , gateway_(gateway)
+        , credit_timer_(socket_.get_executor()) {
+        gateway_.connections_.fetch_add(1, std::memory_order_relaxed);
+        socket_.set_option(tcp::no_delay(true));
+    }
+
+    ~Connection() {
+        gateway_.outstanding_credit_.fetch_sub(outstanding(), std::memory_order_relaxed);
+        gateway_.connections_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void start() {
+        update_credit();
+        do_read();
+    }
+
+private:
+    void do_read() {
+        socket_.async_read_some(buffer_.prepare(READ_CHUNK),
+            [self = shared_from_this()](boost::system::error_code ec, std::size_t n) {
+                self->on_read(ec, n);
+            });
+    }
+
+    void on_read(boost::system::error_code ec, std::size_t bytes_transferred) {
+        if (ec) {
+            if (ec != net::error::eof && ec != net::error::operation_aborted) {
+                LOG_WARN("[IngestGateway] read error: " << ec.message());
+            }
+            close();
+            return;
+        }
+        buffer_.commit(bytes_transferred);
+        read_ns_ = monotonic_ns();
+
+        if (!drain_frames()) {
+            close();
+            return;
+        }
+        update_credit();
+        do_read();
+    }
+
+    // Decode every complete frame currently buffered. Returns false on a protocol error.
+    bool drain_frames() {
+        while (buffer_.size() >= sizeof(wire::FrameHeader)) {
+            const char* data = static_cast<const char*>(buffer_.data().data());
+            wire::FrameHeader header;
+            std::memcpy(&header, data, sizeof(header));
+
+            const auto type = static_cast<wire::FrameType>(header.type);
+            if ((type != wire::FrameType::TICK && type != wire::FrameType::BATCH) ||
+                header.count == 0 || header.count > wire::MAX_BATCH_RECORDS ||
+                (type == wire::FrameType::TICK && header.count != 1) ||
+                header.length != header.count * sizeof(MarketData)) {
+                LOG_WARN("[IngestGateway] protocol error: type=" << header.type
+                          << " count=" << header.count << " length=" << header.length);
+                return false;
+            }
+            if (buffer_.size() < sizeof(header) + header.length) {
+                return true; // Wait for the rest of the frame
+            }
+
+            handle_records(header, data + sizeof(header));
+            buffer_.consume(sizeof(header) + header.length);
+        }
+        return true;
+    }
+
+    void handle_records(const wire::FrameHeader& header, const char* payload) {
+        // Sequence tracking: the first frame fixes the starting point
+        if (!seq_initialized_) {
+            expected_seq_ = header.seq;
+            seq_initialized_ = true;
+        }
+        if (header.seq != expected_seq_) {
+            gateway_.sequence_gaps_.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARN_RATE_LIMITED(1000, "[IngestGateway] sequence gap: expected " << expected_seq_
+                      << ", got " << header.seq);
+        }
+        expected_seq_ = header.seq + header.count;
+
+        // Only records within the grant are published; the rest are dropped
+        const std::size_t credited = std::min<uint64_t>(header.count, outstanding());
+        if (credited < header.count) {
+            const std::size_t over = header.count - credited;
+            over_credit_ += over;
+            dropped_ += over;
+            gateway_.over_credit_count_.fetch_add(over, std::memory_order_relaxed);
+            LOG_WARN_RATE_LIMITED(1000, "[IngestGateway] producer sent " << over
+                      << " records beyond its credit limit " << credit_limit_);
+        }
+        gateway_.outstanding_credit_.fetch_sub(credited, std::memory_order_relaxed);
+        records_received_ += header.count;
+        gateway_.received_count_.fetch_add(header.count, std::memory_order_relaxed);
+        if (credited == 0) {
+            return;
+        }
+
+        batch_.resize(credited);
+        std::memcpy(batch_.data(), payload, credited * sizeof(MarketData));
+        for (auto& md : batch_) {
+            md.symbol[sizeof(md.symbol) - 1] = '\0';
+            md.source[sizeof(md.source) - 1] = '\0';
+        }
+
+        const std::size_t accepted = gateway_.message_bus_->publish_batch("market_data", batch_.data(), batch_.size(), read_ns_);
+        dropped_ += batch_.size() - accepted;
+    }
+
+    // Credits granted but not yet used
+    uint64_t outstanding() const {
+        return credit_limit_ - std::min(records_received_, credit_limit_);
+    }
+
+    // Grant as much of this connection's share of the ring as it may hold and tell the producer
+    void update_credit() {
+        const uint64_t outstanding_now = outstanding();
+        const uint64_t max_window = gateway_.max_window();
+        const uint64_t room = max_window > outstanding_now ? max_window - outstanding_now : 0;
+        const uint64_t grant = std::min(gateway_.available_window(), room);
+
+        // Only write when the grant is meaningful or the producer is stalled on us
+        if (grant > 0 && (outstanding_now == 0 || grant >= max_window / 4)) {
+            // A producer that overran its limit starts again from what it sent
+            credit_limit_ = std::max(credit_limit_, records_received_) + grant;
+            gateway_.outstanding_credit_.fetch_add(grant, std::memory_order_relaxed);
+            send_credit();
+        }
+
+        if (outstanding() == 0 && !timer_armed_) {
+            // Out of credit and none to grant: poll until the consumer frees some room
+            timer_armed_ = true;
+            credit_timer_.expires_after(std::chrono::milliseconds(1));
+            credit_timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+                self->timer_armed_ = false;
+                if (!ec && self->socket_.is_open()) {
+                    self->update_credit();
+                }
+            });
+        }
+    }
+
+    void send_credit() {
+        if (write_in_progress_) {
+            credit_pending_ = true;
+            return;
+        }
+        wire::FrameHeader header{};
+        header.length = sizeof(wire::CreditGrant);
+        header.type = static_cast<uint16_t>(wire::FrameType::CREDIT);
+        header.seq = expected_seq_;
+        wire::CreditGrant grant{credit_limit_, expected_seq_, dropped_, over_credit_};
+        std::memcpy(credit_out_, &header, sizeof(header));
+        std::memcpy(credit_out_ + sizeof(header), &grant, sizeof(grant));
+
+        write_in_progress_ = true;
+        net::async_write(socket_, net::buffer(credit_out_),
+            [self = shared_from_this()](boost::system::error_code ec, std::size_t) {
+                self->write_in_progress_ = false;
+                if (ec) {
+                    self->close();
+                    return;
+                }
+                if (self->credit_pending_) {
+                    self->credit_pending_ = false;
+                    self->send_credit();
+                }
+            });
+    }
+
+    void close() {
+        boost::system::error_code ignored;
+        credit_timer_.cancel();
+        socket_.shutdown(tcp::socket::shutdown_both, ignored);
+        socket_.close(ignored);
+    }
+
+    tcp::socket socket_;
+    IngestGateway& gateway_;
+    net::steady_timer credit_timer_;
+    boost::beast::flat_buffer buffer_;
+    std::vector<MarketData> batch_;
+    char credit_out_[sizeof(wire::FrameHeader) + sizeof(wire::CreditGrant)];
+
+    int64_t read_ns_ = 0;  // Ingest stamp for the frames decoded from the latest read
+    uint64_t expected_seq_ = 0;
+    bool seq_initialized_ = false;
+    uint64_t records_received_ = 0;
+    uint64_t credit_limit_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t over_credit_ = 0;
+    bool write_in_progress_ = false;
+    bool credit_pending_ = false;
+    bool timer_armed_ = false;
+};
+
+IngestGateway::IngestGateway(std::shared_ptr<MessageBus> message_bus, const std::string& address, unsigned short port)
+    : message_bus_(std::move(message_bus))
+    , acceptor_(ioc_) {
+    boost::system::error_code ec;
+    tcp::endpoint endpoint(net::ip::make_address(address), port);
+
+    acceptor_.open(endpoint.protocol(), ec);
+    if (ec) {
+        throw std::runtime_error("Failed to open ingest acceptor: " + ec.message());
+    }
+    acceptor_.set_option(net::socket_base::reuse_address(true), ec);
+    if (ec) {
+        throw std::runtime_error("Failed to set reuse address: " + ec.message());
+    }
+    acceptor_.bind(endpoint, ec);
+    if (ec) {
+        throw std::runtime_error("Failed to bind ingest gateway: " + ec.message());
+    }
+    acceptor_.listen(net::socket_base::max_listen_connections, ec);
+    if (ec) {
+        throw std::runtime_error("Failed to listen on ingest gateway: " + ec.message());
+    }
+}
+
+IngestGateway::~IngestGateway() {
+    stop();
+}
+
+void IngestGateway::start() {
+    do_accept();
+    io_thread_ = std::thread([this]() {
+        ioc_.run();
+    });
+}
+
+void IngestGateway::stop() {
+    ioc_.stop();
+    if (io_thread_.joinable()) {
+        io_thread_.join();
+    }
+}
+
+uint64_t IngestGateway::available_window() const {
+    const std::size_t capacity = message_bus_->get_capacity();
+    const std::size_t size = std::min(message_bus_->get_size(), capacity);
+    const uint64_t free_slots = capacity - size;
+    const uint64_t granted = outstanding_credit_.load(std::memory_order_relaxed);
+    const uint64_t unpromised = free_slots > granted ? free_slots - granted : 0;
+    return unpromised / std::max<uint64_t>(1, connections_.load(std::memory_order_relaxed));
+}
+
+uint64_t IngestGateway::max_window() const {
+    // A quarter of the ring at most, so one idle producer cannot sit on all of it
+    return std::max<uint64_t>(std::min<uint64_t>(MAX_WINDOW, message_bus_->get_capacity() / 4), 1);
+}
+
+void IngestGateway::do_accept() {
+    acceptor_.async_accept(
+        [this](boost::system::error_code ec, tcp::socket socket) {
+            if (!ec) {
+                std::make_shared<Connection>(std::move(socket), *this)->start();
+            } else {
+                LOG_WARN("[IngestGateway] accept error: " << ec.message());
+            }
+            if (acceptor_.is_open()) {
+                do_accept();
+            }
+        });
+}
+
+} // namespace lockfree
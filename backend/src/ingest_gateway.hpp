@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <boost/asio.hpp>
+#include "message_bus.hpp"
+
+namespace lockfree {
+
+// Binary ingest wire protocol (host byte order, little-endian on all supported targets).
+//
+// Every frame starts with a FrameHeader. Producers send TICK (one MarketData
+// record) or BATCH (header.count records back to back) frames; the payload is
+// exactly count * sizeof(MarketData) bytes. header.seq is the producer's
+// sequence number of the first record, so a BATCH covers [seq, seq + count).
+//
+// The gateway answers with CREDIT frames carrying a CreditGrant. credit_limit
+// counts records, not sequence numbers: a producer may have sent at most
+// credit_limit records in total since it connected, whatever its seq values.
+// Records beyond the limit are dropped unpublished and counted in
+// over_credit. Grants only cover ring space that is free and not already
+// granted, split between the connections, so producers together cannot
+// overrun the consumer.
+namespace wire {
+
+enum class FrameType : uint16_t {
+    TICK = 1,
+    BATCH = 2,
+    CREDIT = 16
+};
+
+struct FrameHeader {
+    uint32_t length;    // Payload bytes following the header
+    uint16_t type;      // FrameType
+    uint16_t count;     // Records in the payload
+    uint64_t seq;       // Producer sequence of the first record
+};
+
+struct CreditGrant {
+    uint64_t credit_limit;  // Records the producer may have sent in total on this connection
+    uint64_t next_seq;      // Next sequence the gateway expects
+    uint64_t dropped;       // Records this connection lost to a full ring
+    uint64_t over_credit;   // Records this connection sent beyond credit_limit (also dropped)
+};
+
+static_assert(sizeof(FrameHeader) == 16, "FrameHeader must be 16 bytes");
+static_assert(std::is_trivially_copyable_v<MarketData>, "MarketData must be memcpy-able on the wire");
+
+constexpr uint16_t MAX_BATCH_RECORDS = 4096;
+
+} // namespace wire
+
+// Length-prefixed binary TCP listener that writes producer records straight
+// into the MessageBus ring. Runs its own io_context thread so JSON/HTTP
+// traffic never competes with bulk feed handlers.
+class IngestGateway {
+public:
+    // Upper bound on credits outstanding for one connection (see max_window())
+    static constexpr uint64_t MAX_WINDOW = 4096;
+
+    IngestGateway(std::shared_ptr<MessageBus> message_bus, const std::string& address, unsigned short port);
+    ~IngestGateway();
+
+    void start();
+    void stop();
+
+    // Port actually bound, e.g. when constructed with port 0
+    unsigned short port() const { return acceptor_.local_endpoint().port(); }
+
+    // Further credits one connection may be granted: its share of the ring
+    // slots that are free and not already granted
+    uint64_t available_window() const;
+    // Credits one connection may hold: MAX_WINDOW or a quarter of the ring
+    uint64_t max_window() const;
+
+    uint64_t get_connection_count() const { return connections_.load(); }
+    uint64_t get_received_count() const { return received_count_.load(); }
+    uint64_t get_sequence_gaps() const { return sequence_gaps_.load(); }
+    uint64_t get_over_credit_count() const { return over_credit_count_.load(); }
+
+private:
+    class Connection;
+
+    void do_accept();
+
+    std::shared_ptr<MessageBus> message_bus_;
+
+    // Declared before ioc_ so they outlive it: connections still queued on
+    // ioc_ are destroyed with it and update them from ~Connection
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint64_t> received_count_{0};
+    std::atomic<uint64_t> sequence_gaps_{0};
+    std::atomic<uint64_t> over_credit_count_{0};
+    std::atomic<uint64_t> outstanding_credit_{0};  // Granted but not yet received, all connections
+
+    boost::asio::io_context ioc_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread io_thread_;
+};
+
+} // namespace lockfree
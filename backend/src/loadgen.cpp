@@ -0,0 +1,474 @@
+// Load generator for the market data server.
+//
+// Opens many /ws clients, drives /api/publish and /api/publish_bulk at fixed
+// rates and reports delivered throughput, per-client lag (by MarketData::seq)
+// and end-to-end latency (receive time minus MarketData::timestamp). Runs
+// entirely against a local server:
+//
+//   ./loadgen --clients 2000 --publish-rate 5000 --bulk-rate 20 --bulk-count 500 --duration 30
+//
+// timestamp is the server's millisecond wall clock, so latency has 1ms resolution.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/websocket.hpp>
+#include <nlohmann/json.hpp>
+#include "metrics.hpp"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+using json = nlohmann::json;
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    unsigned short port = 8080;
+    int clients = 100;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    double duration_s = 10;
+    double publish_rate = 1000;  // /api/publish requests per second
+    double bulk_rate = 0;        // /api/publish_bulk requests per second
+    int bulk_count = 100;        // ticks per publish_bulk request
+    int max_inflight = 64;       // concurrent HTTP requests
+    int drain_ms = 1000;         // keep reading after publishers stop
+    bool json_only = false;
+};
+
+void usage() {
+    std::cerr << "usage: loadgen [--host H] [--port P] [--clients N] [--threads T] [--duration S]\n"
+                 "               [--publish-rate R] [--bulk-rate R] [--bulk-count N]\n"
+                 "               [--max-inflight N] [--drain-ms MS] [--json]\n";
+}
+
+bool parse_args(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--json") {
+            opts.json_only = true;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--host") opts.host = value;
+        else if (arg == "--port") opts.port = static_cast<unsigned short>(std::stoi(value));
+        else if (arg == "--clients") opts.clients = std::stoi(value);
+        else if (arg == "--threads") opts.threads = std::max(1, std::stoi(value));
+        else if (arg == "--duration") opts.duration_s = std::stod(value);
+        else if (arg == "--publish-rate") opts.publish_rate = std::stod(value);
+        else if (arg == "--bulk-rate") opts.bulk_rate = std::stod(value);
+        else if (arg == "--bulk-count") opts.bulk_count = std::stoi(value);
+        else if (arg == "--max-inflight") opts.max_inflight = std::max(1, std::stoi(value));
+        else if (arg == "--drain-ms") opts.drain_ms = std::stoi(value);
+        else return false;
+    }
+    return true;
+}
+
+int64_t wall_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Shared by every client; all fields are updated from the io threads
+struct Stats {
+    std::atomic<uint64_t> ws_connected{0};
+    std::atomic<uint64_t> ws_failed{0};
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> gaps{0};
+    std::atomic<uint64_t> max_seq{0};
+    std::atomic<uint64_t> publish_ok{0};
+    std::atomic<uint64_t> publish_rejected{0};  // 503 Buffer full and other non-2xx
+    std::atomic<uint64_t> publish_errors{0};    // Connect/IO failures
+    std::atomic<uint64_t> publish_skipped{0};   // Not sent: max_inflight reached
+    std::atomic<uint64_t> bulk_ticks{0};
+    lockfree::LatencyHistogram latency;           // Whole run
+    lockfree::LatencyHistogram interval_latency;  // Reset by every progress line
+};
+
+// Pulls an unsigned integer field out of the server's compact JSON without a full parse
+bool extract_uint(const std::string& text, const char* key, uint64_t& out) {
+    const auto pos = text.find(key);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    out = std::strtoull(text.c_str() + pos + std::strlen(key), nullptr, 10);
+    return true;
+}
+
+class WsClient : public std::enable_shared_from_this<WsClient> {
+public:
+    WsClient(net::io_context& ioc, const Options& opts, Stats& stats)
+        : ws_(ioc), opts_(opts), stats_(stats) {}
+
+    void start(const tcp::endpoint& endpoint) {
+        beast::get_lowest_layer(ws_).async_connect(endpoint,
+            [self = shared_from_this()](beast::error_code ec) {
+                if (ec) {
+                    self->stats_.ws_failed.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                self->ws_.async_handshake(self->opts_.host, "/ws",
+                    [self](beast::error_code ec) {
+                        if (ec) {
+                            self->stats_.ws_failed.fetch_add(1, std::memory_order_relaxed);
+                            return;
+                        }
+                        self->stats_.ws_connected.fetch_add(1, std::memory_order_relaxed);
+                        self->do_read();
+                    });
+            });
+    }
+
+    void close() {
+        net::post(ws_.get_executor(), [self = shared_from_this()]() {
+            beast::get_lowest_layer(self->ws_).close();
+        });
+    }
+
+    uint64_t last_seq() const { return last_seq_.load(std::memory_order_relaxed); }
+    uint64_t received() const { return received_.load(std::memory_order_relaxed); }
+
+private:
+    void do_read() {
+        ws_.async_read(buffer_, [self = shared_from_this()](beast::error_code ec, std::size_t) {
+            if (ec) {
+                return;
+            }
+            self->on_message();
+            self->do_read();
+        });
+    }
+
+    void on_message() {
+        const std::string text = beast::buffers_to_string(buffer_.data());
+        buffer_.consume(buffer_.size());
+        if (text.find("\"type\":\"market_data\"") == std::string::npos) {
+            return; // stats frames
+        }
+        uint64_t seq = 0;
+        uint64_t timestamp_ms = 0;
+        if (!extract_uint(text, "\"seq\":", seq) || !extract_uint(text, "\"timestamp\":", timestamp_ms)) {
+            return;
+        }
+
+        const int64_t latency_ns = (wall_clock_us() - static_cast<int64_t>(timestamp_ms) * 1000) * 1000;
+        stats_.latency.record(latency_ns);
+        stats_.interval_latency.record(latency_ns);
+        stats_.delivered.fetch_add(1, std::memory_order_relaxed);
+        received_.fetch_add(1, std::memory_order_relaxed);
+
+        // Concurrent publishers can reorder neighbouring seqs, so only count forward jumps
+        const uint64_t last = last_seq_.load(std::memory_order_relaxed);
+        if (seq > last) {
+            if (last != 0 && seq > last + 1) {
+                stats_.gaps.fetch_add(seq - last - 1, std::memory_order_relaxed);
+            }
+            last_seq_.store(seq, std::memory_order_relaxed);
+        }
+        uint64_t max_seq = stats_.max_seq.load(std::memory_order_relaxed);
+        while (seq > max_seq && !stats_.max_seq.compare_exchange_weak(max_seq, seq, std::memory_order_relaxed)) {
+        }
+    }
+
+    websocket::stream<beast::tcp_stream> ws_;
+    beast::flat_buffer buffer_;
+    const Options& opts_;
+    Stats& stats_;
+    std::atomic<uint64_t> last_seq_{0};
+    std::atomic<uint64_t> received_{0};
+};
+
+// One HTTP request on its own connection (the server closes after every response)
+class HttpRequest : public std::enable_shared_from_this<HttpRequest> {
+public:
+    using Done = std::function<void(bool ok, bool io_error)>;
+
+    HttpRequest(net::io_context& ioc, const std::string& host, const std::string& target, std::string body, Done done)
+        : stream_(ioc), done_(std::move(done)) {
+        req_.method(http::verb::post);
+        req_.target(target);
+        req_.version(11);
+        req_.set(http::field::host, host);
+        req_.set(http::field::content_type, "application/json");
+        req_.body() = std::move(body);
+        req_.prepare_payload();
+    }
+
+    void start(const tcp::endpoint& endpoint) {
+        stream_.expires_after(std::chrono::seconds(5));
+        stream_.async_connect(endpoint, [self = shared_from_this()](beast::error_code ec) {
+            if (ec) return self->finish(false, true);
+            http::async_write(self->stream_, self->req_, [self](beast::error_code ec, std::size_t) {
+                if (ec) return self->finish(false, true);
+                http::async_read(self->stream_, self->buffer_, self->res_, [self](beast::error_code ec, std::size_t) {
+                    if (ec) return self->finish(false, true);
+                    self->finish(http::to_status_class(self->res_.result()) == http::status_class::successful, false);
+                });
+            });
+        });
+    }
+
+private:
+    void finish(bool ok, bool io_error) {
+        beast::error_code ignored;
+        stream_.socket().shutdown(tcp::socket::shutdown_both, ignored);
+        done_(ok, io_error);
+    }
+
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> req_;
+    http::response<http::string_body> res_;
+    Done done_;
+};
+
+// Issues requests at a fixed rate from one io_context, capped at max_inflight
+class Publisher {
+public:
+    Publisher(net::io_context& ioc, const Options& opts, Stats& stats, tcp::endpoint endpoint)
+        : ioc_(ioc), opts_(opts), stats_(stats), endpoint_(endpoint), timer_(ioc) {}
+
+    void start() {
+        start_ = std::chrono::steady_clock::now();
+        tick();
+    }
+
+    void stop() {
+        net::post(ioc_, [this]() {
+            stopped_ = true;
+            timer_.cancel();
+        });
+    }
+
+private:
+    void tick() {
+        if (stopped_) return;
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        issue(opts_.publish_rate * elapsed, publishes_issued_, false);
+        issue(opts_.bulk_rate * elapsed, bulk_issued_, true);
+        timer_.expires_after(std::chrono::milliseconds(1));
+        timer_.async_wait([this](beast::error_code ec) {
+            if (!ec) tick();
+        });
+    }
+
+    // Catch up to the schedule; requests that cannot start because of the
+    // in-flight cap are skipped rather than queued, so the offered rate is honest
+    void issue(double due, uint64_t& issued, bool bulk) {
+        while (static_cast<double>(issued) < due) {
+            ++issued;
+            if (inflight_ >= opts_.max_inflight) {
+                stats_.publish_skipped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            ++inflight_;
+            const uint64_t n = issued;
+            std::string body;
+            std::string target;
+            if (bulk) {
+                target = "/api/publish_bulk";
+                body = json{{"count", opts_.bulk_count}, {"symbol", "LOADBULK"}, {"price", 100.0}, {"volume", 1.0}}.dump();
+            } else {
+                target = "/api/publish";
+                body = json{{"symbol", "LOAD" + std::to_string(n % 16)}, {"price", 100.0 + static_cast<double>(n % 100) * 0.01},
+                            {"volume", 1.0}}.dump();
+            }
+            std::make_shared<HttpRequest>(ioc_, opts_.host, target, std::move(body),
+                [this, bulk](bool ok, bool io_error) {
+                    --inflight_;
+                    if (ok) {
+                        stats_.publish_ok.fetch_add(1, std::memory_order_relaxed);
+                        if (bulk) {
+                            stats_.bulk_ticks.fetch_add(opts_.bulk_count, std::memory_order_relaxed);
+                        }
+                    } else if (io_error) {
+                        stats_.publish_errors.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        stats_.publish_rejected.fetch_add(1, std::memory_order_relaxed);
+                    }
+                })->start(endpoint_);
+        }
+    }
+
+    net::io_context& ioc_;
+    const Options& opts_;
+    Stats& stats_;
+    tcp::endpoint endpoint_;
+    net::steady_timer timer_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t publishes_issued_ = 0;
+    uint64_t bulk_issued_ = 0;
+    int inflight_ = 0;
+    bool stopped_ = false;
+};
+
+double ms(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+uint64_t percentile_of(std::vector<uint64_t>& values, double q) {
+    if (values.empty()) return 0;
+    const std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(q * static_cast<double>(values.size())));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return values[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    try {
+        if (!parse_args(argc, argv, opts)) {
+            usage();
+            return 2;
+        }
+    } catch (const std::exception&) {
+        usage();
+        return 2;
+    }
+
+    net::io_context resolve_ioc;
+    tcp::resolver resolver(resolve_ioc);
+    beast::error_code ec;
+    auto results = resolver.resolve(opts.host, std::to_string(opts.port), ec);
+    if (ec || results.empty()) {
+        std::cerr << "loadgen: cannot resolve " << opts.host << ": " << ec.message() << "\n";
+        return 1;
+    }
+    const tcp::endpoint endpoint = results.begin()->endpoint();
+
+    // One io_context per thread; clients are spread round-robin
+    std::vector<std::unique_ptr<net::io_context>> contexts;
+    std::vector<net::executor_work_guard<net::io_context::executor_type>> guards;
+    for (int i = 0; i < opts.threads; ++i) {
+        contexts.push_back(std::make_unique<net::io_context>(1));
+        guards.push_back(net::make_work_guard(*contexts.back()));
+    }
+    std::vector<std::thread> threads;
+    for (auto& ioc : contexts) {
+        threads.emplace_back([&ioc]() { ioc->run(); });
+    }
+
+    Stats stats;
+    std::vector<std::shared_ptr<WsClient>> clients;
+    clients.reserve(static_cast<std::size_t>(opts.clients));
+    for (int i = 0; i < opts.clients; ++i) {
+        auto client = std::make_shared<WsClient>(*contexts[static_cast<std::size_t>(i) % contexts.size()], opts, stats);
+        client->start(endpoint);
+        clients.push_back(std::move(client));
+    }
+
+    // Give the clients up to 10s to connect before offering load
+    const auto connect_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (stats.ws_connected + stats.ws_failed < static_cast<uint64_t>(opts.clients) &&
+           std::chrono::steady_clock::now() < connect_deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!opts.json_only) {
+        std::cout << "connected " << stats.ws_connected << "/" << opts.clients << " clients ("
+                  << stats.ws_failed << " failed)" << std::endl;
+    }
+
+    Publisher publisher(*contexts.front(), opts, stats, endpoint);
+    net::post(*contexts.front(), [&publisher]() { publisher.start(); });
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(opts.duration_s));
+    uint64_t last_delivered = 0;
+    uint64_t last_published = 0;
+    auto last_report = start;
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            std::chrono::seconds(1), end - std::chrono::steady_clock::now()));
+        const auto now = std::chrono::steady_clock::now();
+        const double dt = std::chrono::duration<double>(now - last_report).count();
+        const uint64_t delivered = stats.delivered.load();
+        const uint64_t published = stats.publish_ok.load();
+        if (!opts.json_only && dt > 0) {
+            std::cout << "t=" << std::chrono::duration<double>(now - start).count() << "s"
+                      << " delivered/s=" << static_cast<uint64_t>((delivered - last_delivered) / dt)
+                      << " publish_ok/s=" << static_cast<uint64_t>((published - last_published) / dt)
+                      << " rejected=" << stats.publish_rejected << " skipped=" << stats.publish_skipped
+                      << " errors=" << stats.publish_errors
+                      << " latency_ms p50=" << ms(stats.interval_latency.percentile(0.5))
+                      << " p99=" << ms(stats.interval_latency.percentile(0.99)) << std::endl;
+        }
+        stats.interval_latency.reset();
+        last_delivered = delivered;
+        last_published = published;
+        last_report = now;
+    }
+
+    publisher.stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(opts.drain_ms));
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Lag: how far behind the newest seq any client saw each client finished
+    const uint64_t max_seq = stats.max_seq.load();
+    std::vector<uint64_t> lags;
+    std::vector<uint64_t> received;
+    for (const auto& client : clients) {
+        lags.push_back(client->last_seq() ? max_seq - std::min(max_seq, client->last_seq()) : max_seq);
+        received.push_back(client->received());
+        client->close();
+    }
+
+    json result = {
+        {"clients", opts.clients},
+        {"connected", stats.ws_connected.load()},
+        {"duration_s", elapsed},
+        {"publish_ok", stats.publish_ok.load()},
+        {"publish_rejected", stats.publish_rejected.load()},
+        {"publish_errors", stats.publish_errors.load()},
+        {"publish_skipped", stats.publish_skipped.load()},
+        {"bulk_ticks", stats.bulk_ticks.load()},
+        {"delivered", stats.delivered.load()},
+        {"delivered_per_s", static_cast<double>(stats.delivered.load()) / elapsed},
+        {"seq_gaps", stats.gaps.load()},
+        {"latency_ms", {
+            {"p50", ms(stats.latency.percentile(0.5))},
+            {"p90", ms(stats.latency.percentile(0.9))},
+            {"p99", ms(stats.latency.percentile(0.99))},
+            {"p999", ms(stats.latency.percentile(0.999))},
+            {"count", stats.latency.count()}
+        }},
+        {"client_lag_seq", {
+            {"p50", percentile_of(lags, 0.5)},
+            {"p99", percentile_of(lags, 0.99)},
+            {"max", lags.empty() ? 0 : *std::max_element(lags.begin(), lags.end())}
+        }},
+        {"client_received", {
+            {"min", received.empty() ? 0 : *std::min_element(received.begin(), received.end())},
+            {"max", received.empty() ? 0 : *std::max_element(received.begin(), received.end())}
+        }}
+    };
+    std::cout << (opts.json_only ? "" : "result ") << result.dump() << std::endl;
+
+    for (auto& guard : guards) {
+        guard.reset();
+    }
+    for (auto& ioc : contexts) {
+        ioc->stop();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include "logger.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+namespace lockfree {
+
+namespace {
+
+const char* level_name(uint8_t level) {
+    switch (static_cast<LogLevel>(level)) {
+        case LogLevel::DEBUG: return "debug";
+        case LogLevel::INFO: return "info";
+        case LogLevel::WARN: return "warn";
+        case LogLevel::ERROR: return "error";
+        default: return "unknown";
+    }
+}
+
+void append_timestamp(std::string& out, int64_t timestamp_us) {
+    const std::time_t seconds = static_cast<std::time_t>(timestamp_us / 1000000);
+    std::tm tm{};
+    gmtime_r(&seconds, &tm);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%06dZ",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                  tm.tm_hour, tm.tm_min, tm.tm_sec,
+                  static_cast<int>(timestamp_us % 1000000));
+    out += buf;
+}
+
+// Writes everything, retrying on short writes; stderr is unbuffered so this is one syscall per pass
+void write_all(const std::string& out) {
+    const char* data = out.data();
+    std::size_t remaining = out.size();
+    while (remaining > 0) {
+        ssize_t n = ::write(STDERR_FILENO, data, remaining);
+        if (n <= 0) {
+            return;
+        }
+        data += n;
+        remaining -= static_cast<std::size_t>(n);
+    }
+}
+
+} // namespace
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : level_(static_cast<int>(LogLevel::INFO)) {
+    if (const char* env = std::getenv("LOG_LEVEL")) {
+        level_.store(static_cast<int>(parse_level(env)), std::memory_order_relaxed);
+    }
+    writer_ = std::thread(&Logger::writer_loop, this);
+}
+
+Logger::~Logger() {
+    running_.store(false, std::memory_order_release);
+    wake_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+LogLevel Logger::parse_level(const std::string& name, LogLevel fallback) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "debug") return LogLevel::DEBUG;
+    if (lower == "info") return LogLevel::INFO;
+    if (lower == "warn" || lower == "warning") return LogLevel::WARN;
+    if (lower == "error") return LogLevel::ERROR;
+    if (lower == "off" || lower == "none") return LogLevel::OFF;
+    return fallback;
+}
+
+std::ostringstream& Logger::line() {
+    thread_local std::ostringstream os;
+    os.str(std::string());
+    os.clear();
+    return os;
+}
+
+Logger::ThreadBuffer& Logger::local_buffer() {
+    // The holder retires the buffer at thread exit; the writer frees it once drained
+    struct Holder {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~Holder() {
+            if (buffer) {
+                buffer->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local Holder holder;
+    if (!holder.buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->thread_id = next_thread_id_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(buffers_mutex_);
+            buffers_.push_back(buffer);
+        }
+        holder.buffer = std::move(buffer);
+    }
+    return *holder.buffer;
+}
+
+void Logger::submit(LogLevel level, std::ostringstream& os) {
+    ThreadBuffer& buffer = local_buffer();
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= RING_RECORDS) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record& record = buffer.records[head % RING_RECORDS];
+    record.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.thread_id = buffer.thread_id;
+    record.level = static_cast<uint8_t>(level);
+    // str() copies the message out of the stream (one allocation); truncate long ones
+    const std::string text = os.str();
+    record.length = static_cast<uint16_t>(std::min(text.size(), MAX_MESSAGE));
+    std::memcpy(record.text, text.data(), record.length);
+
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+bool Logger::drain(std::string& out) {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers = buffers_;
+    }
+
+    bool wrote = false;
+    for (const auto& buffer : buffers) {
+        uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const Record& record = buffer->records[tail % RING_RECORDS];
+            out += "ts=";
+            append_timestamp(out, record.timestamp_us);
+            out += " level=";
+            out += level_name(record.level);
+            out += " tid=";
+            out += std::to_string(record.thread_id);
+            out += " msg=\"";
+            for (uint16_t i = 0; i < record.length; ++i) {
+                const char c = record.text[i];
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if (c == '\n') {
+                    out += "\\n";
+                } else {
+                    out += c;
+                }
+            }
+            out += "\"\n";
+            wrote = true;
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+    }
+
+    // Forget threads that have exited and been fully drained
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+        [](const std::shared_ptr<ThreadBuffer>& buffer) {
+            return buffer->retired.load(std::memory_order_acquire) &&
+                   buffer->tail.load(std::memory_order_relaxed) == buffer->head.load(std::memory_order_acquire);
+        }), buffers_.end());
+    return wrote;
+}
+
+void Logger::writer_loop() {
+    std::string out;
+    out.reserve(64 * 1024);
+    uint64_t reported_dropped = 0;
+    for (;;) {
+        const bool stopping = !running_.load(std::memory_order_acquire);
+        const uint64_t flush_target = flush_requests_.load(std::memory_order_acquire);
+
+        out.clear();
+        drain(out);
+        const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reported_dropped) {
+            out += "ts=";
+            append_timestamp(out, std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            out += " level=warn tid=0 msg=\"logger dropped " + std::to_string(dropped - reported_dropped) + " records\"\n";
+            reported_dropped = dropped;
+        }
+        if (!out.empty()) {
+            write_all(out);
+        }
+        flushes_done_.store(flush_target, std::memory_order_release);
+
+        if (stopping) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait_for(lock, std::chrono::milliseconds(5), [this, flush_target]() {
+            return !running_.load(std::memory_order_acquire) ||
+                   flush_requests_.load(std::memory_order_acquire) != flush_target;
+        });
+    }
+}
+
+void Logger::flush() {
+    const uint64_t ticket = flush_requests_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    wake_.notify_all();
+    while (flushes_done_.load(std::memory_order_acquire) < ticket && writer_.joinable() &&
+           running_.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace lockfree
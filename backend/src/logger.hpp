@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lockfree {
+
+enum class LogLevel : int {
+    DEBUG = 0,
+    INFO = 1,
+    WARN = 2,
+    ERROR = 3,
+    OFF = 4
+};
+
+// Asynchronous leveled logger.
+//
+// Each thread formats its message and copies it into its own lock-free SPSC
+// record ring; a background writer drains every ring and emits logfmt lines
+// (ts=... level=... tid=... msg="...") to stderr in one write per pass.
+// Callers never block on terminal I/O: if a thread's ring is full the record
+// is dropped and counted.
+class Logger {
+public:
+    static constexpr std::size_t MAX_MESSAGE = 240;
+    static constexpr std::size_t RING_RECORDS = 1024;
+
+    static Logger& instance();
+
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= instance().level_.load(std::memory_order_relaxed);
+    }
+
+    // Per-thread scratch stream used by the LOG_* macros
+    static std::ostringstream& line();
+
+    void submit(LogLevel level, std::ostringstream& os);
+    void set_level(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+    LogLevel get_level() const { return static_cast<LogLevel>(level_.load(std::memory_order_relaxed)); }
+
+    // Block until everything submitted so far has been written
+    void flush();
+
+    uint64_t get_dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+    static LogLevel parse_level(const std::string& name, LogLevel fallback = LogLevel::INFO);
+
+    ~Logger();
+
+private:
+    struct Record {
+        int64_t timestamp_us;
+        uint32_t thread_id;
+        uint16_t length;
+        uint8_t level;
+        char text[MAX_MESSAGE];
+    };
+
+    // Single-producer (owning thread) / single-consumer (writer) ring
+    struct ThreadBuffer {
+        alignas(64) std::atomic<uint64_t> head{0};  // Next slot the owner writes
+        alignas(64) std::atomic<uint64_t> tail{0};  // Next slot the writer reads
+        uint32_t thread_id = 0;
+        std::atomic<bool> retired{false};
+        Record records[RING_RECORDS];
+    };
+
+    Logger();
+    ThreadBuffer& local_buffer();
+    void writer_loop();
+    bool drain(std::string& out);
+
+    std::atomic<int> level_;
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint32_t> next_thread_id_{1};
+
+    std::mutex buffers_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> flush_requests_{0};
+    std::atomic<uint64_t> flushes_done_{0};
+    std::thread writer_;
+};
+
+// Lets one message per interval through and counts what it held back.
+class RateLimiter {
+public:
+    explicit RateLimiter(std::chrono::milliseconds interval)
+        : interval_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()) {}
+
+    // True when the caller may log; suppressed receives how many calls were skipped since
+    bool allow(uint64_t& suppressed) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t next = next_allowed_ns_.load(std::memory_order_relaxed);
+        if (now >= next && next_allowed_ns_.compare_exchange_strong(next, now + interval_ns_, std::memory_order_relaxed)) {
+            suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+private:
+    int64_t interval_ns_;
+    std::atomic<int64_t> next_allowed_ns_{0};
+    std::atomic<uint64_t> suppressed_{0};
+};
+
+} // namespace lockfree
+
+#define LOCKFREE_LOG(level, expr)                                          \
+    do {                                                                   \
+        if (::lockfree::Logger::enabled(level)) {                          \
+            auto& lf_log_line_ = ::lockfree::Logger::line();               \
+            lf_log_line_ << expr;                                          \
+            ::lockfree::Logger::instance().submit(level, lf_log_line_);    \
+        }                                                                  \
+    } while (0)
+
+#define LOG_DEBUG(expr) LOCKFREE_LOG(::lockfree::LogLevel::DEBUG, expr)
+#define LOG_INFO(expr) LOCKFREE_LOG(::lockfree::LogLevel::INFO, expr)
+#define LOG_WARN(expr) LOCKFREE_LOG(::lockfree::LogLevel::WARN, expr)
+#define LOG_ERROR(expr) LOCKFREE_LOG(::lockfree::LogLevel::ERROR, expr)
+
+// At most one warning per interval_ms from this call site, noting how many were skipped
+#define LOG_WARN_RATE_LIMITED(interval_ms, expr)                                           \
+    do {                                                                                   \
+        static ::lockfree::RateLimiter lf_rate_limiter_{std::chrono::milliseconds(interval_ms)}; \
+        uint64_t lf_suppressed_ = 0;                                                       \
+        if (lf_rate_limiter_.allow(lf_suppressed_)) {                                      \
+            LOG_WARN(expr << (lf_suppressed_ ? " (" : "")                                  \
+                          << (lf_suppressed_ ? std::to_string(lf_suppressed_) + " similar suppressed)" : "")); \
+        }                                                                                  \
+    } while (0)
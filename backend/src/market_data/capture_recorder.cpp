@@ -0,0 +1,172 @@
+#include "capture_recorder.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include "logger.hpp"
+#include "symbol_registry.hpp"
+
+namespace market_data {
+
+namespace {
+
+// Pending rows at which the consumer wakes the writer early
+constexpr std::size_t WAKE_ROWS = 16384;
+// Longest the writer sleeps when rows trickle in
+constexpr std::chrono::milliseconds WRITER_POLL{50};
+
+} // namespace
+
+CaptureRecorder::CaptureRecorder(Options options) : options_(std::move(options)) {
+    pending_.reserve(WAKE_ROWS);
+    thread_ = std::thread(&CaptureRecorder::writer_thread, this);
+    LOG_INFO("Capturing bus traffic to " << options_.directory << "/" << options_.prefix << "-*.bin");
+}
+
+CaptureRecorder::~CaptureRecorder() {
+    stop();
+}
+
+void CaptureRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void CaptureRecorder::operator()(const lockfree::WireRecord& record, const lockfree::TickBody& tick,
+                                 const lockfree::PipelineStamps&) {
+    record_row({record.timestamp_ns, tick.price, tick.volume, record.symbol_id, record.price_decimals()});
+}
+
+void CaptureRecorder::operator()(const lockfree::WireRecord& record, const lockfree::Trade& trade,
+                                 const lockfree::PipelineStamps&) {
+    record_row({record.timestamp_ns, trade.price, trade.size, record.symbol_id, record.price_decimals()});
+}
+
+void CaptureRecorder::record_row(const Row& row) {
+    if (row.symbol_id == lockfree::SymbolRegistry::INVALID_ID) {
+        return;
+    }
+    std::size_t pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || pending_.size() >= options_.max_pending) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pending_.push_back(row);
+        pending = pending_.size();
+    }
+    if (pending == WAKE_ROWS) {
+        cv_.notify_one();
+    }
+}
+
+void CaptureRecorder::writer_thread() {
+    std::vector<Row> rows;
+    rows.reserve(WAKE_ROWS);
+    last_sync_ = std::chrono::steady_clock::now();
+    bool running = true;
+    while (running) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, WRITER_POLL, [this] { return !running_ || pending_.size() >= WAKE_ROWS; });
+            rows.swap(pending_);
+            running = running_;
+        }
+        const uint64_t recorded_before = recorded_.load(std::memory_order_relaxed);
+        try {
+            write_rows(rows);
+            const auto now = std::chrono::steady_clock::now();
+            if (writer_ && now - opened_ >= options_.roll_interval) {
+                close_file();
+            } else if (writer_ && now - last_sync_ >= options_.sync_interval) {
+                writer_->sync();
+                last_sync_ = now;
+            }
+        } catch (const std::exception& e) {
+            // Abandon the file (its .part stays behind) and start a new one with the
+            // next rows. Its rows never reach a .bin, so they move from recorded to
+            // dropped along with the rest of this batch
+            LOG_WARN_RATE_LIMITED(1000, "Capture to " << path_ << " failed: " << e.what());
+            const uint64_t abandoned = writer_ ? writer_->rows_written() : 0;
+            writer_.reset();
+            const uint64_t written = recorded_.load(std::memory_order_relaxed) - recorded_before;
+            recorded_.fetch_sub(abandoned, std::memory_order_relaxed);
+            dropped_.fetch_add(rows.size() - written + abandoned, std::memory_order_relaxed);
+        }
+        rows.clear();
+    }
+    try {
+        close_file();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Capture to " << path_ << " failed: " << e.what());
+    }
+    LOG_INFO("Capture stopped: " << recorded_.load() << " rows in " << files_.load() << " files, "
+             << dropped_.load() << " dropped");
+}
+
+void CaptureRecorder::write_rows(const std::vector<Row>& rows) {
+    for (const Row& row : rows) {
+        if (!writer_) {
+            open_file();
+        }
+        if (row.symbol_id >= symbol_names_.size()) {
+            symbol_names_.resize(row.symbol_id + 1);
+        }
+        std::string& name = symbol_names_[row.symbol_id];
+        if (name.empty()) {
+            name = lockfree::SymbolRegistry::instance().name(row.symbol_id);
+        }
+        writer_->add(name, lockfree::FixedPrice(row.price, row.decimals),
+                     lockfree::from_fixed(row.volume, lockfree::WireRecord::VOLUME_SCALE), row.timestamp_ns);
+        recorded_.fetch_add(1, std::memory_order_relaxed);
+        if (writer_->bytes_written() >= options_.roll_bytes) {
+            close_file();
+        }
+    }
+}
+
+void CaptureRecorder::open_file() {
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    // Skip names an earlier capture already holds; O_EXCL and link() below
+    // catch anything created in between, so nothing is ever replaced
+    do {
+        path_ = options_.directory + "/" + options_.prefix + "-" + std::to_string(now_ms) + "-" +
+                std::to_string(sequence_++) + ".bin";
+    } while (access(path_.c_str(), F_OK) == 0 || access((path_ + ".part").c_str(), F_OK) == 0);
+    writer_ = std::make_unique<TickFileWriter>(path_ + ".part", options_.block_rows,
+                                               tick_file::BlockEncoding::COMPRESSED, tick_file::CreateMode::EXCLUSIVE);
+    opened_ = last_sync_ = std::chrono::steady_clock::now();
+}
+
+void CaptureRecorder::close_file() {
+    if (!writer_) {
+        return;
+    }
+    writer_->finish();
+    // link() + unlink() rather than rename(), which would replace an existing .bin.
+    // writer_ is kept until the .bin exists so a failure here can count its rows
+    if (link((path_ + ".part").c_str(), path_.c_str()) != 0) {
+        throw std::runtime_error("Failed to rename " + path_ + ".part: " + strerror(errno));
+    }
+    const uint64_t rows = writer_->rows_written();
+    const uint64_t bytes = writer_->bytes_written();
+    writer_.reset();
+    if (unlink((path_ + ".part").c_str()) != 0) {
+        // The .bin is complete; only a stale duplicate is left behind
+        LOG_WARN("Failed to remove " << path_ << ".part: " << strerror(errno));
+    }
+    files_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    LOG_INFO("Captured " << rows << " rows to " << path_ << " (" << bytes / (1024 * 1024) << " MB)");
+}
+
+} // namespace market_data
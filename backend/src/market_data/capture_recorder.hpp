@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tick_file.hpp"
+#include "metrics.hpp"
+#include "wire_record.hpp"
+
+namespace market_data {
+
+// Records what flows through the MessageBus into rolling tick files that
+// ReplayEngine replays directly. Use it as (part of) the bus consumer's
+// visitor: ticks and trades are copied into a pending buffer on the consumer
+// thread, and a writer thread drains it into a TickFileWriter, so the consumer
+// never waits on the disk. Rows that arrive while the writer is max_pending
+// rows behind, or that a failed write loses, are dropped and counted.
+//
+// Files are written as <directory>/<prefix>-<wall clock ms>-<sequence>.bin.part
+// and renamed to .bin once finished, so every .bin file is complete; existing
+// files are never replaced. A file is rolled when it reaches roll_bytes or has
+// been open roll_interval, and synced (fdatasync, including a short final
+// block) every sync_interval, which keeps dirty pages from piling up into long
+// writeback stalls. The index and header are only written when a file is
+// finished, so a crash loses the open .part file; roll_interval bounds how
+// much that can be. Rows are stored in arrival order; a file whose rows are
+// out of timestamp order is flagged as such and seeked by a scan.
+class CaptureRecorder {
+public:
+    struct Options {
+        std::string directory = ".";
+        std::string prefix = "capture";
+        uint64_t roll_bytes = 256ull << 20;
+        std::chrono::seconds roll_interval{900};
+        std::chrono::milliseconds sync_interval{1000};
+        std::size_t max_pending = 1 << 20;
+        uint32_t block_rows = tick_file::DEFAULT_BLOCK_ROWS;
+    };
+
+    // Starts the writer thread; the first file is created with the first row
+    explicit CaptureRecorder(Options options);
+    ~CaptureRecorder();
+
+    CaptureRecorder(const CaptureRecorder&) = delete;
+    CaptureRecorder& operator=(const CaptureRecorder&) = delete;
+
+    // Write out what is pending, finish the current file and stop the writer
+    void stop();
+
+    // MessageBus visitor overloads, called on the consumer thread
+    void operator()(const lockfree::WireRecord& record, const lockfree::TickBody& tick,
+                    const lockfree::PipelineStamps& stamps);
+    void operator()(const lockfree::WireRecord& record, const lockfree::Trade& trade,
+                    const lockfree::PipelineStamps& stamps);
+
+    uint64_t recorded() const { return recorded_; }
+    uint64_t dropped() const { return dropped_; }
+    uint64_t files() const { return files_; }
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    // One captured message, as copied off the ring
+    struct Row {
+        int64_t timestamp_ns;
+        int64_t price;          // Ticks in decimals
+        int64_t volume;         // WireRecord::VOLUME_SCALE fixed point
+        uint32_t symbol_id;     // lockfree::SymbolRegistry id
+        uint8_t decimals;
+    };
+
+    void record_row(const Row& row);
+    void writer_thread();
+    void write_rows(const std::vector<Row>& rows);
+    void open_file();
+    void close_file();
+
+    Options options_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Row> pending_;   // Guarded by mutex_
+    bool running_ = true;        // Guarded by mutex_
+
+    // Writer thread state
+    std::unique_ptr<TickFileWriter> writer_;
+    std::string path_;
+    uint64_t sequence_ = 0;  // Of the next file name
+    std::chrono::steady_clock::time_point opened_;
+    std::chrono::steady_clock::time_point last_sync_;
+    std::vector<std::string> symbol_names_;  // By SymbolRegistry id, filled lazily
+
+    std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> files_{0};
+    std::atomic<uint64_t> bytes_{0};  // In finished files
+    std::thread thread_;
+};
+
+} // namespace market_data
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <iostream>
+#include "logger.hpp"
 #include <string>
 #include <vector>
 #include <functional>
@@ -68,7 +68,8 @@ public:
                             for (const auto& data : json_msg["data"]) {
                                 NormalizedMarketData market_data;
                                 market_data.symbol = data["s"];
-                                market_data.price = data["p"];
+                                market_data.price = lockfree::InstrumentTable::instance().to_price(
+                                    market_data.symbol.c_str(), data["p"].get<double>());
                                 market_data.volume = data["v"];
                                 market_data.timestamp = std::chrono::system_clock::now();
                                 market_data.source = "FINNHUB";
@@ -77,7 +78,7 @@ public:
                             }
                         }
                     } catch (const std::exception& e) {
-                        std::cerr << "Error parsing message: " << e.what() << std::endl;
+                        LOG_WARN("Error parsing message: " << e.what());
                     }
                 }
 
@@ -91,7 +92,7 @@ public:
                 }
                 ws.close(websocket::close_code::normal);
             } catch (const std::exception& e) {
-                std::cerr << "WebSocket error: " << e.what() << std::endl;
+                LOG_ERROR("WebSocket error: " << e.what());
             }
         });
     }
@@ -4,7 +4,10 @@
 #include <chrono>
 #include <vector>
 #include <deque>
+#include <mutex>
+#include <condition_variable>
 #include <nlohmann/json.hpp>
+#include "price.hpp"
 
 using json = nlohmann::json;
 
@@ -13,7 +16,7 @@ namespace market_data {
 // Normalized market data structure
 struct NormalizedMarketData {
     std::string symbol;
-    double price;
+    lockfree::FixedPrice price;  // In the instrument's scale; see lockfree::InstrumentTable
     double volume;
     std::chrono::system_clock::time_point timestamp;
     std::string source;  // e.g., "FINNHUB", "REPLAY"
@@ -22,7 +25,7 @@ struct NormalizedMarketData {
     nlohmann::json to_json() const {
         return {
             {"symbol", symbol},
-            {"price", price},
+            {"price", price.to_double()},
             {"volume", volume},
             {"timestamp", std::chrono::system_clock::to_time_t(timestamp)},
             {"source", source}
@@ -56,4 +59,58 @@ private:
     size_t max_size_;
 };
 
+// Blocking FIFO with a fixed capacity, used to hand rows from a loader thread
+// to a consumer so neither side has to hold the whole data set.
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity == 0 ? 1 : capacity) {}
+
+    // Blocks while full; returns false once the queue is closed
+    bool push(T&& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Blocks while empty; returns false once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // No more pushes; pop() drains what is left
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    size_t capacity_;
+    bool closed_ = false;
+};
+
 } // namespace market_data 
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace market_data {
+namespace pacing {
+
+// Sleep until this close to a deadline, then spin; covers the scheduler's
+// wake-up latency
+constexpr std::chrono::microseconds SPIN_THRESHOLD{200};
+// Longest single sleep, so a stop is not held up by gaps in the data
+constexpr std::chrono::milliseconds MAX_SLEEP{50};
+
+// Hybrid sleep/spin wait for replay pacing. Returns false as soon as
+// interrupted() is true (checked between sleep slices and once at the end).
+template<typename Interrupted>
+bool wait_until(std::chrono::steady_clock::time_point deadline, Interrupted interrupted) {
+    for (auto now = std::chrono::steady_clock::now(); deadline - now > SPIN_THRESHOLD;
+         now = std::chrono::steady_clock::now()) {
+        if (interrupted()) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            deadline - now - SPIN_THRESHOLD, MAX_SLEEP));
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    return !interrupted();
+}
+
+} // namespace pacing
+} // namespace market_data
@@ -0,0 +1,277 @@
+#include "parallel_replay.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include "logger.hpp"
+#include "pacing.hpp"
+
+namespace market_data {
+
+namespace {
+
+int64_t to_ns(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+} // namespace
+
+ParallelReplay::ParallelReplay(SinkFactory make_sink) : make_sink_(std::move(make_sink)) {
+}
+
+ParallelReplay::~ParallelReplay() {
+    stop();
+}
+
+bool ParallelReplay::start(const std::vector<std::string>& filenames, size_t workers, double speed_multiplier,
+                           std::chrono::nanoseconds barrier_interval, size_t read_ahead) {
+    if (running_) {
+        return false;
+    }
+    if (filenames.empty()) {
+        LOG_ERROR("No files to replay");
+        return false;
+    }
+    // Reap the threads of a replay that ran to completion
+    stop();
+    source_.reset();
+    workers_.clear();
+
+    std::vector<std::unique_ptr<ReplaySource>> sources;
+    const size_t per_file = std::max<size_t>(read_ahead / filenames.size(), 1024);
+    for (const auto& filename : filenames) {
+        auto source = ReplaySource::open(filename, per_file);
+        if (!source) {
+            return false;
+        }
+        sources.push_back(std::move(source));
+    }
+    source_ = sources.size() == 1 ? std::move(sources[0]) : std::make_unique<MergedSource>(std::move(sources));
+    const int64_t from_ns = range_from_ns_;
+    if (from_ns != INT64_MIN) {
+        source_->seek(from_ns);
+    }
+
+    workers = std::clamp<size_t>(workers, 1, MAX_WORKERS);
+    for (size_t i = 0; i < workers; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->sink = make_sink_(i);
+        worker->queue = std::make_unique<BoundedQueue<ShardBatch>>(QUEUE_BATCHES);
+        workers_.push_back(std::move(worker));
+    }
+    speed_multiplier_ = speed_multiplier;
+    barrier_interval_ns_ = std::max<int64_t>(barrier_interval.count(), 0);
+    barrier_waiting_ = 0;
+    barriers_ = 0;
+    drift_.reset();
+    max_drift_ns_ = 0;
+    throughput_ = 0.0;
+    active_workers_ = workers;
+    running_ = true;
+    start_time_ = std::chrono::steady_clock::now();
+
+    LOG_INFO("Replaying " << filenames.size() << " file(s) on " << workers << " workers"
+             << (barrier_interval_ns_ > 0 ? ", barrier every " + std::to_string(barrier_interval_ns_ / 1000) + " us"
+                                          : std::string()));
+    for (auto& worker : workers_) {
+        worker->thread = std::thread(&ParallelReplay::worker_thread, this, std::ref(*worker));
+    }
+    reader_thread_ = std::thread(&ParallelReplay::reader_thread, this);
+    return true;
+}
+
+void ParallelReplay::stop() {
+    {
+        std::lock_guard<std::mutex> lock(barrier_mutex_);
+        running_ = false;
+    }
+    barrier_cv_.notify_all();
+    if (source_) {
+        source_->close();
+    }
+    for (auto& worker : workers_) {
+        worker->queue->close();
+    }
+    if (reader_thread_.joinable()) {
+        reader_thread_.join();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void ParallelReplay::set_range(TimePoint from, TimePoint to) {
+    range_from_ns_ = from == TimePoint::min() ? INT64_MIN : to_ns(from);
+    range_to_ns_ = to == TimePoint::max() ? INT64_MAX : to_ns(to);
+}
+
+size_t ParallelReplay::get_current_index() const {
+    size_t messages = 0;
+    for (const auto& worker : workers_) {
+        messages += worker->messages.load(std::memory_order_relaxed);
+    }
+    return messages;
+}
+
+std::vector<uint64_t> ParallelReplay::get_worker_messages() const {
+    std::vector<uint64_t> messages;
+    messages.reserve(workers_.size());
+    for (const auto& worker : workers_) {
+        messages.push_back(worker->messages.load(std::memory_order_relaxed));
+    }
+    return messages;
+}
+
+ParallelReplay::PacingStats ParallelReplay::get_pacing_stats() const {
+    PacingStats stats;
+    stats.messages = drift_.count();
+    if (stats.messages > 0) {
+        stats.mean_drift_ns = static_cast<int64_t>(drift_.sum() / stats.messages);
+        stats.p99_drift_ns = static_cast<int64_t>(drift_.percentile(0.99));
+        stats.max_drift_ns = max_drift_ns_.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+bool ParallelReplay::dispatch(size_t worker, ShardBatch& batch) {
+    const bool ok = workers_[worker]->queue->push(std::move(batch));
+    batch = ShardBatch();
+    return ok;
+}
+
+void ParallelReplay::dispatch_all(std::vector<ShardBatch>& pending, bool barrier) {
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (barrier) {
+            pending[i].barrier = true;
+        } else if (pending[i].rows.empty()) {
+            continue;
+        }
+        dispatch(i, pending[i]);
+    }
+}
+
+void ParallelReplay::reader_thread() {
+    const int64_t from_ns = range_from_ns_;
+    const int64_t to_ns_limit = range_to_ns_;
+    const int64_t interval_ns = barrier_interval_ns_;
+    // While paced a row must not wait in a part-filled batch behind later
+    // rows for other workers, so each row is handed over on its own
+    const size_t batch_rows = speed_multiplier_ > 0 ? 1 : SHARD_BATCH;
+
+    // Symbols go to workers round-robin in order of first appearance
+    std::unordered_map<std::string, size_t> shard_of;
+    std::vector<ShardBatch> pending(workers_.size());
+    bool anchored = false;
+    int64_t epoch = 0;
+    NormalizedMarketData row;
+    while (running_ && source_->next(row)) {
+        const int64_t ts = to_ns(row.timestamp);
+        if (ts < from_ns) {
+            continue;  // Text sources cannot skip these without reading them
+        }
+        if (ts >= to_ns_limit) {
+            break;
+        }
+        if (!anchored) {
+            anchor_ns_ = ts;
+            anchor_deadline_ = std::chrono::steady_clock::now();
+            anchored = true;
+        }
+        if (interval_ns > 0) {
+            const int64_t row_epoch = (ts - anchor_ns_) / interval_ns;
+            if (row_epoch != epoch) {
+                dispatch_all(pending, true);
+                epoch = row_epoch;
+            }
+        }
+
+        const auto shard = shard_of.try_emplace(row.symbol, shard_of.size() % workers_.size()).first->second;
+        ShardBatch& batch = pending[shard];
+        batch.rows.push_back(std::move(row));
+        if (batch.rows.size() >= batch_rows && !dispatch(shard, batch)) {
+            break;  // Stopped
+        }
+    }
+    dispatch_all(pending, false);
+    for (auto& worker : workers_) {
+        worker->queue->close();
+    }
+    LOG_DEBUG("Parallel replay read " << shard_of.size() << " symbols");
+}
+
+void ParallelReplay::arrive_at_barrier() {
+    std::unique_lock<std::mutex> lock(barrier_mutex_);
+    const uint64_t generation = barriers_;
+    if (++barrier_waiting_ == workers_.size()) {
+        barrier_waiting_ = 0;
+        ++barriers_;
+        lock.unlock();
+        barrier_cv_.notify_all();
+        return;
+    }
+    barrier_cv_.wait(lock, [this, generation] { return barriers_ != generation || !running_; });
+}
+
+void ParallelReplay::worker_thread(Worker& worker) {
+    const double speed = speed_multiplier_;
+    auto stopped = [this] { return !running_; };
+    ShardBatch batch;
+    while (running_ && worker.queue->pop(batch)) {
+        for (const auto& row : batch.rows) {
+            if (speed > 0) {
+                // Deadlines come from the shared anchor, so workers stay on one
+                // schedule without talking to each other
+                const std::chrono::duration<double, std::nano> offset{static_cast<double>(to_ns(row.timestamp) - anchor_ns_)};
+                const auto deadline = anchor_deadline_ +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset / speed);
+                if (!pacing::wait_until(deadline, stopped)) {
+                    break;
+                }
+                const int64_t drift_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - deadline).count();
+                drift_.record(drift_ns);
+                int64_t max_drift = max_drift_ns_.load(std::memory_order_relaxed);
+                while (drift_ns > max_drift &&
+                       !max_drift_ns_.compare_exchange_weak(max_drift, drift_ns, std::memory_order_relaxed)) {
+                }
+            }
+            worker.sink.on_message(row);
+            if (speed > 0 && worker.sink.flush) {
+                worker.sink.flush();
+            }
+            worker.messages.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (batch.barrier && running_) {
+            if (worker.sink.flush) {
+                worker.sink.flush();
+            }
+            arrive_at_barrier();
+        }
+    }
+    if (worker.sink.flush) {
+        worker.sink.flush();
+    }
+    finish_worker();
+}
+
+void ParallelReplay::finish_worker() {
+    if (--active_workers_ > 0) {
+        return;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    const size_t messages = get_current_index();
+    throughput_ = seconds > 0 ? messages / seconds : 0.0;
+    running_ = false;
+
+    if (speed_multiplier_ <= 0) {
+        LOG_INFO("Replayed " << messages << " messages on " << workers_.size() << " workers in " << seconds
+                 << " s (" << static_cast<uint64_t>(throughput_) << " msg/s, " << barriers_.load() << " barriers)");
+        return;
+    }
+    const PacingStats stats = get_pacing_stats();
+    LOG_INFO("Replayed " << messages << " messages on " << workers_.size() << " workers in " << seconds
+             << " s; pacing drift mean " << stats.mean_drift_ns / 1000 << " us, p99 " << stats.p99_drift_ns / 1000
+             << " us, max " << stats.max_drift_ns / 1000 << " us");
+}
+
+} // namespace market_data
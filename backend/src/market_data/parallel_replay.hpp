@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "market_data_types.hpp"
+#include "metrics.hpp"
+#include "replay_engine.hpp"
+#include "replay_source.hpp"
+
+namespace market_data {
+
+// Replay sharded by symbol across worker threads. A reader thread pulls rows
+// from the files (merged by timestamp like ReplayEngine::start_merged_replay)
+// and hands each symbol's rows to one worker, so per-symbol order is kept.
+// Workers pace their shard against one shared schedule and publish through
+// their own sink, e.g. a ReplayPublisher on the multi-producer MessageBus.
+//
+// Across symbols rows are only ordered to within the pacing drift. With a
+// barrier interval, data time is cut into epochs of that length and every
+// worker finishes (and flushes) epoch k before any worker publishes from
+// epoch k+1, so global timestamp order holds at epoch boundaries.
+class ParallelReplay {
+public:
+    static constexpr size_t MAX_WORKERS = 64;
+    // Rows the reader hands to a worker at a time when unpaced
+    static constexpr size_t SHARD_BATCH = 256;
+    // Batches queued per worker before the reader blocks
+    static constexpr size_t QUEUE_BATCHES = 64;
+
+    using TimePoint = ReplayEngine::TimePoint;
+    using PacingStats = ReplayEngine::PacingStats;
+
+    // Where one worker's rows go. flush() runs after each row while paced,
+    // before every barrier and when the worker finishes.
+    struct Sink {
+        ReplayEngine::MessageCallback on_message;
+        ReplayEngine::FlushCallback flush;
+    };
+    // Called on start() once per worker, from the calling thread
+    using SinkFactory = std::function<Sink(size_t worker)>;
+
+    explicit ParallelReplay(SinkFactory make_sink);
+    ~ParallelReplay();
+
+    ParallelReplay(const ParallelReplay&) = delete;
+    ParallelReplay& operator=(const ParallelReplay&) = delete;
+
+    // Start replaying filenames over workers threads (clamped to
+    // 1..MAX_WORKERS). speed as for ReplayEngine; a zero barrier_interval
+    // only keeps per-symbol order. Returns false if a file cannot be opened or
+    // a replay is already running.
+    bool start(const std::vector<std::string>& filenames, size_t workers, double speed_multiplier = 1.0,
+               std::chrono::nanoseconds barrier_interval = std::chrono::nanoseconds::zero(),
+               size_t read_ahead = ReplayEngine::DEFAULT_READ_AHEAD);
+    void stop();
+
+    // Limit replays to rows in [from, to); applied by the next start()
+    void set_range(TimePoint from, TimePoint to);
+
+    bool is_replaying() const { return running_; }
+    bool is_loading() const { return source_ && source_->loading(); }
+    size_t get_workers() const { return workers_.size(); }
+    double get_speed() const { return speed_multiplier_; }
+    std::chrono::nanoseconds get_barrier_interval() const { return std::chrono::nanoseconds(barrier_interval_ns_); }
+    size_t get_total_messages() const { return source_ ? source_->total_rows() : 0; }
+    // Rows replayed so far by the current (or last) replay, over all workers
+    size_t get_current_index() const;
+    // Rows replayed by each worker, to check how evenly symbols spread
+    std::vector<uint64_t> get_worker_messages() const;
+    // Epoch boundaries all workers have passed
+    uint64_t get_barriers() const { return barriers_; }
+    // Drift over all workers of the current (or last) replay
+    PacingStats get_pacing_stats() const;
+    // Messages per second of the last completed replay
+    double get_throughput() const { return throughput_; }
+
+private:
+    // Rows for one worker; barrier marks the end of an epoch
+    struct ShardBatch {
+        std::vector<NormalizedMarketData> rows;
+        bool barrier = false;
+    };
+
+    struct Worker {
+        Sink sink;
+        std::unique_ptr<BoundedQueue<ShardBatch>> queue;
+        std::atomic<uint64_t> messages{0};
+        std::thread thread;
+    };
+
+    void reader_thread();
+    void worker_thread(Worker& worker);
+    // Hand every worker its pending rows; with barrier set, also end the epoch
+    void dispatch_all(std::vector<ShardBatch>& pending, bool barrier);
+    bool dispatch(size_t worker, ShardBatch& batch);
+    // Block until every worker has arrived, or the replay is stopped
+    void arrive_at_barrier();
+    void finish_worker();
+
+    SinkFactory make_sink_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<ReplaySource> source_;
+    std::thread reader_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<double> speed_multiplier_{1.0};
+    std::atomic<int64_t> barrier_interval_ns_{0};
+    std::atomic<int64_t> range_from_ns_{INT64_MIN};
+    std::atomic<int64_t> range_to_ns_{INT64_MAX};
+
+    // Shared schedule, set by the reader before it hands out the first row: a
+    // row with timestamp ts is due at anchor_deadline_ + (ts - anchor_ns_) / speed
+    int64_t anchor_ns_ = 0;
+    std::chrono::steady_clock::time_point anchor_deadline_;
+    std::chrono::steady_clock::time_point start_time_;
+
+    // Cyclic barrier over the workers
+    std::mutex barrier_mutex_;
+    std::condition_variable barrier_cv_;
+    size_t barrier_waiting_ = 0;
+    std::atomic<uint64_t> barriers_{0};
+
+    std::atomic<size_t> active_workers_{0};
+    lockfree::LatencyHistogram drift_;
+    std::atomic<int64_t> max_drift_ns_{0};
+    std::atomic<double> throughput_{0.0};
+};
+
+} // namespace market_data
@@ -1,17 +1,18 @@
 #include "replay_engine.hpp"
-#include <fstream>
-#include <iostream>
+#include "logger.hpp"
+#include "tick_loader.hpp"
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
 namespace market_data {
 
 ReplayEngine::ReplayEngine(const std::vector<std::string>& symbols, MessageCallback callback)
-    : symbols_(symbols)
-    , callback_(callback)
+    : callback_(callback)
     , running_(false)
     , speed_multiplier_(1.0)
-    , current_index_(0) {
+    , current_index_(0)
+    , symbols_(symbols) {
 }
 
 ReplayEngine::~ReplayEngine() {
@@ -19,86 +20,318 @@ ReplayEngine::~ReplayEngine() {
 }
 
 bool ReplayEngine::load_historical_data(const std::string& filename) {
-    try {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << filename << std::endl;
+    historical_data_.clear();
+    if (TickFile::is_tick_file(filename)) {
+        try {
+            TickFile file(filename);
+            historical_data_.resize(file.row_count());
+            TickBlockBuffer scratch;
+            size_t row_index = 0;
+            for (size_t b = 0; b < file.block_count(); ++b) {
+                const TickBlock block = file.block(b, scratch);
+                for (uint32_t row = 0; row < block.rows; ++row) {
+                    file.read_row(block, row, historical_data_[row_index++]);
+                }
+            }
+            historical_data_.resize(row_index);  // Short if a block was corrupt
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error loading historical data: " << e.what());
             return false;
         }
+        LOG_INFO("Loaded " << historical_data_.size() << " historical messages");
+        return true;
+    }
 
-        json data;
-        file >> data;
-
-        historical_data_.clear();
-        for (const auto& item : data) {
-            NormalizedMarketData market_data;
-            market_data.symbol = item["symbol"];
-            market_data.price = item["price"];
-            market_data.volume = item["volume"];
-            int64_t ts = item["timestamp"].get<int64_t>();
-            market_data.timestamp = std::chrono::system_clock::from_time_t(ts / 1000);
-            market_data.source = "REPLAY";
-            historical_data_.push_back(market_data);
-        }
-
-        std::cout << "Loaded " << historical_data_.size() << " historical messages" << std::endl;
+    const auto result = TickLoader::load(filename, [this](NormalizedMarketData& row) {
+        historical_data_.push_back(std::move(row));
         return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading historical data: " << e.what() << std::endl;
+    });
+    if (!result.ok) {
+        LOG_ERROR("Error loading historical data: " << result.error);
         return false;
     }
+    if (result.rejected > 0) {
+        LOG_WARN("Skipped " << result.rejected << " historical rows (first: " << result.error << ")");
+    }
+    LOG_INFO("Loaded " << historical_data_.size() << " historical messages");
+    return true;
 }
 
+namespace {
+
+int64_t to_ns(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+} // namespace
+
 void ReplayEngine::start_replay(double speed_multiplier) {
     if (running_) {
         return;
     }
 
     if (historical_data_.empty()) {
-        std::cerr << "No historical data loaded" << std::endl;
+        LOG_ERROR("No historical data loaded");
         return;
     }
 
+    // Reap the threads of a previous replay
+    stop_replay();
+    source_.reset();
+    begin_replay(speed_multiplier);
+}
+
+bool ReplayEngine::start_streaming_replay(const std::string& filename, double speed_multiplier, size_t read_ahead) {
+    if (running_) {
+        return false;
+    }
+    // Reap the threads of a replay that ran to completion
+    stop_replay();
+    source_.reset();
+    return start_source(ReplaySource::open(filename, read_ahead), speed_multiplier);
+}
+
+bool ReplayEngine::start_merged_replay(const std::vector<std::string>& filenames, double speed_multiplier,
+                                       size_t read_ahead) {
+    if (running_) {
+        return false;
+    }
+    if (filenames.empty()) {
+        LOG_ERROR("No files to replay");
+        return false;
+    }
+    stop_replay();
+    source_.reset();
+
+    std::vector<std::unique_ptr<ReplaySource>> sources;
+    const size_t per_file = std::max<size_t>(read_ahead / filenames.size(), 1024);
+    for (const auto& filename : filenames) {
+        auto source = ReplaySource::open(filename, per_file);
+        if (!source) {
+            return false;
+        }
+        sources.push_back(std::move(source));
+    }
+    LOG_INFO("Merging " << filenames.size() << " files by timestamp");
+    return start_source(std::make_unique<MergedSource>(std::move(sources)), speed_multiplier);
+}
+
+bool ReplayEngine::start_source(std::unique_ptr<ReplaySource> source, double speed_multiplier) {
+    if (!source) {
+        return false;
+    }
+    source_ = std::move(source);
+    begin_replay(speed_multiplier);
+    return true;
+}
+
+void ReplayEngine::begin_replay(double speed_multiplier) {
+    pending_ = nullptr;
+    skip_before_ns_ = INT64_MIN;
+    memory_position_ = 0;
+    anchored_ = false;
+    position_ns_ = 0;
+    paused_ = false;
+    const int64_t from_ns = range_from_ns_;
+    seek_ns_ = from_ns != INT64_MIN ? from_ns : NO_SEEK;
+
     running_ = true;
     speed_multiplier_ = speed_multiplier;
     current_index_ = 0;
-    last_message_time_ = std::chrono::system_clock::now();
-
     replay_thread_ = std::thread(&ReplayEngine::replay_thread, this);
 }
 
 void ReplayEngine::stop_replay() {
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        running_ = false;
+    }
+    control_cv_.notify_all();
+    if (source_) {
+        source_->close();
+    }
     if (replay_thread_.joinable()) {
         replay_thread_.join();
     }
 }
 
+void ReplayEngine::set_range(TimePoint from, TimePoint to) {
+    range_from_ns_ = from == TimePoint::min() ? INT64_MIN : to_ns(from);
+    range_to_ns_ = to == TimePoint::max() ? INT64_MAX : to_ns(to);
+}
+
+void ReplayEngine::seek(TimePoint timestamp) {
+    {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        seek_ns_ = to_ns(timestamp);
+    }
+    control_cv_.notify_all();
+}
+
+void ReplayEngine::pause() {
+    paused_ = true;
+}
+
+void ReplayEngine::resume() {
+    {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        paused_ = false;
+    }
+    control_cv_.notify_all();
+}
+
+void ReplayEngine::set_speed(double speed_multiplier) {
+    speed_multiplier_ = speed_multiplier;
+}
+
+ReplayEngine::TimePoint ReplayEngine::get_position() const {
+    return TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::nanoseconds(position_ns_.load())));
+}
+
+void ReplayEngine::flush() {
+    if (flush_callback_) {
+        flush_callback_();
+    }
+}
+
 void ReplayEngine::replay_thread() {
-    while (running_ && current_index_ < historical_data_.size()) {
+    drift_.reset();
+    max_drift_ns_ = 0;
+    throughput_ = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    while (running_) {
         process_next_message();
     }
-    running_ = false;
+    flush();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const size_t messages = current_index_;
+    throughput_ = seconds > 0 ? messages / seconds : 0.0;
+
+    if (pacing_speed_ <= 0) {
+        LOG_INFO("Replayed " << messages << " messages in " << seconds << " s (" << static_cast<uint64_t>(throughput_)
+                 << " msg/s)");
+        return;
+    }
+    const PacingStats stats = get_pacing_stats();
+    LOG_INFO("Replayed " << messages << " messages in " << seconds << " s; pacing drift mean "
+             << stats.mean_drift_ns / 1000 << " us, p99 " << stats.p99_drift_ns / 1000 << " us, max "
+             << stats.max_drift_ns / 1000 << " us");
+}
+
+ReplayEngine::PacingStats ReplayEngine::get_pacing_stats() const {
+    PacingStats stats;
+    stats.messages = drift_.count();
+    if (stats.messages > 0) {
+        stats.mean_drift_ns = static_cast<int64_t>(drift_.sum() / stats.messages);
+        stats.p99_drift_ns = static_cast<int64_t>(drift_.percentile(0.99));
+        stats.max_drift_ns = max_drift_ns_.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+bool ReplayEngine::wait_until(std::chrono::steady_clock::time_point deadline) const {
+    return pacing::wait_until(deadline, [this] {
+        return !running_ || paused_ || seek_ns_ != NO_SEEK || speed_multiplier_ != pacing_speed_;
+    });
+}
+
+const NormalizedMarketData* ReplayEngine::next_message() {
+    if (source_) {
+        return source_->next(streamed_message_) ? &streamed_message_ : nullptr;
+    }
+    return memory_position_ < historical_data_.size() ? &historical_data_[memory_position_++] : nullptr;
+}
+
+void ReplayEngine::apply_seek(int64_t timestamp_ns) {
+    flush();
+    if (source_) {
+        source_->seek(timestamp_ns);
+    } else {
+        // In-memory rows are in file order, assumed sorted
+        memory_position_ = static_cast<size_t>(
+            std::lower_bound(historical_data_.begin(), historical_data_.end(), timestamp_ns,
+                             [](const NormalizedMarketData& row, int64_t ts) { return to_ns(row.timestamp) < ts; }) -
+            historical_data_.begin());
+    }
+    pending_ = nullptr;
+    skip_before_ns_ = timestamp_ns;
+    anchored_ = false;
+    LOG_INFO("Replay seeked to " << timestamp_ns / 1000000 << " ms");
 }
 
 void ReplayEngine::process_next_message() {
-    if (current_index_ >= historical_data_.size()) {
+    const int64_t seek_ns = seek_ns_.exchange(NO_SEEK);
+    if (seek_ns != NO_SEEK) {
+        apply_seek(seek_ns);
+    }
+    if (paused_) {
+        flush();
+        std::unique_lock<std::mutex> lock(control_mutex_);
+        control_cv_.wait(lock, [this] { return !paused_ || !running_ || seek_ns_ != NO_SEEK; });
+        anchored_ = false;
         return;
     }
 
-    const auto& message = historical_data_[current_index_];
-    
-    // Calculate delay based on timestamps and speed multiplier
-    if (current_index_ > 0) {
-        auto time_diff = message.timestamp - historical_data_[current_index_ - 1].timestamp;
-        auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
-            time_diff / speed_multiplier_.load());
-        std::this_thread::sleep_for(delay);
+    if (pending_ == nullptr) {
+        pending_ = next_message();
+        if (pending_ == nullptr) {
+            running_ = false;
+            return;
+        }
+        const int64_t ts = to_ns(pending_->timestamp);
+        if (ts < skip_before_ns_) {
+            // Before the seek target; text sources cannot skip these without reading them
+            pending_ = nullptr;
+            return;
+        }
+        skip_before_ns_ = INT64_MIN;
+        if (ts >= range_to_ns_) {
+            pending_ = nullptr;
+            running_ = false;
+            return;
+        }
+    }
+    const NormalizedMarketData& message = *pending_;
+
+    // Schedule against absolute deadlines so per-message sleep error does not
+    // accumulate; late messages go out immediately and the schedule catches up
+    const double speed = speed_multiplier_.load();
+    if (speed > 0) {
+        if (!anchored_) {
+            anchor_time_ = last_message_time_ = message.timestamp;
+            anchor_deadline_ = last_deadline_ = std::chrono::steady_clock::now();
+            anchored_ = true;
+        } else if (speed != pacing_speed_) {
+            anchor_time_ = last_message_time_;
+            anchor_deadline_ = last_deadline_;
+        }
+        pacing_speed_ = speed;
+        const std::chrono::duration<double, std::nano> offset = message.timestamp - anchor_time_;
+        const auto deadline = anchor_deadline_ +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset / pacing_speed_);
+        if (!wait_until(deadline)) {
+            return;  // Stopped, paused, seeking or re-paced; the row stays pending
+        }
+        last_deadline_ = deadline;
+
+        const int64_t drift_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - deadline).count();
+        drift_.record(drift_ns);
+        if (drift_ns > max_drift_ns_.load(std::memory_order_relaxed)) {
+            max_drift_ns_.store(drift_ns, std::memory_order_relaxed);
+        }
+    } else {
+        // Unpaced; pacing resumes from whichever row comes next
+        pacing_speed_ = speed;
+        anchored_ = false;
     }
+    last_message_time_ = message.timestamp;
+    position_ns_ = to_ns(message.timestamp);
 
     // Send the message
     callback_(message);
+    pending_ = nullptr;
     current_index_++;
 }
 
-} // namespace market_data 
\ No newline at end of file
+} // namespace market_data
@@ -1,18 +1,47 @@
 #pragma once
 
 #include "market_data_types.hpp"
+#include "metrics.hpp"
+#include "pacing.hpp"
+#include "replay_source.hpp"
+#include <cmath>
+#include <memory>
 #include <vector>
 #include <chrono>
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 
 namespace market_data {
 
 class ReplayEngine {
 public:
+    // Rows a streaming replay may parse ahead of the replay position
+    static constexpr size_t DEFAULT_READ_AHEAD = 65536;
+    // Pacing sleeps until this close to a deadline, then spins (see pacing.hpp)
+    static constexpr std::chrono::microseconds SPIN_THRESHOLD = pacing::SPIN_THRESHOLD;
+    // Speed multiplier (any value <= 0) that disables pacing: rows go out as
+    // fast as the callback takes them
+    static constexpr double AS_FAST_AS_POSSIBLE = 0.0;
+
+    // How late messages were handed to the callback relative to their
+    // scheduled (timestamp-derived) send time
+    struct PacingStats {
+        uint64_t messages = 0;
+        int64_t mean_drift_ns = 0;
+        int64_t p99_drift_ns = 0;
+        int64_t max_drift_ns = 0;
+    };
+
+    using TimePoint = std::chrono::system_clock::time_point;
     using MessageCallback = std::function<void(const NormalizedMarketData&)>;
+    // Runs on the replay thread whenever the replay goes idle: when it ends
+    // (finished or stopped), on pause and before a seek. Batching callbacks
+    // flush here.
+    using FlushCallback = std::function<void()>;
 
     ReplayEngine(const std::vector<std::string>& symbols, MessageCallback callback);
     ~ReplayEngine();
@@ -24,8 +53,9 @@ public:
                 for (const auto& symbol : symbols_) {
                     NormalizedMarketData data;
                     data.symbol = symbol;
-                    data.price = 100.0 + (rand() % 1000) / 10.0;
-                    data.volume = rand() % 10000;
+                    data.price = lockfree::InstrumentTable::instance().to_price(
+                        symbol.c_str(), 100.0 + std::floor(rng_.uniform() * 1000) / 10.0);
+                    data.volume = std::floor(rng_.uniform() * 10000);
                     data.timestamp = std::chrono::system_clock::now();
                     data.source = "REPLAY";
 
@@ -43,33 +73,116 @@ public:
         }
     }
 
-    // Load historical data from a JSON file
+    // Load historical data (NDJSON or JSON array, see TickLoader) into memory
     bool load_historical_data(const std::string& filename);
     
-    // Start replaying data at specified speed (1.0 = real-time)
+    // Start replaying data at specified speed (1.0 = real-time, AS_FAST_AS_POSSIBLE = unpaced)
     void start_replay(double speed_multiplier = 1.0);
+
+    // Replay straight from a file while it is still being parsed. At most
+    // read_ahead rows are held in memory, so file size is not bounded by RAM.
+    // Binary tick files (see TickFile) are mapped and replayed in place instead.
+    bool start_streaming_replay(const std::string& filename, double speed_multiplier = 1.0,
+                                size_t read_ahead = DEFAULT_READ_AHEAD);
+
+    // Streaming replay of several files (e.g. one per symbol or venue) merged
+    // by timestamp as they are read; see MergedSource. read_ahead is shared
+    // between the text files.
+    bool start_merged_replay(const std::vector<std::string>& filenames, double speed_multiplier = 1.0,
+                             size_t read_ahead = DEFAULT_READ_AHEAD);
     
     // Stop replay
     void stop_replay();
+
+    // Limit replays to rows in [from, to). from is applied as a seek by the
+    // next start_*; to also ends a running replay. Defaults to the whole input.
+    void set_range(TimePoint from, TimePoint to);
+    // Jump to the first row at or after timestamp, forwards or backwards.
+    // Applied by the replay thread before its next row, also while paused.
+    // Binary tick files seek through their block index; text files skip
+    // forward or re-parse from the start.
+    void seek(TimePoint timestamp);
+    // Hold the replay before its next row. resume() continues on a fresh
+    // schedule instead of catching up on the time spent paused.
+    void pause();
+    void resume();
+    // Change speed mid-run; the schedule re-anchors on the last row replayed
+    void set_speed(double speed_multiplier);
     
     // Get current replay status
     bool is_replaying() const { return running_; }
+    bool is_paused() const { return paused_; }
     double get_speed() const { return speed_multiplier_; }
-    size_t get_total_messages() const { return historical_data_.size(); }
+    // Timestamp of the last row replayed (the epoch before the first)
+    TimePoint get_position() const;
+    // Rows loaded so far; still growing while a streaming replay is loading
+    size_t get_total_messages() const { return source_ ? source_->total_rows() : historical_data_.size(); }
+    // Rows replayed so far by the current (or last) replay
     size_t get_current_index() const { return current_index_; }
+    bool is_loading() const { return source_ && source_->loading(); }
+    // Drift of the current (or last) replay
+    PacingStats get_pacing_stats() const;
+    // Messages per second of the last completed replay
+    double get_throughput() const { return throughput_; }
+
+    // Set before starting a replay
+    void set_flush_callback(FlushCallback callback) { flush_callback_ = std::move(callback); }
 
 private:
     void replay_thread();
     void process_next_message();
+    const NormalizedMarketData* next_message();
+    bool start_source(std::unique_ptr<ReplaySource> source, double speed_multiplier);
+    void begin_replay(double speed_multiplier);
+    void apply_seek(int64_t timestamp_ns);
+    void flush();
+    // Sleep then spin until deadline; false if the replay was stopped, paused,
+    // asked to seek or changed speed first
+    bool wait_until(std::chrono::steady_clock::time_point deadline) const;
 
     std::vector<NormalizedMarketData> historical_data_;
     MessageCallback callback_;
+    FlushCallback flush_callback_;
+    std::atomic<double> throughput_{0.0};
     std::atomic<bool> running_;
     std::atomic<double> speed_multiplier_;
-    size_t current_index_;
+    std::atomic<size_t> current_index_;
     std::thread replay_thread_;
-    std::chrono::system_clock::time_point last_message_time_;
+    std::chrono::system_clock::time_point last_message_time_;  // Timestamp of the previous row replayed
+    std::atomic<int64_t> position_ns_{0};                    // Same, for get_position()
+
+    // Controls, written by any thread and acted on by the replay thread
+    static constexpr int64_t NO_SEEK = INT64_MIN;
+    std::atomic<int64_t> seek_ns_{NO_SEEK};
+    std::atomic<int64_t> range_from_ns_{INT64_MIN};
+    std::atomic<int64_t> range_to_ns_{INT64_MAX};
+    std::atomic<bool> paused_{false};
+    std::mutex control_mutex_;
+    std::condition_variable control_cv_;
+
+    // Replay thread state: the row fetched but not yet delivered (kept across
+    // a pause or speed change), rows to skip after a seek, the in-memory cursor
+    const NormalizedMarketData* pending_ = nullptr;
+    int64_t skip_before_ns_ = INT64_MIN;
+    size_t memory_position_ = 0;
+
+    // Absolute-deadline pacing: a row with timestamp ts is due at
+    // anchor_deadline_ + (ts - anchor_time_) / pacing_speed_. Re-anchored on
+    // the previous row's deadline when the speed changes, and on the next row
+    // (now) at the start, after a seek or pause, and when leaving unpaced mode.
+    bool anchored_ = false;
+    std::chrono::system_clock::time_point anchor_time_;
+    std::chrono::steady_clock::time_point anchor_deadline_;
+    std::chrono::steady_clock::time_point last_deadline_;
+    double pacing_speed_ = 1.0;
+    lockfree::LatencyHistogram drift_;
+    std::atomic<int64_t> max_drift_ns_{0};
+
+    // Streaming replay reads from source_ instead of historical_data_
+    std::unique_ptr<ReplaySource> source_;
+    NormalizedMarketData streamed_message_;
     std::vector<std::string> symbols_;
+    lockfree::Xoshiro256 rng_;  // Seeded, so start()'s demo feed is the same every run
     std::atomic<bool> should_continue_;
     std::thread worker_thread_;
 };
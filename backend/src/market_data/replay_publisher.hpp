@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "market_data_types.hpp"
+#include "message_bus.hpp"
+
+namespace market_data {
+
+// ReplayEngine callback that publishes rows to a MessageBus as MARKET_DATA
+// records. Rows are converted into a batch and written with
+// MessageBus::publish_records(), which waits for ring space rather than
+// dropping, so an unpaced replay runs at the consumer's pace without loss.
+// Call flush() from the replay's flush callback, and after each row while
+// the replay is paced.
+class ReplayPublisher {
+public:
+    static constexpr std::size_t MAX_BATCH = 256;
+
+    // should_continue is the bus consumer's run flag and stopping is raised
+    // by whoever stops the replay: publishing stops waiting for ring space
+    // (dropping the rest of the batch) once the consumer is shutting down or
+    // the replay is being stopped, so a stop never waits on a stalled consumer
+    ReplayPublisher(std::shared_ptr<lockfree::MessageBus> bus, const std::atomic<bool>& should_continue,
+                    const std::atomic<bool>& stopping, std::size_t batch_size = MAX_BATCH,
+                    std::string topic = "market_data")
+        : bus_(std::move(bus))
+        , should_continue_(should_continue)
+        , stopping_(stopping)
+        , batch_size_(std::clamp<std::size_t>(batch_size, 1, MAX_BATCH))
+        , topic_(std::move(topic)) {}
+
+    void operator()(const NormalizedMarketData& row) {
+        lockfree::WireRecord& record = batch_[pending_++];
+        lockfree::set_header(record, row.symbol.c_str(), row.source.c_str(),
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 row.timestamp.time_since_epoch()).count());
+        record.set_body(lockfree::TickBody{row.price.rescale(record.price_decimals()).ticks(),
+                                           lockfree::to_fixed(row.volume, lockfree::WireRecord::VOLUME_SCALE)});
+        if (pending_ == batch_size_) {
+            flush();
+        }
+    }
+
+    void flush() {
+        published_ += bus_->publish_records(topic_, batch_.data(), pending_,
+                                            [this] { return should_continue_ && !stopping_; });
+        pending_ = 0;
+    }
+
+    uint64_t published() const { return published_; }
+
+private:
+    std::shared_ptr<lockfree::MessageBus> bus_;
+    const std::atomic<bool>& should_continue_;
+    const std::atomic<bool>& stopping_;
+    std::size_t batch_size_;
+    std::string topic_;
+    std::array<lockfree::WireRecord, MAX_BATCH> batch_;
+    std::size_t pending_ = 0;
+    uint64_t published_ = 0;
+};
+
+} // namespace market_data
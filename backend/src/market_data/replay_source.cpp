@@ -0,0 +1,225 @@
+#include "replay_source.hpp"
+#include <algorithm>
+#include <fstream>
+#include "logger.hpp"
+#include "tick_loader.hpp"
+
+namespace market_data {
+
+std::unique_ptr<ReplaySource> ReplaySource::open(const std::string& filename, size_t read_ahead) {
+    if (filename.rfind(SyntheticSource::PREFIX, 0) == 0) {
+        lockfree::SyntheticFeedConfig config;
+        std::string error;
+        if (!lockfree::SyntheticFeedConfig::parse(filename.substr(SyntheticSource::PREFIX.size()), config, error)) {
+            LOG_ERROR("Bad synthetic feed " << filename << ": " << error);
+            return nullptr;
+        }
+        LOG_INFO("Generating synthetic ticks: " << filename);
+        return std::make_unique<SyntheticSource>(config);
+    }
+    if (TickFile::is_tick_file(filename)) {
+        try {
+            auto source = std::make_unique<TickFileSource>(filename);
+            LOG_INFO("Mapped " << source->total_rows() << " historical messages from " << filename);
+            return source;
+        } catch (const std::exception& e) {
+            LOG_ERROR(e.what());
+            return nullptr;
+        }
+    }
+    std::ifstream probe(filename);
+    if (!probe.is_open()) {
+        LOG_ERROR("Failed to open file: " << filename);
+        return nullptr;
+    }
+    return std::make_unique<TextFileSource>(filename, read_ahead);
+}
+
+TickFileSource::TickFileSource(const std::string& filename) : file_(filename) {
+    if (file_.block_count() > 0) {
+        block_ = file_.block(0, buffer_);
+    }
+}
+
+bool TickFileSource::next(NormalizedMarketData& out) {
+    while (block_row_ >= block_.rows) {
+        if (++block_index_ >= file_.block_count()) {
+            return false;
+        }
+        block_ = file_.block(block_index_, buffer_);
+        block_row_ = 0;
+    }
+    file_.read_row(block_, block_row_++, out);
+    return true;
+}
+
+void TickFileSource::seek(int64_t timestamp_ns) {
+    block_index_ = file_.find_block(timestamp_ns);
+    if (block_index_ >= file_.block_count()) {
+        block_ = TickBlock();
+        block_row_ = 0;
+        return;
+    }
+    block_ = file_.block(block_index_, buffer_);
+    block_row_ = file_.find_row(block_, timestamp_ns);
+}
+
+TextFileSource::TextFileSource(const std::string& filename, size_t read_ahead)
+    : filename_(filename)
+    , read_ahead_(read_ahead) {
+    start_loader();
+}
+
+TextFileSource::~TextFileSource() {
+    close();
+}
+
+void TextFileSource::start_loader() {
+    queue_ = std::make_unique<BoundedQueue<NormalizedMarketData>>(read_ahead_);
+    rows_ = 0;
+    loading_ = true;
+    auto* queue = queue_.get();
+    loader_thread_ = std::thread([this, queue]() {
+        const auto result = TickLoader::load(filename_, [this, queue](NormalizedMarketData& row) {
+            if (!queue->push(std::move(row))) {
+                return false;  // Replay stopped or seeking
+            }
+            ++rows_;
+            return true;
+        });
+        if (!result.ok) {
+            LOG_ERROR("Error streaming historical data: " << result.error);
+        } else if (result.rejected > 0) {
+            LOG_WARN("Skipped " << result.rejected << " historical rows (first: " << result.error << ")");
+        }
+        LOG_INFO("Streamed " << rows_.load() << " historical messages from " << filename_);
+        loading_ = false;
+        queue->close();
+    });
+}
+
+bool TextFileSource::next(NormalizedMarketData& out) {
+    if (!queue_->pop(out)) {
+        return false;
+    }
+    last_timestamp_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(out.timestamp.time_since_epoch()).count();
+    return true;
+}
+
+void TextFileSource::close() {
+    std::lock_guard<std::mutex> lock(loader_mutex_);
+    closed_ = true;
+    queue_->close();
+    if (loader_thread_.joinable()) {
+        loader_thread_.join();
+    }
+}
+
+void TextFileSource::seek(int64_t timestamp_ns) {
+    if (timestamp_ns > last_timestamp_ns_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(loader_mutex_);
+    if (closed_) {
+        return;
+    }
+    queue_->close();
+    if (loader_thread_.joinable()) {
+        loader_thread_.join();
+    }
+    last_timestamp_ns_ = INT64_MIN;
+    start_loader();
+}
+
+SyntheticSource::SyntheticSource(const lockfree::SyntheticFeedConfig& config) : feed_(config) {
+}
+
+bool SyntheticSource::next(NormalizedMarketData& out) {
+    if (!has_tick_ && !feed_.next(tick_)) {
+        return false;
+    }
+    has_tick_ = false;
+    out.symbol = feed_.symbol(tick_.symbol);
+    out.price = lockfree::FixedPrice(tick_.price_ticks, feed_.price_decimals(tick_.symbol));
+    out.volume = tick_.volume;
+    out.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(tick_.timestamp_ns)));
+    out.source = "SYNTHETIC";
+    return true;
+}
+
+size_t SyntheticSource::total_rows() const {
+    return feed_.config().rows != 0 ? feed_.config().rows : feed_.generated();
+}
+
+void SyntheticSource::seek(int64_t timestamp_ns) {
+    feed_.reset();
+    has_tick_ = false;
+    while (feed_.next(tick_)) {
+        if (tick_.timestamp_ns >= timestamp_ns) {
+            has_tick_ = true;
+            return;
+        }
+    }
+}
+
+MergedSource::MergedSource(std::vector<std::unique_ptr<ReplaySource>> sources)
+    : sources_(std::move(sources))
+    , heads_(sources_.size()) {
+    heap_.reserve(sources_.size());
+}
+
+void MergedSource::refill(uint32_t source) {
+    if (sources_[source]->next(heads_[source])) {
+        heap_.push_back({std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             heads_[source].timestamp.time_since_epoch()).count(), source});
+        std::push_heap(heap_.begin(), heap_.end(), later);
+    }
+}
+
+bool MergedSource::next(NormalizedMarketData& out) {
+    // Prime lazily so construction does not wait on loader threads
+    if (!started_) {
+        started_ = true;
+        for (uint32_t i = 0; i < sources_.size(); ++i) {
+            refill(i);
+        }
+    }
+    if (heap_.empty()) {
+        return false;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), later);
+    const uint32_t source = heap_.back().source;
+    heap_.pop_back();
+    std::swap(out, heads_[source]);
+    refill(source);
+    return true;
+}
+
+size_t MergedSource::total_rows() const {
+    size_t rows = 0;
+    for (const auto& source : sources_) {
+        rows += source->total_rows();
+    }
+    return rows;
+}
+
+bool MergedSource::loading() const {
+    return std::any_of(sources_.begin(), sources_.end(), [](const auto& source) { return source->loading(); });
+}
+
+void MergedSource::seek(int64_t timestamp_ns) {
+    for (auto& source : sources_) {
+        source->seek(timestamp_ns);
+    }
+    heap_.clear();
+    started_ = false;
+}
+
+void MergedSource::close() {
+    for (auto& source : sources_) {
+        source->close();
+    }
+}
+
+} // namespace market_data
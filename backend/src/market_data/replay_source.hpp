@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "market_data_types.hpp"
+#include "synthetic_feed.hpp"
+#include "tick_file.hpp"
+
+namespace market_data {
+
+// One input of a streaming replay, yielding rows in order. next() is called
+// from the replay thread only; close() may be called from any thread.
+class ReplaySource {
+public:
+    virtual ~ReplaySource() = default;
+
+    // Next row into out; false at the end of the input or once closed
+    virtual bool next(NormalizedMarketData& out) = 0;
+    // Rows known so far: the total for mapped files, growing while a text file is parsed
+    virtual size_t total_rows() const = 0;
+    virtual bool loading() const { return false; }
+    // Unblock next() and stop any background parsing
+    virtual void close() {}
+    // Reposition so next() resumes at or before the first row at or after
+    // timestamp_ns; callers skip any earlier rows that still come out. Called
+    // from the replay thread.
+    virtual void seek(int64_t timestamp_ns) = 0;
+
+    // Binary tick files are mapped (TickFileSource); NDJSON/JSON files are
+    // parsed on a loader thread holding at most read_ahead rows (TextFileSource);
+    // "synthetic:<spec>" generates ticks (SyntheticSource). Logs and returns
+    // nullptr if the file cannot be opened.
+    static std::unique_ptr<ReplaySource> open(const std::string& filename, size_t read_ahead);
+};
+
+// Mapped binary tick file, decoded a block at a time
+class TickFileSource : public ReplaySource {
+public:
+    // Throws std::runtime_error like TickFile
+    explicit TickFileSource(const std::string& filename);
+
+    bool next(NormalizedMarketData& out) override;
+    size_t total_rows() const override { return file_.row_count(); }
+    // Binary search over the block index, then within the block; files
+    // written out of order (TickFile::sorted()) are scanned instead
+    void seek(int64_t timestamp_ns) override;
+
+private:
+    TickFile file_;
+    TickBlockBuffer buffer_;
+    TickBlock block_;
+    size_t block_index_ = 0;
+    uint32_t block_row_ = 0;
+};
+
+// NDJSON/JSON-array file parsed by TickLoader on a loader thread, handed over
+// through a bounded queue
+class TextFileSource : public ReplaySource {
+public:
+    TextFileSource(const std::string& filename, size_t read_ahead);
+    ~TextFileSource() override;
+
+    bool next(NormalizedMarketData& out) override;
+    size_t total_rows() const override { return rows_; }
+    bool loading() const override { return loading_; }
+    void close() override;
+    // There is no index: seeking forward keeps reading (the caller skips),
+    // seeking backward re-parses the file from the start
+    void seek(int64_t timestamp_ns) override;
+
+private:
+    void start_loader();
+
+    std::string filename_;
+    size_t read_ahead_;
+    // Replaced by seek() on the replay thread; loader_mutex_ orders that
+    // against close() from other threads
+    std::unique_ptr<BoundedQueue<NormalizedMarketData>> queue_;
+    std::mutex loader_mutex_;
+    bool closed_ = false;
+    std::atomic<size_t> rows_{0};
+    std::atomic<bool> loading_{true};
+    int64_t last_timestamp_ns_ = INT64_MIN;  // Of the last row returned
+    std::thread loader_thread_;
+};
+
+// Seeded synthetic ticks from lockfree::SyntheticFeed, opened as e.g.
+// "synthetic:seed=42,symbols=500,rate=2e6,rows=1e8" (keys as
+// SyntheticFeedConfig::parse). Deterministic, so replays of the same spec are
+// identical.
+class SyntheticSource : public ReplaySource {
+public:
+    static constexpr std::string_view PREFIX = "synthetic:";
+
+    explicit SyntheticSource(const lockfree::SyntheticFeedConfig& config);
+
+    bool next(NormalizedMarketData& out) override;
+    // Rows so far for an endless feed
+    size_t total_rows() const override;
+    // There is no index: regenerates from the start up to timestamp_ns
+    void seek(int64_t timestamp_ns) override;
+
+private:
+    lockfree::SyntheticFeed feed_;
+    lockfree::SyntheticTick tick_{};
+    bool has_tick_ = false;  // tick_ was generated by seek() and not yet returned
+};
+
+// k-way merge of several sources by timestamp, using a min-heap of each
+// source's next row. Rows with equal timestamps keep source order, so the
+// merge is deterministic; each source is assumed to be in timestamp order.
+class MergedSource : public ReplaySource {
+public:
+    explicit MergedSource(std::vector<std::unique_ptr<ReplaySource>> sources);
+
+    bool next(NormalizedMarketData& out) override;
+    size_t total_rows() const override;
+    bool loading() const override;
+    void close() override;
+    // Seeks every input and rebuilds the heap
+    void seek(int64_t timestamp_ns) override;
+
+private:
+    struct HeapEntry {
+        int64_t timestamp_ns;
+        uint32_t source;
+    };
+    // Min-heap order for std::push_heap/pop_heap
+    static bool later(const HeapEntry& a, const HeapEntry& b) {
+        return a.timestamp_ns != b.timestamp_ns ? a.timestamp_ns > b.timestamp_ns : a.source > b.source;
+    }
+    void refill(uint32_t source);
+
+    std::vector<std::unique_ptr<ReplaySource>> sources_;
+    std::vector<NormalizedMarketData> heads_;  // Next row of each source
+    std::vector<HeapEntry> heap_;
+    bool started_ = false;
+};
+
+} // namespace market_data
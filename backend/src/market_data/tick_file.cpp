@@ -0,0 +1,357 @@
+#include "tick_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "logger.hpp"
+
+namespace market_data {
+
+TickFile::TickFile(const std::string& filename) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("Failed to open tick file " + filename + ": " + strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<std::size_t>(st.st_size) < sizeof(tick_file::Header)) {
+        close(fd);
+        throw std::runtime_error("Tick file " + filename + " is too small");
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map tick file " + filename + ": " + strerror(errno));
+    }
+    // Replay walks the columns front to back
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(mapping);
+    header_ = reinterpret_cast<const tick_file::Header*>(data_);
+
+    auto fail = [&](const std::string& reason) {
+        munmap(const_cast<char*>(data_), size_);
+        throw std::runtime_error("Tick file " + filename + ": " + reason);
+    };
+    if (header_->magic != tick_file::MAGIC) {
+        fail("bad magic");
+    }
+    if (header_->version == 0 || header_->version > tick_file::VERSION) {
+        fail("unsupported version " + std::to_string(header_->version));
+    }
+    // Subtraction form throughout: offsets and counts are untrusted, so offset + count * size could wrap
+    auto fits = [&](uint64_t offset, uint64_t count, std::size_t entry_size) {
+        return offset <= size_ && count <= (size_ - offset) / entry_size;
+    };
+    if (!fits(header_->symbols_offset, header_->symbol_count, sizeof(tick_file::SymbolEntry)) ||
+        !fits(header_->index_offset, header_->block_count, sizeof(tick_file::BlockIndexEntry)) ||
+        header_->symbols_offset % alignof(tick_file::SymbolEntry) != 0 ||
+        header_->index_offset % alignof(tick_file::BlockIndexEntry) != 0) {
+        fail("section out of bounds");
+    }
+    // read_row() maps unknown symbol ids to the first symbol, so rows need at least one
+    if (header_->row_count > 0 && header_->symbol_count == 0) {
+        fail("rows without symbols");
+    }
+    if (header_->block_rows > tick_file::MAX_BLOCK_ROWS) {
+        fail("block_rows " + std::to_string(header_->block_rows) + " exceeds " +
+             std::to_string(tick_file::MAX_BLOCK_ROWS));
+    }
+    symbols_ = reinterpret_cast<const tick_file::SymbolEntry*>(data_ + header_->symbols_offset);
+    index_ = reinterpret_cast<const tick_file::BlockIndexEntry*>(data_ + header_->index_offset);
+
+    uint64_t rows = 0;
+    for (std::size_t i = 0; i < header_->block_count; ++i) {
+        const auto& entry = index_[i];
+        // Readers size their decode buffers from row_count, so bound it before trusting it
+        if (entry.row_count > header_->block_rows) {
+            fail("block " + std::to_string(i) + " has " + std::to_string(entry.row_count) + " rows, more than " +
+                 std::to_string(header_->block_rows));
+        }
+        const uint64_t bytes = entry.encoded_size != 0 ? entry.encoded_size : tick_file::block_size(entry.row_count);
+        if (entry.offset % tick_file::ALIGNMENT != 0 || !fits(entry.offset, bytes, 1) || entry.first_row != rows) {
+            fail("block " + std::to_string(i) + " out of bounds");
+        }
+        rows += entry.row_count;
+    }
+    if (rows != header_->row_count) {
+        fail("index does not cover " + std::to_string(header_->row_count) + " rows");
+    }
+}
+
+TickFile::~TickFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+bool TickFile::is_tick_file(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    uint64_t magic = 0;
+    return in.read(reinterpret_cast<char*>(&magic), sizeof(magic)) && magic == tick_file::MAGIC;
+}
+
+TickBlock TickFile::block(std::size_t index, TickBlockBuffer& scratch) const {
+    const auto& entry = index_[index];
+    const char* base = data_ + entry.offset;
+    TickBlock block;
+    if (entry.encoded_size != 0) {
+        scratch.timestamps_ns.resize(entry.row_count);
+        scratch.prices.resize(entry.row_count);
+        scratch.volumes.resize(entry.row_count);
+        scratch.symbol_ids.resize(entry.row_count);
+        if (!lockfree::decode_tick_block(reinterpret_cast<const uint8_t*>(base), entry.encoded_size, entry.row_count,
+                                         scratch.timestamps_ns.data(), scratch.prices.data(),
+                                         scratch.volumes.data(), scratch.symbol_ids.data())) {
+            LOG_ERROR("Tick file block " << index << " is corrupt; skipping " << entry.row_count << " rows");
+            return block;
+        }
+        block.rows = entry.row_count;
+        block.timestamps_ns = scratch.timestamps_ns.data();
+        block.prices = scratch.prices.data();
+        block.volumes = scratch.volumes.data();
+        block.symbol_ids = scratch.symbol_ids.data();
+        return block;
+    }
+    block.rows = entry.row_count;
+    block.timestamps_ns = reinterpret_cast<const int64_t*>(base);
+    block.prices = reinterpret_cast<const int64_t*>(base + tick_file::prices_offset(entry.row_count));
+    block.volumes = reinterpret_cast<const int64_t*>(base + tick_file::volumes_offset(entry.row_count));
+    block.symbol_ids = reinterpret_cast<const uint16_t*>(base + tick_file::symbol_ids_offset(entry.row_count));
+    return block;
+}
+
+uint64_t TickFile::block_bytes() const {
+    uint64_t bytes = 0;
+    for (std::size_t i = 0; i < header_->block_count; ++i) {
+        bytes += index_[i].encoded_size != 0 ? index_[i].encoded_size : tick_file::block_size(index_[i].row_count);
+    }
+    return bytes;
+}
+
+std::size_t TickFile::find_block(int64_t timestamp_ns) const {
+    const auto* end = index_ + header_->block_count;
+    auto before = [](const tick_file::BlockIndexEntry& entry, int64_t ts) { return entry.last_timestamp_ns < ts; };
+    if (!sorted()) {
+        // Block maxima are not ordered either; take the first block that reaches timestamp_ns
+        const auto* it = std::find_if_not(index_, end, [&](const auto& entry) { return before(entry, timestamp_ns); });
+        return static_cast<std::size_t>(it - index_);
+    }
+    return static_cast<std::size_t>(std::lower_bound(index_, end, timestamp_ns, before) - index_);
+}
+
+uint32_t TickFile::find_row(const TickBlock& block, int64_t timestamp_ns) const {
+    const int64_t* end = block.timestamps_ns + block.rows;
+    const int64_t* it = sorted()
+        ? std::lower_bound(block.timestamps_ns, end, timestamp_ns)
+        : std::find_if(block.timestamps_ns, end, [timestamp_ns](int64_t ts) { return ts >= timestamp_ns; });
+    return static_cast<uint32_t>(it - block.timestamps_ns);
+}
+
+void TickFile::read_row(const TickBlock& block, uint32_t row, NormalizedMarketData& out) const {
+    const uint16_t id = block.symbol_ids[row];
+    const auto& entry = id < header_->symbol_count ? symbols_[id] : symbols_[0];
+    out.symbol.assign(entry.name, strnlen(entry.name, sizeof(entry.name)));
+    out.price = lockfree::FixedPrice(block.prices[row], entry.price_decimals);
+    out.volume = static_cast<double>(block.volumes[row]) / static_cast<double>(tick_file::VOLUME_SCALE);
+    out.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(block.timestamps_ns[row])));
+    out.source = "REPLAY";
+}
+
+TickFileWriter::TickFileWriter(const std::string& filename, uint32_t block_rows, tick_file::BlockEncoding encoding,
+                               tick_file::CreateMode mode)
+    : filename_(filename)
+    , block_rows_(block_rows == 0 ? tick_file::DEFAULT_BLOCK_ROWS : std::min(block_rows, tick_file::MAX_BLOCK_ROWS))
+    , encoding_(encoding) {
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, tick_file::WRITE_BUFFER_ALIGNMENT, tick_file::WRITE_BUFFER) != 0) {
+        throw std::bad_alloc();
+    }
+    buffer_.reset(static_cast<char*>(buffer));
+    const int create = mode == tick_file::CreateMode::EXCLUSIVE ? O_EXCL : O_TRUNC;
+    fd_ = open(filename.c_str(), O_WRONLY | O_CREAT | create | O_CLOEXEC, 0644);
+    if (fd_ == -1) {
+        throw std::runtime_error("Failed to create tick file " + filename + ": " + strerror(errno));
+    }
+    header_.magic = tick_file::MAGIC;
+    header_.version = tick_file::VERSION;
+    header_.block_rows = block_rows_;
+    // Placeholder; the real header is written by finish()
+    write(&header_, sizeof(header_));
+    timestamps_.reserve(block_rows_);
+    prices_.reserve(block_rows_);
+    volumes_.reserve(block_rows_);
+    ids_.reserve(block_rows_);
+}
+
+TickFileWriter::~TickFileWriter() {
+    try {
+        finish();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Error finishing tick file " << filename_ << ": " << e.what());
+    }
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+void TickFileWriter::write(const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const std::size_t chunk = std::min(size, tick_file::WRITE_BUFFER - buffered_);
+        std::memcpy(buffer_.get() + buffered_, bytes, chunk);
+        buffered_ += chunk;
+        bytes += chunk;
+        size -= chunk;
+        offset_ += chunk;
+        if (buffered_ == tick_file::WRITE_BUFFER) {
+            write_out();
+        }
+    }
+}
+
+void TickFileWriter::write_out() {
+    std::size_t written = 0;
+    while (written < buffered_) {
+        const ssize_t n = ::write(fd_, buffer_.get() + written, buffered_ - written);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to write tick file " + filename_ + ": " + strerror(errno));
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    buffered_ = 0;
+}
+
+void TickFileWriter::sync() {
+    if (finished_) {
+        return;
+    }
+    flush_block();
+    write_out();
+    if (fdatasync(fd_) == -1) {
+        throw std::runtime_error("Failed to sync tick file " + filename_ + ": " + strerror(errno));
+    }
+}
+
+void TickFileWriter::add(const std::string& symbol, lockfree::FixedPrice price, double volume, int64_t timestamp_ns) {
+    auto it = symbol_ids_.find(symbol);
+    if (it == symbol_ids_.end()) {
+        if (symbols_.size() >= tick_file::MAX_SYMBOLS) {
+            throw std::runtime_error("Tick file " + filename_ + " exceeds " +
+                                     std::to_string(tick_file::MAX_SYMBOLS) + " symbols");
+        }
+        tick_file::SymbolEntry entry{};
+        std::strncpy(entry.name, symbol.c_str(), sizeof(entry.name) - 1);
+        entry.price_decimals = price.decimals();
+        it = symbol_ids_.emplace(symbol, static_cast<uint16_t>(symbols_.size())).first;
+        symbols_.push_back(entry);
+    }
+    if (header_.row_count == 0 && timestamps_.empty()) {
+        header_.first_timestamp_ns = timestamp_ns;
+        header_.last_timestamp_ns = timestamp_ns;
+    }
+    if (timestamp_ns < previous_timestamp_ns_ && sorted()) {
+        LOG_WARN("Tick file " << filename_ << " is not in timestamp order from row " << rows_written()
+                 << "; seeks in it will scan");
+        header_.flags |= tick_file::FLAG_UNSORTED;
+    }
+    previous_timestamp_ns_ = timestamp_ns;
+    header_.first_timestamp_ns = std::min(header_.first_timestamp_ns, timestamp_ns);
+    header_.last_timestamp_ns = std::max(header_.last_timestamp_ns, timestamp_ns);
+
+    timestamps_.push_back(timestamp_ns);
+    prices_.push_back(price.rescale(symbols_[it->second].price_decimals).ticks());
+    volumes_.push_back(std::llround(volume * static_cast<double>(tick_file::VOLUME_SCALE)));
+    ids_.push_back(it->second);
+    if (timestamps_.size() >= block_rows_) {
+        flush_block();
+    }
+}
+
+void TickFileWriter::add(const NormalizedMarketData& data) {
+    add(data.symbol, data.price, data.volume,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(data.timestamp.time_since_epoch()).count());
+}
+
+void TickFileWriter::flush_block() {
+    const std::size_t rows = timestamps_.size();
+    if (rows == 0) {
+        return;
+    }
+    tick_file::BlockIndexEntry entry{};
+    entry.offset = tick_file::align_up(offset_);
+    entry.first_row = header_.row_count;
+    entry.row_count = static_cast<uint32_t>(rows);
+    const auto [earliest, latest] = std::minmax_element(timestamps_.begin(), timestamps_.end());
+    entry.first_timestamp_ns = *earliest;
+    entry.last_timestamp_ns = *latest;
+
+    static const char zeros[tick_file::ALIGNMENT] = {};
+    write(zeros, entry.offset - offset_);
+    if (encoding_ == tick_file::BlockEncoding::COMPRESSED) {
+        encoded_.clear();
+        lockfree::encode_tick_block({timestamps_.data(), prices_.data(), volumes_.data(), ids_.data(), rows}, encoded_);
+        entry.encoded_size = static_cast<uint32_t>(encoded_.size());
+        write(encoded_.data(), encoded_.size());
+    } else {
+        write(timestamps_.data(), rows * 8);
+        write(prices_.data(), rows * 8);
+        write(volumes_.data(), rows * 8);
+        write(ids_.data(), rows * 2);
+    }
+
+    index_.push_back(entry);
+    header_.row_count += rows;
+    timestamps_.clear();
+    prices_.clear();
+    volumes_.clear();
+    ids_.clear();
+}
+
+void TickFileWriter::finish() {
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+    flush_block();
+
+    static const char zeros[tick_file::ALIGNMENT] = {};
+    const uint64_t symbols_offset = tick_file::align_up(offset_);
+    write(zeros, symbols_offset - offset_);
+    write(symbols_.data(), symbols_.size() * sizeof(tick_file::SymbolEntry));
+    // Symbol entries are 32 bytes, so the index stays 8-byte aligned
+    const uint64_t index_offset = symbols_offset + symbols_.size() * sizeof(tick_file::SymbolEntry);
+    write(index_.data(), index_.size() * sizeof(tick_file::BlockIndexEntry));
+    write_out();
+
+    header_.symbol_count = static_cast<uint32_t>(symbols_.size());
+    header_.block_count = static_cast<uint32_t>(index_.size());
+    header_.symbols_offset = symbols_offset;
+    header_.index_offset = index_offset;
+    if (pwrite(fd_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_)) || fdatasync(fd_) == -1) {
+        throw std::runtime_error("Failed to write tick file " + filename_ + ": " + strerror(errno));
+    }
+    close(fd_);
+    fd_ = -1;
+}
+
+void TickFileWriter::discard() {
+    finished_ = true;
+    if (fd_ != -1) {
+        close(fd_);
+        fd_ = -1;
+        unlink(filename_.c_str());
+    }
+}
+
+} // namespace market_data
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "market_data_types.hpp"
+#include "tick_codec.hpp"
+
+namespace market_data {
+
+// Binary columnar tick file, read through mmap with no parsing.
+//
+//   Header            64 bytes at offset 0
+//   blocks            block_count blocks, each 64-byte aligned, either raw columns:
+//                       int64  timestamp_ns[rows]   ns since the epoch
+//                       int64  price[rows]          ticks in the symbol's price_decimals
+//                       int64  volume[rows]         VOLUME_SCALE fixed point
+//                       uint16 symbol_id[rows]      index into the symbol dictionary
+//                     or the same columns compressed with lockfree::encode_tick_block
+//                     (BlockIndexEntry::encoded_size != 0)
+//   SymbolEntry       symbol_count entries at symbols_offset
+//   BlockIndexEntry   block_count entries at index_offset
+//
+// All integers are little-endian. Symbol ids are local to the file. Rows are
+// normally in timestamp order; files written from out-of-order input carry
+// FLAG_UNSORTED, keep rows in the order added and are seeked by a linear scan.
+namespace tick_file {
+
+constexpr uint64_t MAGIC = 0x314c4f434b434954ull;  // "TICKCOL1"
+constexpr uint32_t VERSION = 2;                    // 1: raw blocks only
+constexpr uint32_t DEFAULT_BLOCK_ROWS = 65536;
+constexpr uint32_t MAX_BLOCK_ROWS = 1u << 24;      // Bounds the decode buffers a reader allocates per block
+constexpr std::size_t ALIGNMENT = 64;
+constexpr int64_t VOLUME_SCALE = 1000000;          // Same scale as lockfree::WireRecord
+constexpr std::size_t MAX_SYMBOLS = 65535;
+// Header::flags
+constexpr uint16_t FLAG_UNSORTED = 1;              // Some row has an earlier timestamp than the row before
+// TickFileWriter stages output in a page-aligned buffer of this size and
+// writes it out in one syscall
+constexpr std::size_t WRITE_BUFFER = 4 << 20;
+constexpr std::size_t WRITE_BUFFER_ALIGNMENT = 4096;
+
+struct Header {
+    uint64_t magic;
+    uint16_t version;
+    uint16_t flags;             // FLAG_*; 0 in files from before flags existed
+    uint32_t block_rows;        // Rows per full block; the last block and blocks cut by sync() hold fewer
+    uint64_t row_count;
+    uint32_t symbol_count;
+    uint32_t block_count;
+    uint64_t symbols_offset;
+    uint64_t index_offset;
+    int64_t first_timestamp_ns;  // Earliest and latest timestamp in the file
+    int64_t last_timestamp_ns;
+};
+
+struct SymbolEntry {
+    char name[16];
+    uint8_t price_decimals;
+    uint8_t reserved[15];
+};
+
+struct BlockIndexEntry {
+    uint64_t offset;            // File offset of the block
+    uint64_t first_row;
+    uint32_t row_count;
+    uint32_t encoded_size;      // 0 for raw columns, else bytes of the compressed block
+    int64_t first_timestamp_ns; // Earliest and latest timestamp in the block
+    int64_t last_timestamp_ns;
+};
+
+static_assert(sizeof(Header) == 64, "tick file header must be 64 bytes");
+static_assert(sizeof(SymbolEntry) == 32, "symbol entry must be 32 bytes");
+
+inline std::size_t align_up(std::size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+// Column offsets inside a block of n rows
+inline std::size_t prices_offset(std::size_t rows) { return rows * 8; }
+inline std::size_t volumes_offset(std::size_t rows) { return rows * 16; }
+inline std::size_t symbol_ids_offset(std::size_t rows) { return rows * 24; }
+inline std::size_t block_size(std::size_t rows) { return align_up(rows * 26); }
+
+enum class BlockEncoding { RAW, COMPRESSED };
+// EXCLUSIVE fails with EEXIST instead of replacing an existing file
+enum class CreateMode { TRUNCATE, EXCLUSIVE };
+
+} // namespace tick_file
+
+// One block's columns, pointing into the mapping (raw blocks) or into a
+// TickBlockBuffer (compressed blocks)
+struct TickBlock {
+    uint32_t rows = 0;
+    const int64_t* timestamps_ns = nullptr;
+    const int64_t* prices = nullptr;
+    const int64_t* volumes = nullptr;
+    const uint16_t* symbol_ids = nullptr;
+};
+
+// Decode target for compressed blocks; reuse one per reader to avoid allocations
+struct TickBlockBuffer {
+    std::vector<int64_t> timestamps_ns;
+    std::vector<int64_t> prices;
+    std::vector<int64_t> volumes;
+    std::vector<uint16_t> symbol_ids;
+};
+
+// Read-only view of a tick file. Opening maps the file and validates the
+// header and section bounds; nothing is read or parsed up front.
+class TickFile {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or is malformed
+    explicit TickFile(const std::string& filename);
+    ~TickFile();
+
+    TickFile(const TickFile&) = delete;
+    TickFile& operator=(const TickFile&) = delete;
+
+    // Cheap check of the magic number, for format detection
+    static bool is_tick_file(const std::string& filename);
+
+    uint64_t row_count() const { return header_->row_count; }
+    std::size_t block_count() const { return header_->block_count; }
+    std::size_t symbol_count() const { return header_->symbol_count; }
+    int64_t first_timestamp_ns() const { return header_->first_timestamp_ns; }
+    int64_t last_timestamp_ns() const { return header_->last_timestamp_ns; }
+    // False for files written from out-of-order rows (FLAG_UNSORTED)
+    bool sorted() const { return (header_->flags & tick_file::FLAG_UNSORTED) == 0; }
+
+    const tick_file::SymbolEntry& symbol(uint16_t id) const { return symbols_[id]; }
+    const tick_file::BlockIndexEntry& block_info(std::size_t index) const { return index_[index]; }
+    // Columns of a block; compressed blocks are decoded into scratch. A corrupt
+    // block is logged and comes back empty.
+    TickBlock block(std::size_t index, TickBlockBuffer& scratch) const;
+
+    // Bytes of the file holding block data, for reporting the compression ratio
+    uint64_t block_bytes() const;
+
+    // First block that may hold rows at or after timestamp_ns (block_count() if
+    // none): a binary search of the index, or a linear scan if !sorted()
+    std::size_t find_block(int64_t timestamp_ns) const;
+    // First row of a block with a timestamp at or after timestamp_ns (block.rows if none)
+    uint32_t find_row(const TickBlock& block, int64_t timestamp_ns) const;
+
+    // Decode one row into the replay representation
+    void read_row(const TickBlock& block, uint32_t row, NormalizedMarketData& out) const;
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    const tick_file::Header* header_ = nullptr;
+    const tick_file::SymbolEntry* symbols_ = nullptr;
+    const tick_file::BlockIndexEntry* index_ = nullptr;
+};
+
+// Appends rows and writes the dictionary, index and final header on finish().
+// Rows should come in timestamp order; if one does not, the file is marked
+// FLAG_UNSORTED. Prices are stored in the scale of the first price seen for
+// each symbol. Blocks are compressed unless BlockEncoding::RAW is asked for.
+// block_rows of 0 means DEFAULT_BLOCK_ROWS and is capped at MAX_BLOCK_ROWS.
+// Output goes straight to the file descriptor through a WRITE_BUFFER staging
+// buffer; the file is only readable as a tick file once finished.
+class TickFileWriter {
+public:
+    // Throws std::runtime_error if the file cannot be created
+    explicit TickFileWriter(const std::string& filename,
+                            uint32_t block_rows = tick_file::DEFAULT_BLOCK_ROWS,
+                            tick_file::BlockEncoding encoding = tick_file::BlockEncoding::COMPRESSED,
+                            tick_file::CreateMode mode = tick_file::CreateMode::TRUNCATE);
+    ~TickFileWriter();
+
+    // Throws std::runtime_error past tick_file::MAX_SYMBOLS distinct symbols
+    void add(const std::string& symbol, lockfree::FixedPrice price, double volume, int64_t timestamp_ns);
+    void add(const NormalizedMarketData& data);
+
+    // Cut the block being filled short, write out everything staged and
+    // fdatasync(), so a long-running writer reaches the disk at a steady pace
+    void sync();
+    // Also syncs the file before closing it
+    void finish();
+    // Close and delete the file without finishing it, e.g. after bad input
+    void discard();
+
+    uint64_t rows_written() const { return header_.row_count + timestamps_.size(); }
+    bool sorted() const { return (header_.flags & tick_file::FLAG_UNSORTED) == 0; }
+    // File size so far, excluding the block being filled
+    uint64_t bytes_written() const { return offset_; }
+
+private:
+    void flush_block();
+    void write(const void* data, std::size_t size);
+    void write_out();
+
+    std::string filename_;
+    int fd_ = -1;
+    std::unique_ptr<char, decltype(&std::free)> buffer_{nullptr, &std::free};
+    std::size_t buffered_ = 0;
+    uint32_t block_rows_;
+    tick_file::BlockEncoding encoding_;
+    uint64_t offset_ = 0;
+    bool finished_ = false;
+    int64_t previous_timestamp_ns_ = INT64_MIN;
+    tick_file::Header header_{};
+    std::vector<tick_file::SymbolEntry> symbols_;
+    std::unordered_map<std::string, uint16_t> symbol_ids_;
+    std::vector<tick_file::BlockIndexEntry> index_;
+    // Columns of the block being filled
+    std::vector<int64_t> timestamps_;
+    std::vector<int64_t> prices_;
+    std::vector<int64_t> volumes_;
+    std::vector<uint16_t> ids_;
+    std::vector<uint8_t> encoded_;
+};
+
+} // namespace market_data
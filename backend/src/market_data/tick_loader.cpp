@@ -0,0 +1,201 @@
+#include "tick_loader.hpp"
+#include <cctype>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include "logger.hpp"
+
+namespace market_data {
+
+namespace {
+
+// SAX handler that assembles one row per object at record_depth and ignores
+// anything nested deeper
+class TickSax : public nlohmann::json_sax<json> {
+public:
+    TickSax(const TickLoader::TickCallback& on_tick, TickLoader::Result& result, int record_depth)
+        : on_tick_(on_tick), result_(result), record_depth_(record_depth) {}
+
+    bool stopped() const { return stopped_; }
+    const std::string& error() const { return error_; }
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t value) override { return number(static_cast<double>(value), value); }
+    bool number_unsigned(number_unsigned_t value) override {
+        return number(static_cast<double>(value), static_cast<int64_t>(value));
+    }
+    bool number_float(number_float_t value, const string_t&) override {
+        return number(value, static_cast<int64_t>(value));
+    }
+
+    bool string(string_t& value) override {
+        if (in_record_field()) {
+            if (field_ == Field::SYMBOL) {
+                row_.symbol.swap(value);
+                has_symbol_ = true;
+            } else if (field_ == Field::SOURCE) {
+                row_.source.swap(value);
+            }
+        }
+        return true;
+    }
+
+    bool binary(binary_t&) override { return true; }
+
+    bool start_object(std::size_t) override {
+        if (++depth_ == record_depth_) {
+            row_.symbol.clear();
+            row_.source = "REPLAY";
+            row_.volume = 0.0;
+            row_.timestamp = std::chrono::system_clock::time_point();
+            price_ = 0.0;
+            has_symbol_ = has_price_ = false;
+        }
+        field_ = Field::OTHER;
+        return true;
+    }
+
+    bool key(string_t& name) override {
+        if (depth_ == record_depth_) {
+            field_ = name == "symbol" ? Field::SYMBOL
+                   : name == "price" ? Field::PRICE
+                   : name == "volume" ? Field::VOLUME
+                   : name == "timestamp" ? Field::TIMESTAMP
+                   : name == "source" ? Field::SOURCE
+                   : Field::OTHER;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (depth_-- != record_depth_) {
+            return true;
+        }
+        if (!has_symbol_ || !has_price_) {
+            reject("row without symbol or price");
+            return true;
+        }
+        row_.price = lockfree::InstrumentTable::instance().to_price(row_.symbol.c_str(), price_);
+        ++result_.loaded;
+        if (!on_tick_(row_)) {
+            stopped_ = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        ++depth_;
+        return true;
+    }
+
+    bool end_array() override {
+        --depth_;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& e) override {
+        error_ = "parse error at byte " + std::to_string(position) + ": " + e.what();
+        return false;
+    }
+
+    void reject(const std::string& reason) {
+        if (result_.rejected++ == 0) {
+            result_.error = reason;
+        }
+    }
+
+    // NDJSON reuses one handler for every line
+    void reset_depth() { depth_ = 0; }
+
+private:
+    enum class Field { OTHER, SYMBOL, PRICE, VOLUME, TIMESTAMP, SOURCE };
+
+    bool in_record_field() const { return depth_ == record_depth_ && field_ != Field::OTHER; }
+
+    bool number(double value, int64_t integer) {
+        if (in_record_field()) {
+            switch (field_) {
+                case Field::PRICE: price_ = value; has_price_ = true; break;
+                case Field::VOLUME: row_.volume = value; break;
+                case Field::TIMESTAMP:
+                    row_.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(integer));
+                    break;
+                default: break;
+            }
+        }
+        return true;
+    }
+
+    const TickLoader::TickCallback& on_tick_;
+    TickLoader::Result& result_;
+    const int record_depth_;
+    int depth_ = 0;
+    Field field_ = Field::OTHER;
+    NormalizedMarketData row_;
+    double price_ = 0.0;
+    bool has_symbol_ = false;
+    bool has_price_ = false;
+    bool stopped_ = false;
+    std::string error_;
+};
+
+TickLoader::Format detect_format(std::istream& in) {
+    int c;
+    while ((c = in.peek()) != EOF && std::isspace(c)) {
+        in.get();
+    }
+    return c == '[' ? TickLoader::Format::JSON_ARRAY : TickLoader::Format::NDJSON;
+}
+
+} // namespace
+
+TickLoader::Result TickLoader::load(const std::string& filename, const TickCallback& on_tick, Format format) {
+    Result result;
+    // A large stream buffer keeps the per-byte SAX reads out of the kernel
+    std::vector<char> buffer(1 << 20);
+    std::ifstream file;
+    file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.open(filename, std::ios::binary);
+    if (!file.is_open()) {
+        result.error = "failed to open " + filename;
+        return result;
+    }
+    if (format == Format::AUTO) {
+        format = detect_format(file);
+    }
+
+    if (format == Format::JSON_ARRAY) {
+        TickSax sax(on_tick, result, 2);
+        const bool parsed = json::sax_parse(file, &sax);
+        result.ok = parsed || sax.stopped();
+        if (!result.ok && result.error.empty()) {
+            result.error = sax.error();
+        }
+        return result;
+    }
+
+    TickSax sax(on_tick, result, 1);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::size_t length = line.size();
+        while (length > 0 && std::isspace(static_cast<unsigned char>(line[length - 1]))) {
+            --length;
+        }
+        if (length == 0) {
+            continue;
+        }
+        sax.reset_depth();
+        if (!json::sax_parse(line.data(), line.data() + length, &sax)) {
+            if (sax.stopped()) {
+                break;
+            }
+            sax.reject(sax.error());
+        }
+    }
+    result.ok = true;
+    return result;
+}
+
+} // namespace market_data
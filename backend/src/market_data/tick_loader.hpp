@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "market_data_types.hpp"
+
+namespace market_data {
+
+// Streaming reader for historical tick files. Rows are parsed with the
+// nlohmann SAX interface straight into NormalizedMarketData, so memory use is
+// one row plus the stream buffer however large the file is.
+//
+// Two layouts are accepted, detected from the first non-blank byte:
+//   NDJSON      one {"symbol","price","volume","timestamp"[,"source"]} object per line
+//   JSON array  [ {...}, {...}, ... ] as written by older captures
+// timestamp is milliseconds since the epoch.
+class TickLoader {
+public:
+    enum class Format { AUTO, NDJSON, JSON_ARRAY };
+
+    // Return false to stop loading early
+    using TickCallback = std::function<bool(NormalizedMarketData&)>;
+
+    struct Result {
+        bool ok = false;          // File opened and parsed to the end (or stopped by the callback)
+        std::size_t loaded = 0;   // Rows handed to the callback
+        std::size_t rejected = 0; // Rows missing symbol/price, or malformed NDJSON lines
+        std::string error;        // First error seen
+    };
+
+    // Parse filename on the calling thread, handing each row to on_tick in file order
+    static Result load(const std::string& filename, const TickCallback& on_tick, Format format = Format::AUTO);
+};
+
+} // namespace market_data
@@ -1,5 +1,7 @@
 #include "message_bus.hpp"
-#include <iostream>
+#include "logger.hpp"
+#include <algorithm>
+#include <array>
 #include <iomanip>
 #include <ctime>
 #include <cstring>
@@ -10,12 +12,12 @@ namespace lockfree {
 MessageBus::MessageBus(const std::string& name, std::size_t buffer_size)
     : shared_memory_(std::make_unique<SharedMemory>(name, buffer_size)) {
     
-    std::cout << "\n=== Creating MessageBus ===" << std::endl;
+    LOG_DEBUG("=== Creating MessageBus ===");
     
     try {
         // Calculate the size needed for the ring buffer
         const size_t ring_buffer_size = sizeof(RingBuffer<MessageWrapper, DEFAULT_RING_BUFFER_SIZE>);
-        std::cout << "Ring buffer size: " << ring_buffer_size << " bytes" << std::endl;
+        LOG_DEBUG("Ring buffer size: " << ring_buffer_size << " bytes");
         
         // Create the ring buffer in shared memory
         ring_buffer_ = std::unique_ptr<RingBuffer<MessageWrapper, DEFAULT_RING_BUFFER_SIZE>,
@@ -26,121 +28,155 @@ MessageBus::MessageBus(const std::string& name, std::size_t buffer_size)
                 }
             );
         
-        std::cout << "Ring buffer created successfully" << std::endl;
-        std::cout << "Buffer capacity: " << ring_buffer_->capacity() << " messages" << std::endl;
+        LOG_DEBUG("Ring buffer created successfully");
+        LOG_INFO("MessageBus buffer capacity: " << ring_buffer_->capacity() << " messages");
         
     } catch (const std::exception& e) {
-        std::cerr << "Failed to create ring buffer: " << e.what() << std::endl;
+        LOG_ERROR("Failed to create ring buffer: " << e.what());
         throw;
     }
     
-    std::cout << "=== MessageBus creation complete ===\n" << std::endl;
+    LOG_DEBUG("=== MessageBus creation complete ===");
 }
 
-bool MessageBus::publish(const std::string& topic, const MarketData& data) {
+bool MessageBus::publish(const std::string& topic, const MarketData& data, int64_t ingest_ns) {
+    const int64_t start_ns = monotonic_ns();
     try {
         MessageWrapper wrapper;
-        wrapper.type = MessageType::MARKET_DATA;
-        
-        // Copy the symbol to fixed-size array
-        strncpy(wrapper.data.market_data.symbol, data.symbol, sizeof(wrapper.data.market_data.symbol) - 1);
-        wrapper.data.market_data.symbol[sizeof(wrapper.data.market_data.symbol) - 1] = '\0';
-        
-        wrapper.data.market_data.price = data.price;
-        wrapper.data.market_data.volume = data.volume;
-        wrapper.data.market_data.seq = sequence_.fetch_add(1, std::memory_order_relaxed) + 1;
-        wrapper.data.market_data.timestamp = data.timestamp;
-        
-        // Copy the source to fixed-size array
-        strncpy(wrapper.data.market_data.source, data.source, sizeof(wrapper.data.market_data.source) - 1);
-        wrapper.data.market_data.source[sizeof(wrapper.data.market_data.source) - 1] = '\0';
-        
-        // Try to write to the ring buffer
-        if (!ring_buffer_->write(wrapper)) {
-            std::cerr << "Failed to write to ring buffer - buffer full" << std::endl;
-            dropped_count_.fetch_add(1, std::memory_order_relaxed);
-            return false;
-        }
-        
-        published_count_.fetch_add(1, std::memory_order_relaxed);
-        return true;
+        to_wire(data, wrapper);
+        return write_record(wrapper, ingest_ns, start_ns);
     } catch (const std::exception& e) {
-        std::cerr << "Error publishing message: " << e.what() << std::endl;
+        LOG_ERROR("Error publishing message: " << e.what());
         return false;
     }
 }
 
-void MessageBus::process_messages(std::atomic<bool>& should_continue) {
-    while (should_continue) {
+bool MessageBus::publish_record([[maybe_unused]] const std::string& topic, WireRecord& record, int64_t ingest_ns) {
+    return write_record(record, ingest_ns, monotonic_ns());
+}
+
+bool MessageBus::write_record(WireRecord& record, int64_t ingest_ns, int64_t start_ns) {
+    auto& metrics = PipelineMetrics::instance();
+    record.seq = sequence_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    // Try to write to the ring buffer
+    record.ring_write_ns = monotonic_ns();
+    record.set_ingest_ns(ingest_ns != 0 ? ingest_ns : start_ns);
+    if (!ring_buffer_->write(record)) {
+        // Rate limited: under a flood a line per drop would stall the publisher
+        LOG_WARN_RATE_LIMITED(1000, "Failed to write to ring buffer - buffer full");
+        dropped_count_.add();
+        return false;
+    }
+
+    published_count_.add();
+    metrics.publish_latency.record(monotonic_ns() - start_ns);
+    metrics.ingest_to_ring.record(record.ingest_delta_ns);
+    return true;
+}
+
+std::size_t MessageBus::publish_batch([[maybe_unused]] const std::string& topic, const MarketData* items,
+                                      std::size_t count, int64_t ingest_ns) {
+    auto& metrics = PipelineMetrics::instance();
+    std::array<WireRecord, PUBLISH_CHUNK> chunk;
+    std::size_t accepted = 0;
+    while (accepted < count) {
+        const int64_t start_ns = monotonic_ns();
+        const std::size_t size = std::min(count - accepted, chunk.size());
+        // Convert before claiming: claimed slots must be published whatever happens
         try {
-            MessageWrapper wrapper;
-            if (ring_buffer_->read(wrapper)) {
-                if (wrapper.type == MessageType::MARKET_DATA) {
-                    // Convert back to MarketData
-                    MarketData data;
-                    strncpy(data.symbol, wrapper.data.market_data.symbol, sizeof(data.symbol) - 1);
-                    data.symbol[sizeof(data.symbol) - 1] = '\0';
-                    data.price = wrapper.data.market_data.price;
-                    data.volume = wrapper.data.market_data.volume;
-                    data.seq = wrapper.data.market_data.seq;
-                    data.timestamp = wrapper.data.market_data.timestamp;
-                    strncpy(data.source, wrapper.data.market_data.source, sizeof(data.source) - 1);
-                    data.source[sizeof(data.source) - 1] = '\0';
-                    
-                    // Notify all subscribers for this topic
-                    auto it = subscribers_.find("market_data");
-                    if (it != subscribers_.end()) {
-                        for (const auto& callback : it->second) {
-                            try {
-                                callback(data);
-                            } catch (const std::exception& e) {
-                                std::cerr << "Error in subscriber callback: " << e.what() << std::endl;
-                            }
-                        }
-                    }
-                    processed_count_.fetch_add(1, std::memory_order_relaxed);
-                }
-            }
-            int delay = processing_delay_ms_.load(std::memory_order_relaxed);
-            if (delay > 0) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+            for (std::size_t i = 0; i < size; ++i) {
+                to_wire(items[accepted + i], chunk[i]);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error processing messages: " << e.what() << std::endl;
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            LOG_ERROR("Error publishing message: " << e.what());
+            dropped_count_.add(count - accepted);
+            return accepted;
+        }
+
+        // Reserve seq only for claimed slots, so a short claim leaves no gap
+        uint64_t first_seq = 0;
+        const int64_t write_ns = monotonic_ns();
+        const auto reserve_seq = [&](std::size_t claimed) {
+            first_seq = sequence_.fetch_add(claimed, std::memory_order_relaxed) + 1;
+        };
+        const std::size_t written = ring_buffer_->write_batch(size, reserve_seq, [&](std::size_t i) -> const WireRecord& {
+            WireRecord& record = chunk[i];
+            record.seq = first_seq + i;
+            record.ring_write_ns = write_ns;
+            record.set_ingest_ns(ingest_ns != 0 ? ingest_ns : start_ns);
+            return record;
+        });
+
+        published_count_.add(written);
+        // One claim serves the whole chunk, so each record is charged its share
+        const int64_t latency_ns = written > 0 ? (monotonic_ns() - start_ns) / static_cast<int64_t>(written) : 0;
+        for (std::size_t i = 0; i < written; ++i) {
+            metrics.publish_latency.record(latency_ns);
+            metrics.ingest_to_ring.record(chunk[i].ingest_delta_ns);
+        }
+        accepted += written;
+        if (written < size) {
+            LOG_WARN_RATE_LIMITED(1000, "Failed to write to ring buffer - buffer full");
+            dropped_count_.add(count - accepted);
+            break;
         }
     }
+    return accepted;
+}
+
+void MessageBus::process_messages(std::atomic<bool>& should_continue) {
+    auto deliver = [this](const WireRecord& record, const TickBody&, const PipelineStamps& ring_stamps) {
+        auto it = subscribers_.find("market_data");
+        if (it == subscribers_.end()) {
+            return;
+        }
+        // Convert back to MarketData
+        MarketData data;
+        from_wire(record, data);
+        PipelineStamps stamps = ring_stamps;
+        for (const auto& callback : it->second) {
+            stamps.callback_ns = monotonic_ns();
+            try {
+                callback(data, stamps);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Error in subscriber callback: " << e.what());
+            }
+        }
+    };
+    process_messages(should_continue, deliver);
 }
 
 MessageBus::~MessageBus() {
-    std::cout << "\n=== Destroying MessageBus ===" << std::endl;
+    LOG_DEBUG("=== Destroying MessageBus ===");
     
     try {
         // Destroy the ring buffer first
         if (ring_buffer_) {
-            std::cout << "Destroying ring buffer..." << std::endl;
+            LOG_DEBUG("Destroying ring buffer...");
             ring_buffer_.reset();
-            std::cout << "Ring buffer destroyed" << std::endl;
+            LOG_DEBUG("Ring buffer destroyed");
         }
         
         // Then destroy the shared memory
         if (shared_memory_) {
-            std::cout << "Destroying shared memory..." << std::endl;
+            LOG_DEBUG("Destroying shared memory...");
             shared_memory_.reset();
-            std::cout << "Shared memory destroyed" << std::endl;
+            LOG_DEBUG("Shared memory destroyed");
         }
         
     } catch (const std::exception& e) {
-        std::cerr << "Error during cleanup: " << e.what() << std::endl;
+        LOG_ERROR("Error during cleanup: " << e.what());
     }
     
-    std::cout << "=== MessageBus destruction complete ===\n" << std::endl;
+    LOG_DEBUG("=== MessageBus destruction complete ===");
 }
 
 void MessageBus::reset_counters() {
-    published_count_.store(0, std::memory_order_relaxed);
-    processed_count_.store(0, std::memory_order_relaxed);
-    dropped_count_.store(0, std::memory_order_relaxed);
+    published_count_.reset();
+    processed_count_.reset();
+    dropped_count_.reset();
+    backpressure_waits_.reset();
 }
 
 } // namespace lockfree 
\ No newline at end of file
@@ -11,78 +11,131 @@
 #include <cstring>
 #include "shared_memory.hpp"
 #include "ring_buffer.hpp"
+#include "sharded_counter.hpp"
+#include "wire_record.hpp"
+#include "metrics.hpp"
+#include "logger.hpp"
 
 namespace lockfree {
 
-struct MarketData {
-    char symbol[16];
-    double price;
-    double volume;
-    uint64_t seq;     // Monotonic sequence id
-    int64_t timestamp;  // Store as int64_t instead of time_point
-    char source[32];    // Fixed-size array instead of std::string
-};
-
-enum class MessageType {
-    MARKET_DATA
-};
-
-struct MessageWrapper {
-    MessageType type;
-    union {
-        MarketData market_data;
-    } data;
-
-    // Default constructor
-    MessageWrapper() : type(MessageType::MARKET_DATA) {
-        std::memset(&data, 0, sizeof(data));
-    }
-
-    // Copy constructor
-    MessageWrapper(const MessageWrapper& other) : type(other.type) {
-        std::memcpy(&data, &other.data, sizeof(data));
-    }
-
-    // Move constructor
-    MessageWrapper(MessageWrapper&& other) noexcept : type(other.type) {
-        std::memcpy(&data, &other.data, sizeof(data));
-    }
-
-    // Copy assignment
-    MessageWrapper& operator=(const MessageWrapper& other) {
-        if (this != &other) {
-            type = other.type;
-            std::memcpy(&data, &other.data, sizeof(data));
-        }
-        return *this;
-    }
-
-    // Move assignment
-    MessageWrapper& operator=(MessageWrapper&& other) noexcept {
-        if (this != &other) {
-            type = other.type;
-            std::memcpy(&data, &other.data, sizeof(data));
-        }
-        return *this;
-    }
-};
+// Ring buffer slot: the compact one-cache-line record
+using MessageWrapper = WireRecord;
 
 class MessageBus {
 public:
     static constexpr std::size_t DEFAULT_RING_BUFFER_SIZE = 1024;
+    // Records publish_batch() converts and claims ring space for at a time
+    static constexpr std::size_t PUBLISH_CHUNK = 64;
 
     MessageBus(const std::string& name, std::size_t buffer_size = DEFAULT_RING_BUFFER_SIZE);
     ~MessageBus();
 
-    bool publish(const std::string& topic, const MarketData& data);
+    using TracedCallback = std::function<void(const MarketData&, const PipelineStamps&)>;
+
+    // ingest_ns is the monotonic_ns() stamp taken when the data entered the process;
+    // 0 means publish() itself is the ingest point
+    bool publish(const std::string& topic, const MarketData& data, int64_t ingest_ns = 0);
+    // Publish a typed message prepared with set_header()/set_body(); the bus
+    // assigns seq and the ring stamps
+    bool publish_record(const std::string& topic, WireRecord& record, int64_t ingest_ns = 0);
     // Backward-compatible overload: default to "market_data" topic
     bool publish(const MarketData& data) { return publish("market_data", data); }
+    // Publish a contiguous batch, claiming ring slots PUBLISH_CHUNK at a time
+    // rather than per item. Returns how many were accepted, always the first
+    // ones; the rest are dropped (counted once each) once the ring fills up.
+    std::size_t publish_batch(const std::string& topic, const MarketData* items, std::size_t count,
+                              int64_t ingest_ns = 0);
+    // Publish prepared records in order, waiting for ring space instead of
+    // dropping (for replays and other producers that must not lose data).
+    // While the ring is full keep_waiting() is polled; returns how many were
+    // written, short only if it returned false. publish_latency includes the
+    // time spent waiting.
+    template<typename KeepWaiting>
+    std::size_t publish_records([[maybe_unused]] const std::string& topic, WireRecord* records, std::size_t count,
+                                KeepWaiting&& keep_waiting, int64_t ingest_ns = 0) {
+        auto& metrics = PipelineMetrics::instance();
+        const int64_t start_ns = monotonic_ns();
+        for (std::size_t i = 0; i < count; ++i) {
+            WireRecord& record = records[i];
+            record.seq = sequence_.fetch_add(1, std::memory_order_relaxed) + 1;
+            const int64_t record_start_ns = monotonic_ns();
+            record.ring_write_ns = record_start_ns;
+            record.set_ingest_ns(ingest_ns != 0 ? ingest_ns : start_ns);
+            if (!ring_buffer_->write(record)) {
+                backpressure_waits_.add();
+                // Spin briefly for the consumer to catch up, then yield the CPU to it
+                for (unsigned spins = 0;; ++spins) {
+                    if (!keep_waiting()) {
+                        return i;
+                    }
+                    if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+                        __builtin_ia32_pause();
+#endif
+                    } else {
+                        std::this_thread::yield();
+                    }
+                    record.ring_write_ns = monotonic_ns();
+                    record.set_ingest_ns(ingest_ns != 0 ? ingest_ns : start_ns);
+                    if (ring_buffer_->write(record)) {
+                        break;
+                    }
+                }
+            }
+            published_count_.add();
+            metrics.publish_latency.record(monotonic_ns() - record_start_ns);
+            metrics.ingest_to_ring.record(record.ingest_delta_ns);
+        }
+        return count;
+    }
+    // Consumer loop that hands MARKET_DATA ticks to the subscribe() callbacks;
+    // other message kinds are consumed and counted but not delivered
     void process_messages(std::atomic<bool>& should_continue);
 
+    // Consumer loop that dispatches every record to
+    //   visitor(const WireRecord&, const Body&, const PipelineStamps&)
+    // for its body type (see visit()). The dispatch is resolved at compile time
+    // per visitor type, so no std::function sits between the ring and the handler.
+    template<typename Visitor>
+    void process_messages(std::atomic<bool>& should_continue, Visitor& visitor) {
+        auto& metrics = PipelineMetrics::instance();
+        while (should_continue) {
+            try {
+                MessageWrapper wrapper;
+                if (ring_buffer_->read(wrapper)) {
+                    PipelineStamps stamps;
+                    stamps.ingest_ns = wrapper.ingest_ns();
+                    stamps.ring_write_ns = wrapper.ring_write_ns;
+                    stamps.ring_read_ns = monotonic_ns();
+                    metrics.ring_residence.record(stamps.ring_read_ns - stamps.ring_write_ns);
+                    stamps.callback_ns = monotonic_ns();
+                    metrics.dispatch.record(stamps.callback_ns - stamps.ring_read_ns);
+                    try {
+                        if (visit(wrapper, visitor, stamps)) {
+                            metrics.subscriber_callback.record(monotonic_ns() - stamps.callback_ns);
+                        }
+                    } catch (const std::exception& e) {
+                        LOG_ERROR("Error in subscriber callback: " << e.what());
+                    }
+                    processed_count_.add();
+                }
+                int delay = processing_delay_ms_.load(std::memory_order_relaxed);
+                if (delay > 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+                }
+            } catch (const std::exception& e) {
+                LOG_ERROR("Error processing messages: " << e.what());
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+    }
+
     template<typename T>
     void subscribe(const std::string& topic, std::function<void(const T&)> callback) {
         if constexpr (std::is_same_v<T, MarketData>) {
-            subscribers_[topic].push_back(callback);
+            subscribers_[topic].push_back([callback](const MarketData& data, const PipelineStamps&) {
+                callback(data);
+            });
         }
     }
 
@@ -90,12 +143,17 @@ public:
     template<typename T>
     void subscribe(std::function<void(const T*)> callback) {
         if constexpr (std::is_same_v<T, MarketData>) {
-            subscribers_["market_data"].push_back([callback](const MarketData& data) {
+            subscribers_["market_data"].push_back([callback](const MarketData& data, const PipelineStamps&) {
                 callback(&data);
             });
         }
     }
 
+    // Subscriber that also receives the pipeline stamps, to carry them further downstream
+    void subscribe_traced(const std::string& topic, TracedCallback callback) {
+        subscribers_[topic].push_back(std::move(callback));
+    }
+
     // Test helper methods
     size_t get_read_index() const { return ring_buffer_->get_read_index(); }
     size_t get_write_index() const { return ring_buffer_->get_write_index(); }
@@ -110,22 +168,29 @@ public:
     int get_processing_delay_ms() const { return processing_delay_ms_.load(); }
     void set_processing_delay_ms(int ms) { processing_delay_ms_.store(std::max(0, ms)); }
     uint64_t get_dropped_count() const { return dropped_count_.load(); }
+    // Times publish_records() found the ring full and had to wait
+    uint64_t get_backpressure_waits() const { return backpressure_waits_.load(); }
     void reset_counters();
 
 private:
+    // start_ns is when publishing began; it stands in for a missing ingest stamp
+    bool write_record(WireRecord& record, int64_t ingest_ns, int64_t start_ns);
+
     std::unique_ptr<SharedMemory> shared_memory_;
     std::unique_ptr<RingBuffer<MessageWrapper, DEFAULT_RING_BUFFER_SIZE>, 
                    std::function<void(RingBuffer<MessageWrapper, DEFAULT_RING_BUFFER_SIZE>*)>> ring_buffer_;
-    std::unordered_map<std::string, std::vector<std::function<void(const MarketData&)>>> subscribers_;
+    std::unordered_map<std::string, std::vector<TracedCallback>> subscribers_;
 
-    // Counters
-    std::atomic<uint64_t> published_count_{0};
-    std::atomic<uint64_t> processed_count_{0};
-    std::atomic<uint64_t> dropped_count_{0};
+    // Counters: sharded per thread so producers and the consumer don't false-share
+    ShardedCounter<> published_count_;
+    ShardedCounter<> processed_count_;
+    ShardedCounter<> dropped_count_;
+    ShardedCounter<> backpressure_waits_;
     // Artificial processing delay to visualize buffer occupancy
     std::atomic<int> processing_delay_ms_{0};
-    // Global sequence for messages
-    std::atomic<uint64_t> sequence_{0};
+    // Global sequence for messages; every producer bumps it, so keep it off the
+    // line holding processing_delay_ms_, which the consumer reads per message
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> sequence_{0};
 };
 
 } // namespace lockfree 
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+namespace lockfree {
+
+// Message kinds carried by the ring. Each kind has a fixed-size body below that
+// fits the 32-byte payload of a WireRecord.
+enum class MessageType : uint8_t {
+    MARKET_DATA = 0,  // Legacy price/volume tick
+    TRADE = 1,
+    QUOTE = 2,        // Top of book
+    BOOK_DELTA = 3,   // One L2 level change
+    HEARTBEAT = 4,
+    STATUS = 5
+};
+
+enum class Side : uint8_t {
+    UNKNOWN = 0,
+    BUY = 1,
+    SELL = 2
+};
+
+enum class BookAction : uint8_t {
+    ADD = 0,
+    UPDATE = 1,
+    DELETE = 2
+};
+
+enum class MarketStatus : uint8_t {
+    UNKNOWN = 0,
+    PRE_OPEN = 1,
+    OPEN = 2,
+    HALTED = 3,
+    CLOSED = 4
+};
+
+// Prices are FixedPrice ticks in the symbol's scale (SymbolRegistry::price_decimals),
+// sizes are fixed-point in WireRecord::VOLUME_SCALE units.
+
+struct TickBody {
+    static constexpr MessageType TYPE = MessageType::MARKET_DATA;
+    int64_t price;
+    int64_t volume;
+};
+
+struct Trade {
+    static constexpr MessageType TYPE = MessageType::TRADE;
+    int64_t price;
+    int64_t size;
+    uint64_t trade_id;   // Venue trade id, 0 if the feed has none
+    Side aggressor;
+};
+
+struct Quote {
+    static constexpr MessageType TYPE = MessageType::QUOTE;
+    int64_t bid_price;
+    int64_t bid_size;
+    int64_t ask_price;
+    int64_t ask_size;
+};
+
+struct BookDelta {
+    static constexpr MessageType TYPE = MessageType::BOOK_DELTA;
+    int64_t price;
+    int64_t size;        // New size at the level; 0 with DELETE
+    uint16_t level;      // 0 is the top of book
+    Side side;
+    BookAction action;
+};
+
+struct Heartbeat {
+    static constexpr MessageType TYPE = MessageType::HEARTBEAT;
+    uint64_t feed_seq;   // Last sequence the source produced, for gap detection
+};
+
+struct Status {
+    static constexpr MessageType TYPE = MessageType::STATUS;
+    MarketStatus status;
+    char reason[31];
+};
+
+template<typename Body>
+inline constexpr bool is_message_body_v =
+    std::is_same_v<Body, TickBody> || std::is_same_v<Body, Trade> || std::is_same_v<Body, Quote> ||
+    std::is_same_v<Body, BookDelta> || std::is_same_v<Body, Heartbeat> || std::is_same_v<Body, Status>;
+
+inline const char* message_type_name(MessageType type) {
+    switch (type) {
+        case MessageType::MARKET_DATA: return "market_data";
+        case MessageType::TRADE: return "trade";
+        case MessageType::QUOTE: return "quote";
+        case MessageType::BOOK_DELTA: return "book_delta";
+        case MessageType::HEARTBEAT: return "heartbeat";
+        case MessageType::STATUS: return "status";
+    }
+    return "unknown";
+}
+
+// Names used in JSON, and their parsers; parsers return false on an unknown name
+
+inline const char* side_name(Side side) {
+    switch (side) {
+        case Side::BUY: return "buy";
+        case Side::SELL: return "sell";
+        case Side::UNKNOWN: break;
+    }
+    return "unknown";
+}
+
+inline bool parse_side(const char* name, Side& side) {
+    if (std::strcmp(name, "buy") == 0) { side = Side::BUY; return true; }
+    if (std::strcmp(name, "sell") == 0) { side = Side::SELL; return true; }
+    if (std::strcmp(name, "unknown") == 0) { side = Side::UNKNOWN; return true; }
+    return false;
+}
+
+inline const char* book_action_name(BookAction action) {
+    switch (action) {
+        case BookAction::ADD: return "add";
+        case BookAction::UPDATE: return "update";
+        case BookAction::DELETE: return "delete";
+    }
+    return "unknown";
+}
+
+inline bool parse_book_action(const char* name, BookAction& action) {
+    if (std::strcmp(name, "add") == 0) { action = BookAction::ADD; return true; }
+    if (std::strcmp(name, "update") == 0) { action = BookAction::UPDATE; return true; }
+    if (std::strcmp(name, "delete") == 0) { action = BookAction::DELETE; return true; }
+    return false;
+}
+
+inline const char* market_status_name(MarketStatus status) {
+    switch (status) {
+        case MarketStatus::PRE_OPEN: return "pre_open";
+        case MarketStatus::OPEN: return "open";
+        case MarketStatus::HALTED: return "halted";
+        case MarketStatus::CLOSED: return "closed";
+        case MarketStatus::UNKNOWN: break;
+    }
+    return "unknown";
+}
+
+inline bool parse_market_status(const char* name, MarketStatus& status) {
+    for (auto candidate : {MarketStatus::UNKNOWN, MarketStatus::PRE_OPEN, MarketStatus::OPEN,
+                           MarketStatus::HALTED, MarketStatus::CLOSED}) {
+        if (std::strcmp(name, market_status_name(candidate)) == 0) {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace lockfree
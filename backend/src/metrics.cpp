@@ -0,0 +1,195 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace lockfree {
+
+namespace {
+
+// Prometheus bucket boundaries in nanoseconds (100ns .. 10s)
+constexpr uint64_t PROMETHEUS_BOUNDS_NS[] = {
+    100, 250, 500,
+    1000, 2500, 5000,
+    10000, 25000, 50000,
+    100000, 250000, 500000,
+    1000000, 2500000, 5000000,
+    10000000, 25000000, 50000000,
+    100000000, 250000000, 500000000,
+    1000000000, 2500000000ull, 5000000000ull, 10000000000ull
+};
+
+std::string format_seconds(uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%g", static_cast<double>(ns) / 1e9);
+    return buf;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The TSC only makes a usable clock if it ticks at a constant rate through
+// frequency changes and idle states
+bool has_invariant_tsc() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("flags", 0) == 0) {
+            return line.find(" constant_tsc") != std::string::npos &&
+                   line.find(" nonstop_tsc") != std::string::npos;
+        }
+    }
+    return false;
+}
+#endif
+
+} // namespace
+
+bool TscClock::enabled_ = false;
+uint64_t TscClock::base_ticks_ = 0;
+int64_t TscClock::base_ns_ = 0;
+uint64_t TscClock::mult_ = 0;
+double TscClock::frequency_hz_ = 0;
+
+bool TscClock::calibrate(std::chrono::milliseconds duration) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (!has_invariant_tsc()) {
+        return false;
+    }
+    const int64_t start_ns = steady_ns();
+    const uint64_t start_ticks = __builtin_ia32_rdtsc();
+    std::this_thread::sleep_for(duration);
+    const int64_t end_ns = steady_ns();
+    const uint64_t end_ticks = __builtin_ia32_rdtsc();
+    if (end_ticks <= start_ticks || end_ns <= start_ns) {
+        return false;
+    }
+
+    const double ns_per_tick = static_cast<double>(end_ns - start_ns) / static_cast<double>(end_ticks - start_ticks);
+    frequency_hz_ = 1e9 / ns_per_tick;
+    mult_ = static_cast<uint64_t>(ns_per_tick * static_cast<double>(1ull << SHIFT));
+    // Anchor both clocks at the same instant so TSC stamps line up with steady_clock
+    base_ns_ = steady_ns();
+    base_ticks_ = __builtin_ia32_rdtsc();
+    enabled_ = true;
+    return true;
+#else
+    (void)duration;
+    return false;
+#endif
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    const uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(total) + 0.5));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return bucket_upper_bound(i);
+        }
+    }
+    return bucket_upper_bound(BUCKETS - 1);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::write_prometheus(std::string& out, const std::string& name, const std::string& help) const {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " histogram\n";
+
+    // Fold the fine buckets into the coarse Prometheus boundaries
+    uint64_t cumulative = 0;
+    std::size_t bucket = 0;
+    for (uint64_t bound : PROMETHEUS_BOUNDS_NS) {
+        while (bucket < BUCKETS && bucket_upper_bound(bucket) <= bound) {
+            cumulative += buckets_[bucket].load(std::memory_order_relaxed);
+            ++bucket;
+        }
+        out += name + "_bucket{le=\"" + format_seconds(bound) + "\"} " + std::to_string(cumulative) + "\n";
+    }
+    for (; bucket < BUCKETS; ++bucket) {
+        cumulative += buckets_[bucket].load(std::memory_order_relaxed);
+    }
+    out += name + "_bucket{le=\"+Inf\"} " + std::to_string(cumulative) + "\n";
+    out += name + "_sum " + format_seconds(sum()) + "\n";
+    out += name + "_count " + std::to_string(cumulative) + "\n";
+}
+
+PipelineMetrics& PipelineMetrics::instance() {
+    static PipelineMetrics metrics;
+    return metrics;
+}
+
+std::shared_ptr<SessionCounters> PipelineMetrics::open_session(const std::string& kind) {
+    auto counters = std::make_shared<SessionCounters>(kind, next_session_id_.fetch_add(1, std::memory_order_relaxed));
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    // Drop closed sessions while we hold the lock anyway
+    sessions_.erase(std::remove_if(sessions_.begin(), sessions_.end(),
+        [](const std::weak_ptr<SessionCounters>& s) { return s.expired(); }), sessions_.end());
+    sessions_.push_back(counters);
+    return counters;
+}
+
+void PipelineMetrics::write_prometheus(std::string& out) {
+    publish_latency.write_prometheus(out, "bus_publish_latency_seconds",
+        "Time spent publishing one record, including waits for ring space");
+    ingest_to_ring.write_prometheus(out, "bus_ingest_to_ring_seconds",
+        "Time from the ingest stamp until the message is written to the ring");
+    ring_residence.write_prometheus(out, "bus_ring_residence_seconds",
+        "Time from ring write until the consumer dequeues the message");
+    dispatch.write_prometheus(out, "bus_dispatch_seconds",
+        "Time from ring read until the consumer's handler is entered");
+    subscriber_callback.write_prometheus(out, "bus_subscriber_callback_seconds",
+        "Duration of the consumer's handler for one message");
+    stream_serialization.write_prometheus(out, "stream_serialization_seconds",
+        "Time to serialize one message for WebSocket/SSE clients");
+    write_queue_wait.write_prometheus(out, "stream_write_queue_wait_seconds",
+        "Time a message waits in a session queue before its socket write starts");
+    end_to_end.write_prometheus(out, "pipeline_end_to_end_seconds",
+        "Time from the ingest stamp until the socket write to a client completes");
+
+    std::vector<std::shared_ptr<SessionCounters>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (const auto& weak : sessions_) {
+            if (auto session = weak.lock()) {
+                sessions.push_back(std::move(session));
+            }
+        }
+    }
+
+    const struct {
+        const char* name;
+        const char* type;
+        const char* help;
+        std::atomic<uint64_t> SessionCounters::*field;
+    } session_metrics[] = {
+        {"stream_session_messages_sent_total", "counter", "Messages written to one streaming session", &SessionCounters::messages_sent},
+        {"stream_session_bytes_sent_total", "counter", "Bytes written to one streaming session", &SessionCounters::bytes_sent},
+        {"stream_session_dropped_total", "counter", "Messages dropped because the session queue was full", &SessionCounters::dropped},
+        {"stream_session_queue_depth", "gauge", "Messages waiting in the session queue", &SessionCounters::queue_depth},
+    };
+    for (const auto& metric : session_metrics) {
+        out += std::string("# HELP ") + metric.name + " " + metric.help + "\n";
+        out += std::string("# TYPE ") + metric.name + " " + metric.type + "\n";
+        for (const auto& session : sessions) {
+            out += std::string(metric.name) + "{kind=\"" + session->kind + "\",session=\"" +
+                   std::to_string(session->id) + "\"} " +
+                   std::to_string(((*session).*(metric.field)).load(std::memory_order_relaxed)) + "\n";
+        }
+    }
+    out += "# HELP stream_sessions Open streaming sessions\n";
+    out += "# TYPE stream_sessions gauge\n";
+    out += "stream_sessions " + std::to_string(sessions.size()) + "\n";
+}
+
+} // namespace lockfree
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lockfree {
+
+// Cheap monotonic clock for pipeline stamps. After calibrate() on a CPU with an
+// invariant TSC, now_ns() is one rdtsc plus a fixed-point multiply on the
+// steady_clock timeline; otherwise (or before calibration) it is steady_clock.
+class TscClock {
+public:
+    // Measure the TSC rate against steady_clock; call once at startup before
+    // other threads start stamping. Returns true when the TSC is in use.
+    static bool calibrate(std::chrono::milliseconds duration = std::chrono::milliseconds(20));
+
+    static int64_t now_ns() {
+#if defined(__x86_64__) || defined(__i386__)
+        if (enabled_) {
+            const uint64_t delta = __builtin_ia32_rdtsc() - base_ticks_;
+            return base_ns_ + static_cast<int64_t>((static_cast<uint128>(delta) * mult_) >> SHIFT);
+        }
+#endif
+        return steady_ns();
+    }
+
+    static int64_t steady_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static bool using_tsc() { return enabled_; }
+    // Measured TSC frequency in Hz, 0 when not calibrated
+    static double frequency_hz() { return frequency_hz_; }
+
+private:
+    static constexpr int SHIFT = 32;
+    __extension__ typedef unsigned __int128 uint128;
+
+    static bool enabled_;
+    static uint64_t base_ticks_;
+    static int64_t base_ns_;
+    static uint64_t mult_;  // nanoseconds per tick << SHIFT
+    static double frequency_hz_;
+};
+
+// Monotonic nanoseconds for latency measurements (not wall-clock)
+inline int64_t monotonic_ns() {
+    return TscClock::now_ns();
+}
+
+// monotonic_ns() stamps carried with a message through the pipeline; 0 = not stamped
+struct PipelineStamps {
+    int64_t ingest_ns = 0;      // Received by a gateway/HTTP handler
+    int64_t ring_write_ns = 0;  // Written into the ring buffer
+    int64_t ring_read_ns = 0;   // Dequeued by the bus consumer
+    int64_t callback_ns = 0;    // Subscriber callback entered
+};
+
+// Lock-free log-linear latency histogram in the spirit of HdrHistogram.
+// Values below SUB_BUCKETS are exact; above that each power of two is split
+// into SUB_BUCKETS linear buckets, bounding the relative error to ~6%.
+// record() is a handful of relaxed atomic adds and is safe from any thread.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void record(int64_t value_ns) {
+        const uint64_t value = value_ns > 0 ? static_cast<uint64_t>(value_ns) : 0;
+        buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the q-th quantile (0 < q <= 1)
+    uint64_t percentile(double q) const;
+
+    void reset();
+
+    // Appends a Prometheus histogram (seconds) named `name`
+    void write_prometheus(std::string& out, const std::string& name, const std::string& help) const;
+
+    static std::size_t bucket_index(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<std::size_t>(value);
+        }
+        const int msb = 63 - __builtin_clzll(value);
+        const int shift = msb - SUB_BUCKET_BITS;
+        return static_cast<std::size_t>((shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+    }
+
+    // Largest value that maps to bucket `index`
+    static uint64_t bucket_upper_bound(std::size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+        const uint64_t sub = index % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+};
+
+// Counters for one streaming client; updated on the session's executor,
+// read by the /metrics handler.
+struct SessionCounters {
+    SessionCounters(std::string kind_, uint64_t id_) : kind(std::move(kind_)), id(id_) {}
+
+    const std::string kind;   // "ws" or "sse"
+    const uint64_t id;
+    std::atomic<uint64_t> messages_sent{0};
+    std::atomic<uint64_t> bytes_sent{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> queue_depth{0};
+};
+
+// Process-wide latency histograms for each stage between publish() and the socket.
+class PipelineMetrics {
+public:
+    static PipelineMetrics& instance();
+
+    LatencyHistogram publish_latency;       // Per record inside MessageBus::publish*, ring-full waits included
+    LatencyHistogram ingest_to_ring;        // Ingest stamp to ring write
+    LatencyHistogram ring_residence;        // Ring write to dequeue by the consumer
+    LatencyHistogram dispatch;              // Ring read to consumer handler entry
+    LatencyHistogram subscriber_callback;   // Consumer handler (all subscribers) for one message
+    LatencyHistogram stream_serialization;  // JSON/SSE encoding of one message in StreamHub
+    LatencyHistogram write_queue_wait;      // Session queue entry to socket write start
+    LatencyHistogram end_to_end;            // Ingest stamp to socket write completion
+
+    // Fold the stamps of a message whose socket write just completed
+    void record_delivery(const PipelineStamps& stamps, int64_t written_ns) {
+        if (stamps.ingest_ns != 0) {
+            end_to_end.record(written_ns - stamps.ingest_ns);
+        }
+    }
+
+    // Register a streaming session; counters disappear from /metrics once released
+    std::shared_ptr<SessionCounters> open_session(const std::string& kind);
+
+    // Prometheus text exposition of everything above
+    void write_prometheus(std::string& out);
+
+private:
+    PipelineMetrics() = default;
+
+    std::atomic<uint64_t> next_session_id_{1};
+    std::mutex sessions_mutex_;
+    std::vector<std::weak_ptr<SessionCounters>> sessions_;
+};
+
+} // namespace lockfree
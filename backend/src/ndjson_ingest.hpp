@@ -0,0 +1,152 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "message_bus.hpp"
+
+namespace lockfree {
+
+// Incremental decoder for newline-delimited JSON ticks.
+// Bytes are fed as they arrive from the socket; complete lines are parsed into
+// MarketData and handed to the MessageBus in fixed-size batches.
+class NdjsonIngestor {
+public:
+    static constexpr std::size_t DEFAULT_BATCH_SIZE = 256;
+    // Guard against a client that never sends a newline
+    static constexpr std::size_t MAX_LINE_LENGTH = 64 * 1024;
+
+    struct BatchResult {
+        std::size_t accepted;
+        std::size_t dropped;
+    };
+
+    NdjsonIngestor(std::shared_ptr<MessageBus> message_bus,
+                   std::string topic = "market_data",
+                   std::size_t batch_size = DEFAULT_BATCH_SIZE)
+        : message_bus_(std::move(message_bus))
+        , topic_(std::move(topic))
+        , batch_size_(batch_size == 0 ? 1 : batch_size) {
+        batch_.reserve(batch_size_);
+    }
+
+    // Feed a chunk of body bytes; lines may be split across chunks
+    void feed(const char* data, std::size_t size) {
+        chunk_ns_ = monotonic_ns();
+        const char* end = data + size;
+        while (data < end) {
+            const char* nl = static_cast<const char*>(std::memchr(data, '\n', end - data));
+            if (nl == nullptr) {
+                if (skip_until_newline_) {
+                    return; // Still inside the oversized line, already rejected once
+                }
+                partial_.append(data, end - data);
+                if (partial_.size() > MAX_LINE_LENGTH) {
+                    reject("line exceeds maximum length");
+                    partial_.clear();
+                    skip_until_newline_ = true;
+                }
+                return;
+            }
+            if (skip_until_newline_) {
+                skip_until_newline_ = false;
+            } else if (partial_.empty()) {
+                parse_line(data, nl - data);
+            } else {
+                partial_.append(data, nl - data);
+                parse_line(partial_.data(), partial_.size());
+            }
+            partial_.clear();
+            data = nl + 1;
+        }
+    }
+
+    // Flush the trailing line (if unterminated) and the last partial batch
+    void finish() {
+        if (!partial_.empty() && !skip_until_newline_) {
+            parse_line(partial_.data(), partial_.size());
+        }
+        partial_.clear();
+        skip_until_newline_ = false;
+        flush();
+    }
+
+    std::size_t accepted() const { return accepted_; }
+    std::size_t dropped() const { return dropped_; }
+    std::size_t rejected() const { return rejected_; }
+    const std::string& first_error() const { return first_error_; }
+    const std::vector<BatchResult>& batches() const { return batches_; }
+
+private:
+    void parse_line(const char* line, std::size_t length) {
+        // Tolerate CRLF and blank keep-alive lines
+        while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' ' || line[length - 1] == '\t')) {
+            --length;
+        }
+        if (length == 0) {
+            return;
+        }
+
+        try {
+            auto item = nlohmann::json::parse(line, line + length);
+            MarketData md{};
+            const auto symbol = item.at("symbol").get<std::string>();
+            strncpy(md.symbol, symbol.c_str(), sizeof(md.symbol) - 1);
+            md.price = item.at("price").get<double>();
+            md.volume = item.value("volume", 0.0);
+            md.timestamp = item.contains("timestamp")
+                ? item["timestamp"].get<int64_t>()
+                : std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch()).count();
+            const auto source = item.value("source", std::string("HTTP_INGEST"));
+            strncpy(md.source, source.c_str(), sizeof(md.source) - 1);
+
+            if (batch_.empty()) {
+                // A batch is stamped with the arrival of its first line
+                batch_ingest_ns_ = chunk_ns_;
+            }
+            batch_.push_back(md);
+            if (batch_.size() >= batch_size_) {
+                flush();
+            }
+        } catch (const std::exception& e) {
+            reject(e.what());
+        }
+    }
+
+    void flush() {
+        if (batch_.empty()) {
+            return;
+        }
+        const std::size_t ok = message_bus_->publish_batch(topic_, batch_.data(), batch_.size(), batch_ingest_ns_);
+        batches_.push_back({ok, batch_.size() - ok});
+        accepted_ += ok;
+        dropped_ += batch_.size() - ok;
+        batch_.clear();
+    }
+
+    void reject(const std::string& reason) {
+        if (rejected_++ == 0) {
+            first_error_ = reason;
+        }
+    }
+
+    std::shared_ptr<MessageBus> message_bus_;
+    std::string topic_;
+    std::size_t batch_size_;
+    std::vector<MarketData> batch_;
+    std::vector<BatchResult> batches_;
+    std::string partial_;
+    bool skip_until_newline_ = false;
+    int64_t chunk_ns_ = 0;
+    int64_t batch_ingest_ns_ = 0;
+    std::size_t accepted_ = 0;
+    std::size_t dropped_ = 0;
+    std::size_t rejected_ = 0;
+    std::string first_error_;
+};
+
+} // namespace lockfree
@@ -0,0 +1,64 @@
+#include "price.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace lockfree {
+
+std::string FixedPrice::to_string() const {
+    const int64_t scale = pow10(decimals_);
+    const uint64_t magnitude = ticks_ < 0 ? 0 - static_cast<uint64_t>(ticks_) : static_cast<uint64_t>(ticks_);
+    std::string out = ticks_ < 0 ? "-" : "";
+    out += std::to_string(magnitude / static_cast<uint64_t>(scale));
+    if (decimals_ > 0) {
+        std::string fraction = std::to_string(magnitude % static_cast<uint64_t>(scale));
+        out += '.';
+        out.append(decimals_ - fraction.size(), '0');
+        out += fraction;
+    }
+    return out;
+}
+
+InstrumentTable& InstrumentTable::instance() {
+    static InstrumentTable table;
+    return table;
+}
+
+void InstrumentTable::set_price_decimals(const std::string& symbol, uint8_t decimals) {
+    decimals_[symbol] = std::min(decimals, FixedPrice::MAX_DECIMALS);
+}
+
+void InstrumentTable::set_default_decimals(uint8_t decimals) {
+    default_decimals_ = std::min(decimals, FixedPrice::MAX_DECIMALS);
+}
+
+bool InstrumentTable::configure(const std::string& spec) {
+    std::istringstream entries(spec);
+    std::string entry;
+    while (std::getline(entries, entry, ',')) {
+        if (entry.empty()) {
+            continue;
+        }
+        const auto eq = entry.find('=');
+        if (eq == std::string::npos || eq == 0) {
+            return false;
+        }
+        int decimals = 0;
+        try {
+            decimals = std::stoi(entry.substr(eq + 1));
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (decimals < 0 || decimals > FixedPrice::MAX_DECIMALS) {
+            return false;
+        }
+        const std::string symbol = entry.substr(0, eq);
+        if (symbol == "*") {
+            set_default_decimals(static_cast<uint8_t>(decimals));
+        } else {
+            set_price_decimals(symbol, static_cast<uint8_t>(decimals));
+        }
+    }
+    return true;
+}
+
+} // namespace lockfree
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace lockfree {
+
+// Fixed-point price: an integer number of ticks of 10^-decimals. Arithmetic and
+// comparison are exact integer operations; doubles appear only at the edges
+// (JSON parsing and output).
+class FixedPrice {
+public:
+    static constexpr uint8_t MAX_DECIMALS = 12;
+
+    constexpr FixedPrice() = default;
+    constexpr FixedPrice(int64_t ticks, uint8_t decimals) : ticks_(ticks), decimals_(decimals) {}
+
+    static FixedPrice from_double(double value, uint8_t decimals) {
+        return FixedPrice(std::llround(value * static_cast<double>(pow10(decimals))), decimals);
+    }
+
+    double to_double() const {
+        return static_cast<double>(ticks_) / static_cast<double>(pow10(decimals_));
+    }
+
+    int64_t ticks() const { return ticks_; }
+    uint8_t decimals() const { return decimals_; }
+
+    // Exact when adding decimals; rounds half away from zero when removing them
+    FixedPrice rescale(uint8_t decimals) const {
+        if (decimals >= decimals_) {
+            return FixedPrice(ticks_ * pow10(decimals - decimals_), decimals);
+        }
+        const int64_t divisor = pow10(decimals_ - decimals);
+        const int64_t half = divisor / 2;
+        return FixedPrice((ticks_ >= 0 ? ticks_ + half : ticks_ - half) / divisor, decimals);
+    }
+
+    // Exact decimal text, e.g. "187.2300" for 1872300 ticks at 4 decimals
+    std::string to_string() const;
+
+    friend FixedPrice operator+(FixedPrice a, FixedPrice b) {
+        align(a, b);
+        return FixedPrice(a.ticks_ + b.ticks_, a.decimals_);
+    }
+    friend FixedPrice operator-(FixedPrice a, FixedPrice b) {
+        align(a, b);
+        return FixedPrice(a.ticks_ - b.ticks_, a.decimals_);
+    }
+    friend bool operator==(FixedPrice a, FixedPrice b) { align(a, b); return a.ticks_ == b.ticks_; }
+    friend bool operator!=(FixedPrice a, FixedPrice b) { return !(a == b); }
+    friend bool operator<(FixedPrice a, FixedPrice b) { align(a, b); return a.ticks_ < b.ticks_; }
+    friend bool operator>(FixedPrice a, FixedPrice b) { return b < a; }
+    friend bool operator<=(FixedPrice a, FixedPrice b) { return !(b < a); }
+    friend bool operator>=(FixedPrice a, FixedPrice b) { return !(a < b); }
+
+    static int64_t pow10(unsigned exponent) {
+        static constexpr int64_t table[] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+            1000000000, 10000000000, 100000000000, 1000000000000
+        };
+        return table[exponent > MAX_DECIMALS ? MAX_DECIMALS : exponent];
+    }
+
+private:
+    // Bring both operands to the finer scale (same-instrument prices already match)
+    static void align(FixedPrice& a, FixedPrice& b) {
+        if (a.decimals_ < b.decimals_) {
+            a = a.rescale(b.decimals_);
+        } else if (b.decimals_ < a.decimals_) {
+            b = b.rescale(a.decimals_);
+        }
+    }
+
+    int64_t ticks_ = 0;
+    uint8_t decimals_ = 0;
+};
+
+// Price scale per instrument. Configure at startup (PRICE_DECIMALS) before any
+// publisher runs; afterwards it is read-only and safe to query from any thread.
+class InstrumentTable {
+public:
+    static constexpr uint8_t DEFAULT_DECIMALS = 8;
+
+    static InstrumentTable& instance();
+
+    uint8_t price_decimals(const char* symbol) const {
+        if (!decimals_.empty()) {
+            auto it = decimals_.find(symbol);
+            if (it != decimals_.end()) {
+                return it->second;
+            }
+        }
+        return default_decimals_;
+    }
+
+    FixedPrice to_price(const char* symbol, double value) const {
+        return FixedPrice::from_double(value, price_decimals(symbol));
+    }
+
+    void set_price_decimals(const std::string& symbol, uint8_t decimals);
+    void set_default_decimals(uint8_t decimals);
+    uint8_t default_decimals() const { return default_decimals_; }
+
+    // "AAPL=2,EURUSD=5,*=4" ('*' sets the default). Returns false on a malformed entry.
+    bool configure(const std::string& spec);
+
+private:
+    InstrumentTable() = default;
+
+    std::unordered_map<std::string, uint8_t> decimals_;
+    uint8_t default_decimals_ = DEFAULT_DECIMALS;
+};
+
+} // namespace lockfree
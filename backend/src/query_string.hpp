@@ -0,0 +1,35 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <boost/beast/core/string.hpp>
+
+namespace lockfree {
+
+// Value of name in the target's query string (?a=1&b=2), matching whole keys
+// only; nullopt if the key is absent. Values are not percent-decoded.
+inline std::optional<std::string> query_param(boost::beast::string_view target, boost::beast::string_view name) {
+    const auto question = target.find('?');
+    if (question == boost::beast::string_view::npos) {
+        return std::nullopt;
+    }
+    boost::beast::string_view query = target.substr(question + 1);
+    query = query.substr(0, query.find('#'));
+    while (!query.empty()) {
+        const auto amp = query.find('&');
+        const boost::beast::string_view pair = query.substr(0, amp);
+        const auto eq = pair.find('=');
+        if (pair.substr(0, eq) == name) {
+            const boost::beast::string_view value =
+                eq == boost::beast::string_view::npos ? boost::beast::string_view() : pair.substr(eq + 1);
+            return std::string(value.data(), value.size());
+        }
+        if (amp == boost::beast::string_view::npos) {
+            break;
+        }
+        query = query.substr(amp + 1);
+    }
+    return std::nullopt;
+}
+
+} // namespace lockfree
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -22,50 +23,115 @@ struct alignas(CACHE_LINE_SIZE) CacheAligned {
     T value;
 };
 
-// Lock-free ring buffer implementation
+// Lock-free bounded ring buffer: multiple producers, single consumer
 template<typename T, std::size_t Size>
 class RingBuffer {
 public:
     static_assert(Size > 0 && ((Size & (Size - 1)) == 0), "Size must be a power of 2");
 
     RingBuffer() : read_index_(0), write_index_(0) {
-        static_assert(alignof(T) <= alignof(std::max_align_t), "Type alignment too large");
+        static_assert(alignof(T) <= CACHE_LINE_SIZE, "Type alignment too large");
+        for (auto& slot : published_) {
+            slot.store(0, std::memory_order_relaxed);
+        }
     }
 
     ~RingBuffer() {
         // Call destructors for all elements
-        while (read_index_ != write_index_) {
-            get(read_index_).~T();
-            read_index_ = (read_index_ + 1) & (Size - 1);
+        std::size_t read = read_index_.load(std::memory_order_relaxed);
+        const std::size_t write = write_index_.load(std::memory_order_relaxed);
+        while (read != write) {
+            get(read & (Size - 1)).~T();
+            ++read;
         }
+        read_index_.store(read, std::memory_order_relaxed);
     }
 
+    // Safe to call from multiple producer threads. Producers claim a slot by
+    // advancing write_index_ and then publish it through the slot's sequence,
+    // so the single consumer never observes a half-written element.
     bool write(const T& item) {
-        std::size_t next_write = (write_index_ + 1) & (Size - 1);
-        if (next_write == read_index_) {
-            return false; // Buffer is full
+        std::size_t pos = write_index_.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::size_t read = read_index_.load(std::memory_order_acquire);
+            if (static_cast<std::ptrdiff_t>(pos - read) < 0) {
+                // Stale pos: others wrote, and the consumer read, past it since
+                pos = write_index_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (pos - read >= capacity()) {
+                return false; // Buffer is full
+            }
+            if (write_index_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
         }
 
         // Copy construct the item
-        new (&get(write_index_)) T(item);
-        write_index_ = next_write;
+        new (&get(pos & (Size - 1))) T(item);
+        published_[pos & (Size - 1)].store(pos + 1, std::memory_order_release);
         return true;
     }
 
+    // Batched write(): claims up to count consecutive slots with one CAS and
+    // publishes item(i) into the i-th. Returns how many were written, always
+    // the first ones; short only if the buffer filled up. item must not throw,
+    // since claimed slots the consumer waits on have to be published.
+    template<typename Item>
+    std::size_t write_batch(std::size_t count, Item&& item) {
+        return write_batch(count, [](std::size_t) {}, std::forward<Item>(item));
+    }
+
+    // As above, but on_claim(claimed) runs once the slots are claimed and
+    // before any item(i) call, so the caller can size per-record state (e.g.
+    // sequence numbers) to what was actually claimed. It must not throw either.
+    template<typename OnClaim, typename Item>
+    std::size_t write_batch(std::size_t count, OnClaim&& on_claim, Item&& item) {
+        std::size_t pos = write_index_.load(std::memory_order_relaxed);
+        std::size_t claimed;
+        for (;;) {
+            const std::size_t read = read_index_.load(std::memory_order_acquire);
+            if (static_cast<std::ptrdiff_t>(pos - read) < 0) {
+                // Stale pos, as in write()
+                pos = write_index_.load(std::memory_order_relaxed);
+                continue;
+            }
+            const std::size_t used = pos - read;
+            if (count == 0 || used >= capacity()) {
+                return 0; // Buffer is full
+            }
+            claimed = std::min(count, capacity() - used);
+            if (write_index_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        on_claim(claimed);
+        for (std::size_t i = 0; i < claimed; ++i) {
+            new (&get((pos + i) & (Size - 1))) T(item(i));
+            published_[(pos + i) & (Size - 1)].store(pos + i + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    // Single consumer only
     bool read(T& item) {
-        if (read_index_ == write_index_) {
-            return false; // Buffer is empty
+        const std::size_t pos = read_index_.load(std::memory_order_relaxed);
+        if (published_[pos & (Size - 1)].load(std::memory_order_acquire) != pos + 1) {
+            return false; // Buffer is empty (or the next slot is still being written)
         }
 
         // Move construct the item
-        item = std::move(get(read_index_));
-        get(read_index_).~T();
-        read_index_ = (read_index_ + 1) & (Size - 1);
+        item = std::move(get(pos & (Size - 1)));
+        get(pos & (Size - 1)).~T();
+        read_index_.store(pos + 1, std::memory_order_release);
         return true;
     }
 
     std::size_t size() const {
-        return (write_index_ - read_index_) & (Size - 1);
+        // Read first: write_index_ only grows, so it can never trail the read
+        const std::size_t read = read_index_.load(std::memory_order_acquire);
+        return write_index_.load(std::memory_order_acquire) - read;
     }
 
     std::size_t capacity() const {
@@ -73,19 +139,19 @@ public:
     }
 
     bool is_full() const {
-        return size() == capacity();
+        return size() >= capacity();
     }
 
     bool is_empty() const {
-        return read_index_ == write_index_;
+        return read_index_.load(std::memory_order_acquire) == write_index_.load(std::memory_order_acquire);
     }
 
     std::size_t get_read_index() const {
-        return read_index_;
+        return read_index_.load(std::memory_order_relaxed) & (Size - 1);
     }
 
     std::size_t get_write_index() const {
-        return write_index_;
+        return write_index_.load(std::memory_order_relaxed) & (Size - 1);
     }
 
 private:
@@ -97,7 +163,12 @@ private:
         return *reinterpret_cast<const T*>(&buffer_[index * sizeof(T)]);
     }
 
-    alignas(std::max_align_t) char buffer_[Size * sizeof(T)];
+    // Cache-line-sized element types get one line per slot
+    alignas(alignof(T) > alignof(std::max_align_t) ? alignof(T) : alignof(std::max_align_t))
+    char buffer_[Size * sizeof(T)];
+    // Per-slot publication sequence: slot i holds position p once published_[i] == p + 1
+    std::atomic<std::size_t> published_[Size];
+    // Monotonic positions; masked with (Size - 1) to address a slot
     std::atomic<std::size_t> read_index_;
     std::atomic<std::size_t> write_index_;
 };
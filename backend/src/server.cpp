@@ -1,23 +1,44 @@
-#include <iostream>
 #include <memory>
 #include <string>
 #include <thread>
 #include <vector>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <deque>
+#include <optional>
+#include <sstream>
+#include <limits>
+#include <cstdlib>
+#include <type_traits>
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/websocket.hpp>
 #include <nlohmann/json.hpp>
+#include "logger.hpp"
 #include "message_bus.hpp"
 #include "shared_memory.hpp"
+#include "symbol_registry.hpp"
+#include "ndjson_ingest.hpp"
+#include "query_string.hpp"
+#include "stream_hub.hpp"
+#include "synthetic_feed.hpp"
+#include "ingest_gateway.hpp"
+#include "market_data/capture_recorder.hpp"
 #include "market_data/finnhub_client.hpp"
+#include "market_data/parallel_replay.hpp"
 #include "market_data/replay_engine.hpp"
+#include "market_data/replay_publisher.hpp"
 
 namespace beast = boost::beast;
 namespace http = beast::http;
 namespace websocket = beast::websocket;
 namespace net = boost::asio;
 using tcp = net::ip::tcp;
+using local_stream = net::local::stream_protocol;
 using json = nlohmann::json;
 
 // Helper function to convert time_point to int64_t
@@ -32,11 +53,264 @@ std::chrono::system_clock::time_point int64_to_time_point(int64_t ms) {
         std::chrono::milliseconds(ms));
 }
 
-class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
+// Remove a leftover Unix socket file at path so bind() can reuse it. Anything
+// else found there is left alone: returns false if path exists and is not a socket.
+bool remove_stale_socket(const char* path) {
+    struct stat info;
+    if (::lstat(path, &info) != 0) {
+        return errno == ENOENT;
+    }
+    if (!S_ISSOCK(info.st_mode)) {
+        return false;
+    }
+    return ::unlink(path) == 0 || errno == ENOENT;
+}
+
+// Build a typed bus record from a /api/publish body whose "type" is not
+// market_data. Prices are plain numbers and are converted to the symbol's scale.
+// Throws std::invalid_argument on an unknown type or enum name.
+void typed_record_from_json(const json& data, lockfree::WireRecord& record) {
+    using namespace lockfree;
+    const std::string type = data.at("type").get<std::string>();
+    const std::string symbol = data.value("symbol", std::string());
+    const int64_t now_ns = time_point_to_int64(std::chrono::system_clock::now()) * 1000000;
+    set_header(record, symbol.c_str(), "HTTP_API", now_ns);
+    auto size = [&data](const char* key) { return to_fixed(data.value(key, 0.0), WireRecord::VOLUME_SCALE); };
+    auto price = [&data, &record](const char* key) { return encode_price(record, data.at(key).get<double>()); };
+
+    if (type == "trade") {
+        Trade trade{};
+        trade.price = price("price");
+        trade.size = size("size");
+        trade.trade_id = data.value("trade_id", uint64_t{0});
+        if (!parse_side(data.value("aggressor", std::string("unknown")).c_str(), trade.aggressor)) {
+            throw std::invalid_argument("Unknown aggressor side");
+        }
+        record.set_body(trade);
+    } else if (type == "quote") {
+        record.set_body(Quote{price("bid_price"), size("bid_size"), price("ask_price"), size("ask_size")});
+    } else if (type == "book_delta") {
+        BookDelta delta{};
+        delta.price = price("price");
+        delta.size = size("size");
+        delta.level = data.value("level", uint16_t{0});
+        if (!parse_side(data.at("side").get<std::string>().c_str(), delta.side) ||
+            !parse_book_action(data.value("action", std::string("update")).c_str(), delta.action)) {
+            throw std::invalid_argument("Unknown book side or action");
+        }
+        record.set_body(delta);
+    } else if (type == "heartbeat") {
+        record.set_body(Heartbeat{data.value("feed_seq", uint64_t{0})});
+    } else if (type == "status") {
+        Status status{};
+        if (!parse_market_status(data.at("status").get<std::string>().c_str(), status.status)) {
+            throw std::invalid_argument("Unknown market status");
+        }
+        const std::string reason = data.value("reason", std::string());
+        strncpy(status.reason, reason.c_str(), sizeof(status.reason) - 1);
+        record.set_body(status);
+    } else {
+        throw std::invalid_argument("Unknown message type: " + type);
+    }
+}
+
+// Snapshot of bus counters shared by /api/stats and the pushed stats frames
+json stats_json(const lockfree::MessageBus& message_bus) {
+    return {
+        {"buffer_size", message_bus.get_size()},
+        {"buffer_capacity", message_bus.get_capacity()},
+        {"is_full", message_bus.is_full()},
+        {"is_empty", message_bus.is_empty()},
+        {"published_count", message_bus.get_published_count()},
+        {"processed_count", message_bus.get_processed_count()},
+        {"dropped_count", message_bus.get_dropped_count()},
+        {"backpressure_waits", message_bus.get_backpressure_waits()},
+        {"processing_delay_ms", message_bus.get_processing_delay_ms()}
+    };
+}
+
+// Pushes a stats frame to every streaming client at a fixed rate. The frame is
+// built once per tick and shared, so dashboards no longer need to poll /api/stats.
+class StatsPublisher {
 public:
-    WebSocketSession(tcp::socket socket, std::shared_ptr<lockfree::MessageBus> message_bus)
+    StatsPublisher(net::io_context& ioc, std::shared_ptr<lockfree::MessageBus> message_bus,
+                   std::shared_ptr<lockfree::StreamHub> hub, std::chrono::milliseconds interval)
+        : timer_(ioc)
+        , message_bus_(std::move(message_bus))
+        , hub_(std::move(hub))
+        , interval_(interval) {
+    }
+
+    void start() {
+        schedule();
+    }
+
+private:
+    void schedule() {
+        timer_.expires_after(interval_);
+        timer_.async_wait([this](beast::error_code ec) {
+            if (ec) return;
+            publish();
+            schedule();
+        });
+    }
+
+    void publish() {
+        // Nobody listening: skip the snapshot entirely
+        if (hub_->subscriber_count() == 0) return;
+        json stats = stats_json(*message_bus_);
+        stats["type"] = "stats";
+        hub_->broadcast(lockfree::StreamHub::make_event(0, stats.dump(), "stats"));
+    }
+
+    net::steady_timer timer_;
+    std::shared_ptr<lockfree::MessageBus> message_bus_;
+    std::shared_ptr<lockfree::StreamHub> hub_;
+    std::chrono::milliseconds interval_;
+};
+
+// Historical replay into the bus, started from REPLAY_FILE at startup and
+// driven through /api/replay/*. Rows go out through a ReplayPublisher: one at
+// a time while paced, in batches when unpaced. With more than one worker the
+// replay is sharded by symbol (ParallelReplay), each worker publishing through
+// its own ReplayPublisher; pause, seek and speed changes are single-threaded only.
+class ReplayController {
+public:
+    using TimePoint = market_data::ReplayEngine::TimePoint;
+
+    ReplayController(std::shared_ptr<lockfree::MessageBus> message_bus, const std::atomic<bool>& should_continue)
+        : publisher_(message_bus, should_continue, stopping_)
+        , parallel_([this, message_bus, &should_continue](size_t) {
+            auto publisher = std::make_shared<market_data::ReplayPublisher>(message_bus, should_continue, stopping_);
+            auto counted = [this, publisher](auto&& publish) {
+                const uint64_t before = publisher->published();
+                publish();
+                parallel_published_ += publisher->published() - before;
+            };
+            return market_data::ParallelReplay::Sink{
+                [publisher, counted](const market_data::NormalizedMarketData& row) {
+                    counted([&] { (*publisher)(row); });
+                },
+                [publisher, counted] { counted([&] { publisher->flush(); }); }};
+        })
+        , engine_({}, [this](const market_data::NormalizedMarketData& row) {
+            publisher_(row);
+            if (engine_.get_speed() > 0) {
+                publisher_.flush();
+            }
+        }) {
+        engine_.set_flush_callback([this] { publisher_.flush(); });
+    }
+
+    // A speed multiplier, or "max" for an unpaced replay. Throws std::invalid_argument.
+    static double parse_speed(const std::string& value) {
+        if (value == "max") {
+            return market_data::ReplayEngine::AS_FAST_AS_POSSIBLE;
+        }
+        const double speed = std::stod(value);
+        if (!(speed > 0)) {
+            throw std::invalid_argument("speed must be positive or \"max\"");
+        }
+        return speed;
+    }
+
+    // Replaces any running replay; several files are merged by timestamp.
+    // workers > 1 shards the replay by symbol; a non-zero barrier then keeps
+    // global timestamp order at epochs of that much data time.
+    bool start(const std::vector<std::string>& files, double speed,
+               TimePoint from = TimePoint::min(), TimePoint to = TimePoint::max(), size_t workers = 1,
+               std::chrono::nanoseconds barrier = std::chrono::nanoseconds::zero()) {
+        if (files.empty()) {
+            return false;
+        }
+        stop();
+        parallel_mode_ = workers > 1;
+        if (parallel_mode_) {
+            parallel_published_ = 0;
+            parallel_.set_range(from, to);
+            return parallel_.start(files, workers, speed, barrier);
+        }
+        engine_.set_range(from, to);
+        return files.size() == 1 ? engine_.start_streaming_replay(files[0], speed)
+                                 : engine_.start_merged_replay(files, speed);
+    }
+
+    // Publishers blocked on a full ring give up, so this returns promptly
+    // even while the consumer is held up (e.g. by /api/processing_delay)
+    void stop() {
+        stopping_ = true;
+        parallel_.stop();
+        engine_.stop_replay();
+        stopping_ = false;
+    }
+
+    bool parallel() const { return parallel_mode_; }
+    market_data::ReplayEngine& engine() { return engine_; }
+
+    json status_json() const {
+        if (parallel_mode_) {
+            const auto pacing = parallel_.get_pacing_stats();
+            const double speed = parallel_.get_speed();
+            return {
+                {"replaying", parallel_.is_replaying()},
+                {"paused", false},
+                {"loading", parallel_.is_loading()},
+                {"speed", speed > 0 ? json(speed) : json("max")},
+                {"workers", parallel_.get_workers()},
+                {"barrier_us", parallel_.get_barrier_interval().count() / 1000},
+                {"barriers", parallel_.get_barriers()},
+                {"worker_replayed", parallel_.get_worker_messages()},
+                {"replayed", parallel_.get_current_index()},
+                {"total", parallel_.get_total_messages()},
+                {"published", parallel_published_.load()},
+                {"throughput", parallel_.get_throughput()},
+                {"pacing", pacing_json(pacing)}
+            };
+        }
+        const auto pacing = engine_.get_pacing_stats();
+        const double speed = engine_.get_speed();
+        return {
+            {"replaying", engine_.is_replaying()},
+            {"paused", engine_.is_paused()},
+            {"loading", engine_.is_loading()},
+            {"speed", speed > 0 ? json(speed) : json("max")},
+            {"workers", 1},
+            {"position", time_point_to_int64(engine_.get_position())},
+            {"replayed", engine_.get_current_index()},
+            {"total", engine_.get_total_messages()},
+            {"published", publisher_.published()},
+            {"throughput", engine_.get_throughput()},
+            {"pacing", pacing_json(pacing)}
+        };
+    }
+
+private:
+    static json pacing_json(const market_data::ReplayEngine::PacingStats& pacing) {
+        return {
+            {"mean_drift_us", pacing.mean_drift_ns / 1000},
+            {"p99_drift_us", pacing.p99_drift_ns / 1000},
+            {"max_drift_us", pacing.max_drift_ns / 1000}
+        };
+    }
+
+    std::atomic<bool> stopping_{false};
+    market_data::ReplayPublisher publisher_;
+    std::atomic<uint64_t> parallel_published_{0};
+    std::atomic<bool> parallel_mode_{false};
+    // Declared after the publishers: their destructors stop the replay threads first
+    market_data::ParallelReplay parallel_;
+    market_data::ReplayEngine engine_;
+};
+
+template<class Protocol>
+class WebSocketSession : public std::enable_shared_from_this<WebSocketSession<Protocol>>
+                       , public lockfree::StreamSubscriber {
+public:
+    using socket_type = typename Protocol::socket;
+
+    WebSocketSession(socket_type socket, std::shared_ptr<lockfree::StreamHub> hub)
         : ws_(std::move(socket))
-        , message_bus_(message_bus) {
+        , hub_(hub) {
     }
 
     void start(const http::request<http::string_body>& req) {
@@ -60,49 +334,55 @@ public:
         ws_.async_accept(req,
             beast::bind_front_handler(
                 &WebSocketSession::on_accept,
-                shared_from_this()));
+                this->shared_from_this()));
+    }
+
+    // Called on the bus consumer thread; hop onto our executor before touching the queue
+    void deliver(const lockfree::StreamEventPtr& event) override {
+        net::post(ws_.get_executor(), [self = this->shared_from_this(), event]() {
+            self->enqueue(event);
+        });
     }
 
 private:
     void on_accept(beast::error_code ec) {
         if (ec) {
-            std::cerr << "WebSocket accept error: " << ec.message() << std::endl;
+            LOG_WARN("WebSocket accept error: " << ec.message());
             return;
         }
         
-        std::cout << "WebSocket connection established" << std::endl;
+        LOG_DEBUG("WebSocket connection established");
         
-        // Subscribe to market data
-        message_bus_->subscribe<lockfree::MarketData>("market_data", 
-            [self = shared_from_this()](const lockfree::MarketData& data) {
-                json message = {
-                    {"type", "market_data"},
-                    {"symbol", data.symbol},
-                    {"price", data.price},
-                    {"volume", data.volume},
-                    {"seq", data.seq},
-                    {"timestamp", data.timestamp},
-                    {"source", data.source}
-                };
-                self->send_text(message.dump());
-            });
+        counters_ = lockfree::PipelineMetrics::instance().open_session("ws");
+
+        // Subscribe to the shared market data fan-out
+        hub_->add(this->weak_from_this());
 
         do_read();
     }
 
-    // Queue a message to be written on the WebSocket from the io_context thread
-    void send_text(std::string message) {
-        auto self = shared_from_this();
-        net::post(ws_.get_executor(), [self, msg = std::move(message)]() mutable {
-            if (!self->ws_.is_open()) return;
-            self->outgoing_messages_.push_back(std::move(msg));
-            if (!self->write_in_progress_) {
-                self->write_in_progress_ = true;
-                self->ws_.async_write(
-                    net::buffer(self->outgoing_messages_.front()),
-                    beast::bind_front_handler(&WebSocketSession::on_write, self));
-            }
-        });
+    // Queue an event to be written on the WebSocket; runs on the io_context thread
+    void enqueue(const lockfree::StreamEventPtr& event) {
+        if (!ws_.is_open() || !counters_) return;
+        if (outgoing_messages_.size() >= lockfree::StreamHub::MAX_SESSION_QUEUE) {
+            // Slow client: shed load here rather than grow without bound
+            counters_->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        outgoing_messages_.push_back({event, lockfree::monotonic_ns()});
+        counters_->queue_depth.store(outgoing_messages_.size(), std::memory_order_relaxed);
+        if (!write_in_progress_) {
+            write_in_progress_ = true;
+            write_front();
+        }
+    }
+
+    void write_front() {
+        const auto& front = outgoing_messages_.front();
+        lockfree::PipelineMetrics::instance().write_queue_wait.record(lockfree::monotonic_ns() - front.enqueued_ns);
+        ws_.async_write(
+            net::buffer(front.event->json),
+            beast::bind_front_handler(&WebSocketSession::on_write, this->shared_from_this()));
     }
 
     void do_read() {
@@ -112,90 +392,396 @@ private:
             buffer_,
             beast::bind_front_handler(
                 &WebSocketSession::on_read,
-                shared_from_this()));
+                this->shared_from_this()));
     }
 
     void on_read(beast::error_code ec, std::size_t bytes_transferred) {
         if (ec == websocket::error::closed) {
-            std::cout << "WebSocket connection closed" << std::endl;
+            LOG_DEBUG("WebSocket connection closed");
             return;
         }
         if (ec) {
-            std::cerr << "WebSocket read error: " << ec.message() << std::endl;
+            LOG_DEBUG("WebSocket read error: " << ec.message());
             return;
         }
 
-        // Discard client message and continue reading. Writes are handled by send_text queue.
+        // Discard client message and continue reading. Writes are handled by the enqueue queue.
         buffer_.consume(buffer_.size());
         do_read();
     }
 
     void on_write(beast::error_code ec, std::size_t bytes_transferred) {
         if (ec) {
-            std::cerr << "WebSocket write error: " << ec.message() << std::endl;
+            LOG_DEBUG("WebSocket write error: " << ec.message());
             return;
         }
+        counters_->messages_sent.fetch_add(1, std::memory_order_relaxed);
+        counters_->bytes_sent.fetch_add(bytes_transferred, std::memory_order_relaxed);
         // Remove the message that was just sent and send next if queued
         if (!outgoing_messages_.empty()) {
+            lockfree::PipelineMetrics::instance().record_delivery(
+                outgoing_messages_.front().event->stamps, lockfree::monotonic_ns());
             outgoing_messages_.pop_front();
         }
+        counters_->queue_depth.store(outgoing_messages_.size(), std::memory_order_relaxed);
         if (!outgoing_messages_.empty()) {
-            ws_.async_write(
-                net::buffer(outgoing_messages_.front()),
-                beast::bind_front_handler(&WebSocketSession::on_write, shared_from_this()));
+            write_front();
         } else {
             write_in_progress_ = false;
         }
     }
 
-    websocket::stream<tcp::socket> ws_;
+    websocket::stream<socket_type> ws_;
     beast::flat_buffer buffer_;
-    std::shared_ptr<lockfree::MessageBus> message_bus_;
-    std::deque<std::string> outgoing_messages_;
+    std::shared_ptr<lockfree::StreamHub> hub_;
+    std::deque<lockfree::QueuedEvent> outgoing_messages_;
+    std::shared_ptr<lockfree::SessionCounters> counters_;
     bool write_in_progress_ = false;
 };
 
+// Server-Sent Events variant of the market data stream for clients that cannot
+// upgrade to WebSocket. Shares the StreamHub fan-out; queued events are written
+// in batches with one gathered write, and Last-Event-ID resumes from MarketData::seq.
+template<class Protocol>
+class SseSession : public std::enable_shared_from_this<SseSession<Protocol>>
+                 , public lockfree::StreamSubscriber {
+public:
+    using socket_type = typename Protocol::socket;
+
+    static constexpr std::size_t MAX_EVENTS_PER_WRITE = 256;
+
+    SseSession(socket_type socket, std::shared_ptr<lockfree::StreamHub> hub,
+               const http::request<http::string_body>& req)
+        : socket_(std::move(socket))
+        , hub_(std::move(hub))
+        , heartbeat_timer_(socket_.get_executor())
+        , version_(req.version())
+        , last_event_id_(parse_last_event_id(req))
+        , counters_(lockfree::PipelineMetrics::instance().open_session("sse")) {
+    }
+
+    void start() {
+        http::response<http::empty_body> res{http::status::ok, version_};
+        res.set(http::field::server, "Market Data Server");
+        res.set(http::field::content_type, "text/event-stream");
+        res.set(http::field::cache_control, "no-cache");
+        res.set(http::field::access_control_allow_origin, "*");
+        // Ask reverse proxies not to buffer the stream
+        res.set("X-Accel-Buffering", "no");
+        res.keep_alive(false);
+        std::ostringstream head;
+        head << res.base();
+        header_ = head.str() + "retry: 2000\n\n";
+
+        auto backlog = hub_->add(this->weak_from_this(), last_event_id_);
+        const int64_t now = lockfree::monotonic_ns();
+        for (auto& event : backlog) {
+            pending_.push_back({std::move(event), now, true});
+        }
+
+        do_write();
+        do_read();
+        schedule_heartbeat();
+    }
+
+    void deliver(const lockfree::StreamEventPtr& event) override {
+        net::post(socket_.get_executor(), [self = this->shared_from_this(), event]() {
+            self->enqueue(event);
+        });
+    }
+
+private:
+    static std::optional<uint64_t> parse_last_event_id(const http::request<http::string_body>& req) {
+        // EventSource sends the header on reconnect; the query form covers the first connect
+        std::string value;
+        auto field = req.find("Last-Event-ID");
+        if (field != req.end()) {
+            value = std::string(field->value());
+        } else {
+            value = lockfree::query_param(req.target(), "last_event_id").value_or(std::string());
+        }
+        if (value.empty()) {
+            return std::nullopt;
+        }
+        try {
+            return static_cast<uint64_t>(std::stoull(value));
+        } catch (...) {
+            return std::nullopt;
+        }
+    }
+
+    void enqueue(const lockfree::StreamEventPtr& event) {
+        if (closed_) return;
+        if (pending_.size() >= lockfree::StreamHub::MAX_SESSION_QUEUE) {
+            counters_->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pending_.push_back({event, lockfree::monotonic_ns()});
+        counters_->queue_depth.store(pending_.size(), std::memory_order_relaxed);
+        if (!write_in_progress_) {
+            do_write();
+        }
+    }
+
+    // Gather the response head (first time) and up to MAX_EVENTS_PER_WRITE
+    // pre-serialized events into one write
+    void do_write() {
+        if (closed_ || (header_.empty() && pending_.empty())) {
+            write_in_progress_ = false;
+            return;
+        }
+        write_in_progress_ = true;
+        in_flight_.clear();
+        buffers_.clear();
+        if (!header_.empty()) {
+            in_flight_header_ = std::move(header_);
+            header_.clear();
+            buffers_.push_back(net::buffer(in_flight_header_));
+        }
+        auto& write_queue_wait = lockfree::PipelineMetrics::instance().write_queue_wait;
+        const int64_t now = lockfree::monotonic_ns();
+        while (!pending_.empty() && in_flight_.size() < MAX_EVENTS_PER_WRITE) {
+            write_queue_wait.record(now - pending_.front().enqueued_ns);
+            in_flight_.push_back(std::move(pending_.front()));
+            pending_.pop_front();
+            buffers_.push_back(net::buffer(in_flight_.back().event->sse));
+        }
+        counters_->queue_depth.store(pending_.size(), std::memory_order_relaxed);
+        net::async_write(socket_, buffers_,
+            beast::bind_front_handler(&SseSession::on_write, this->shared_from_this()));
+    }
+
+    void on_write(beast::error_code ec, std::size_t bytes_transferred) {
+        counters_->messages_sent.fetch_add(in_flight_.size(), std::memory_order_relaxed);
+        counters_->bytes_sent.fetch_add(bytes_transferred, std::memory_order_relaxed);
+        if (!ec) {
+            auto& metrics = lockfree::PipelineMetrics::instance();
+            const int64_t written_ns = lockfree::monotonic_ns();
+            for (const auto& queued : in_flight_) {
+                if (!queued.replayed) {
+                    metrics.record_delivery(queued.event->stamps, written_ns);
+                }
+            }
+        }
+        in_flight_.clear();
+        in_flight_header_.clear();
+        if (ec) {
+            close();
+            return;
+        }
+        do_write();
+    }
+
+    // The client never sends anything after the request; a completed read means it went away
+    void do_read() {
+        socket_.async_read_some(net::buffer(read_buf_),
+            [self = this->shared_from_this()](beast::error_code ec, std::size_t) {
+                if (ec) {
+                    self->close();
+                    return;
+                }
+                self->do_read();
+            });
+    }
+
+    void schedule_heartbeat() {
+        heartbeat_timer_.expires_after(std::chrono::seconds(15));
+        heartbeat_timer_.async_wait([self = this->shared_from_this()](beast::error_code ec) {
+            if (ec || self->closed_) return;
+            static const auto keepalive = std::make_shared<const lockfree::StreamEvent>(
+                lockfree::StreamEvent{0, std::string(), ": keepalive\n\n", lockfree::PipelineStamps()});
+            self->enqueue(keepalive);
+            self->schedule_heartbeat();
+        });
+    }
+
+    void close() {
+        if (closed_) return;
+        closed_ = true;
+        beast::error_code ignored;
+        heartbeat_timer_.cancel();
+        socket_.shutdown(net::socket_base::shutdown_both, ignored);
+        socket_.close(ignored);
+        pending_.clear();
+        counters_->queue_depth.store(0, std::memory_order_relaxed);
+    }
+
+    socket_type socket_;
+    std::shared_ptr<lockfree::StreamHub> hub_;
+    net::steady_timer heartbeat_timer_;
+    unsigned version_;
+    std::optional<uint64_t> last_event_id_;
+    std::string header_;
+    std::string in_flight_header_;
+    std::shared_ptr<lockfree::SessionCounters> counters_;
+    std::deque<lockfree::QueuedEvent> pending_;
+    std::vector<lockfree::QueuedEvent> in_flight_;
+    std::vector<net::const_buffer> buffers_;
+    std::array<char, 512> read_buf_;
+    bool write_in_progress_ = false;
+    bool closed_ = false;
+};
+
+// Streams an NDJSON request body into the MessageBus as it arrives, without
+// buffering the whole body. Used by /api/ingest for bulk feed replays.
+template<class Protocol>
+class IngestSession : public std::enable_shared_from_this<IngestSession<Protocol>> {
+public:
+    using socket_type = typename Protocol::socket;
+
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+    IngestSession(socket_type socket, std::shared_ptr<lockfree::MessageBus> message_bus,
+                  http::request_parser<http::string_body>&& header_parser,
+                  std::shared_ptr<beast::flat_buffer> buffer)
+        : socket_(std::move(socket))
+        , buffer_(std::move(buffer))
+        , parser_(std::move(header_parser))
+        , ingestor_(message_bus, "market_data", batch_size_from_target(parser_.get().target()))
+        , chunk_(CHUNK_SIZE) {
+        // Captured feeds can be arbitrarily large; we never hold more than one chunk
+        parser_.body_limit((std::numeric_limits<std::uint64_t>::max)());
+    }
+
+    void start() {
+        do_read();
+    }
+
+private:
+    static std::size_t batch_size_from_target(beast::string_view target) {
+        // /api/ingest?batch=512
+        const auto value = lockfree::query_param(target, "batch");
+        if (!value) {
+            return lockfree::NdjsonIngestor::DEFAULT_BATCH_SIZE;
+        }
+        try {
+            int n = std::stoi(*value);
+            return n > 0 ? static_cast<std::size_t>(n) : lockfree::NdjsonIngestor::DEFAULT_BATCH_SIZE;
+        } catch (...) {
+            return lockfree::NdjsonIngestor::DEFAULT_BATCH_SIZE;
+        }
+    }
+
+    void do_read() {
+        parser_.get().body().data = chunk_.data();
+        parser_.get().body().size = chunk_.size();
+        http::async_read(socket_, *buffer_, parser_,
+            beast::bind_front_handler(&IngestSession::on_read, this->shared_from_this()));
+    }
+
+    void on_read(beast::error_code ec, std::size_t) {
+        // need_buffer just means our chunk filled up
+        if (ec == http::error::need_buffer) {
+            ec = {};
+        }
+        if (ec) {
+            LOG_WARN("[IngestSession] read error: " << ec.message());
+            send_response(http::status::bad_request, json{{"error", ec.message()}});
+            return;
+        }
+
+        const std::size_t received = chunk_.size() - parser_.get().body().size;
+        ingestor_.feed(chunk_.data(), received);
+
+        if (!parser_.is_done()) {
+            do_read();
+            return;
+        }
+
+        ingestor_.finish();
+        json batches = json::array();
+        for (const auto& batch : ingestor_.batches()) {
+            batches.push_back({{"accepted", batch.accepted}, {"dropped", batch.dropped}});
+        }
+        json payload = {
+            {"status", "success"},
+            {"accepted", ingestor_.accepted()},
+            {"dropped", ingestor_.dropped()},
+            {"rejected", ingestor_.rejected()},
+            {"batches", std::move(batches)}
+        };
+        if (ingestor_.rejected() > 0) {
+            payload["first_error"] = ingestor_.first_error();
+        }
+        send_response(http::status::ok, payload);
+    }
+
+    void send_response(http::status status, const json& payload) {
+        res_.version(parser_.get().version());
+        res_.keep_alive(false);
+        res_.result(status);
+        res_.set(http::field::access_control_allow_origin, "*");
+        res_.set(http::field::content_type, "application/json");
+        res_.body() = payload.dump();
+        res_.prepare_payload();
+        auto self = this->shared_from_this();
+        http::async_write(socket_, res_,
+            [self](beast::error_code ec, std::size_t) {
+                self->socket_.shutdown(net::socket_base::shutdown_both, ec);
+            });
+    }
+
+    socket_type socket_;
+    std::shared_ptr<beast::flat_buffer> buffer_;
+    http::request_parser<http::buffer_body> parser_;
+    lockfree::NdjsonIngestor ingestor_;
+    std::vector<char> chunk_;
+    http::response<http::string_body> res_;
+};
+
+// Serves the HTTP API and WebSocket stream on any stream-oriented protocol:
+// TCP for remote clients, Unix domain sockets for co-located ones.
+template<class Protocol>
 class HttpServer {
 public:
-    HttpServer(net::io_context& ioc, const std::string& address, unsigned short port,
-              std::shared_ptr<lockfree::MessageBus> message_bus)
+    using socket_type = typename Protocol::socket;
+    using endpoint_type = typename Protocol::endpoint;
+
+    HttpServer(net::io_context& ioc, const endpoint_type& endpoint,
+              std::shared_ptr<lockfree::MessageBus> message_bus,
+              std::shared_ptr<lockfree::StreamHub> hub,
+              std::shared_ptr<ReplayController> replay)
         : acceptor_(ioc)
-        , message_bus_(message_bus) {
-        std::cout << "[HttpServer] Constructor: starting" << std::endl;
+        , message_bus_(message_bus)
+        , hub_(hub)
+        , replay_(replay) {
+        LOG_DEBUG("[HttpServer] Constructor: starting");
         beast::error_code ec;
 
-        std::cout << "[HttpServer] Opening acceptor..." << std::endl;
+        LOG_DEBUG("[HttpServer] Opening acceptor...");
         // Open the acceptor
-        acceptor_.open(tcp::v4(), ec);
+        acceptor_.open(endpoint.protocol(), ec);
         if (ec) {
-            std::cerr << "[HttpServer] Failed to open acceptor: " << ec.message() << std::endl;
+            LOG_ERROR("[HttpServer] Failed to open acceptor: " << ec.message());
             throw std::runtime_error("Failed to open acceptor: " + ec.message());
         }
 
-        std::cout << "[HttpServer] Setting reuse address..." << std::endl;
-        // Allow address reuse
-        acceptor_.set_option(net::socket_base::reuse_address(true), ec);
-        if (ec) {
-            std::cerr << "[HttpServer] Failed to set reuse address: " << ec.message() << std::endl;
-            throw std::runtime_error("Failed to set reuse address: " + ec.message());
+        if constexpr (std::is_same_v<Protocol, tcp>) {
+            LOG_DEBUG("[HttpServer] Setting reuse address...");
+            // Allow address reuse
+            acceptor_.set_option(net::socket_base::reuse_address(true), ec);
+            if (ec) {
+                LOG_ERROR("[HttpServer] Failed to set reuse address: " << ec.message());
+                throw std::runtime_error("Failed to set reuse address: " + ec.message());
+            }
         }
 
-        std::cout << "[HttpServer] Binding to address..." << std::endl;
+        LOG_DEBUG("[HttpServer] Binding to address...");
         // Bind to the server address
-        acceptor_.bind(tcp::endpoint(net::ip::make_address(address), port), ec);
+        acceptor_.bind(endpoint, ec);
         if (ec) {
-            std::cerr << "[HttpServer] Failed to bind: " << ec.message() << std::endl;
+            LOG_ERROR("[HttpServer] Failed to bind: " << ec.message());
             throw std::runtime_error("Failed to bind: " + ec.message());
         }
 
-        std::cout << "[HttpServer] Listening..." << std::endl;
+        LOG_DEBUG("[HttpServer] Listening...");
         // Start listening for connections
         acceptor_.listen(net::socket_base::max_listen_connections, ec);
         if (ec) {
-            std::cerr << "[HttpServer] Failed to start listening: " << ec.message() << std::endl;
+            LOG_ERROR("[HttpServer] Failed to start listening: " << ec.message());
             throw std::runtime_error("Failed to start listening: " + ec.message());
         }
-        std::cout << "[HttpServer] Constructor: finished" << std::endl;
+        LOG_DEBUG("[HttpServer] Constructor: finished");
     }
 
     void start() {
@@ -205,45 +791,62 @@ public:
 private:
     // Helper struct to hold socket, buffer, and request during async_read
     struct SessionHolder : public std::enable_shared_from_this<SessionHolder> {
-        tcp::socket socket;
+        socket_type socket;
         std::shared_ptr<beast::flat_buffer> buffer;
         std::shared_ptr<http::request_parser<http::string_body>> parser;
         std::shared_ptr<lockfree::MessageBus> message_bus;
         HttpServer* server;
-        SessionHolder(tcp::socket s, std::shared_ptr<lockfree::MessageBus> mb, HttpServer* srv)
+        SessionHolder(socket_type s, std::shared_ptr<lockfree::MessageBus> mb, HttpServer* srv)
             : socket(std::move(s)), buffer(std::make_shared<beast::flat_buffer>()), parser(std::make_shared<http::request_parser<http::string_body>>()), message_bus(mb), server(srv) {}
         void start() {
-            auto self = shared_from_this();
+            auto self = this->shared_from_this();
             http::async_read_header(socket, *buffer, *parser,
                 [self](beast::error_code ec, std::size_t) mutable {
                     if (!ec) {
                         auto& req = self->parser->get();
-                        std::cout << "[SessionHolder] Incoming request: method=" << req.method_string()
-                                  << ", target=" << req.target() << ", version=" << req.version() << std::endl;
-                        std::cout << "[SessionHolder] Headers:" << std::endl;
+                        LOG_DEBUG("[SessionHolder] Incoming request: method=" << req.method_string()
+                                  << ", target=" << req.target() << ", version=" << req.version());
+                        LOG_DEBUG("[SessionHolder] Headers:");
                         for (const auto& field : req) {
-                            std::cout << "  " << field.name_string() << ": " << field.value() << std::endl;
+                            LOG_DEBUG("  " << field.name_string() << ": " << field.value());
                         }
                         if (websocket::is_upgrade(req)) {
-                            std::cout << "WebSocket upgrade request detected" << std::endl;
+                            LOG_DEBUG("WebSocket upgrade request detected");
                             std::string target = std::string(req.target());
                             if (target == "/ws" || target == "/ws/" || target.rfind("/ws?", 0) == 0) {
-                                std::cout << "Creating WebSocket session for " << target << std::endl;
-                                auto ws_session = std::make_shared<WebSocketSession>(std::move(self->socket), self->message_bus);
+                                LOG_DEBUG("Creating WebSocket session for " << target);
+                                auto ws_session = std::make_shared<WebSocketSession<Protocol>>(std::move(self->socket), self->server->hub_);
                                 ws_session->start(req);
                                 // Continue accepting new connections even after upgrading to WebSocket
                                 self->server->do_accept();
                                 return;
                             } else {
-                                std::cout << "Invalid WebSocket target: " << req.target() << std::endl;
+                                LOG_WARN("Invalid WebSocket target: " << req.target());
                             }
                         }
+                        std::string target = std::string(req.target());
+                        if (req.method() == http::verb::get &&
+                            (target == "/api/stream" || target.rfind("/api/stream?", 0) == 0)) {
+                            // Long-lived SSE response; never reaches HttpSession
+                            std::make_shared<SseSession<Protocol>>(std::move(self->socket), self->server->hub_, req)->start();
+                            self->server->do_accept();
+                            return;
+                        }
+                        if (req.method() == http::verb::post &&
+                            (target == "/api/ingest" || target.rfind("/api/ingest?", 0) == 0)) {
+                            // Streamed body: hand off before Beast buffers it into a string
+                            std::make_shared<IngestSession<Protocol>>(std::move(self->socket), self->message_bus,
+                                std::move(*self->parser), self->buffer)->start();
+                            self->server->do_accept();
+                            return;
+                        }
                         // If not a WebSocket upgrade, read the full HTTP body and handle as HTTP
                         http::async_read(self->socket, *self->buffer, *self->parser,
                             [self](beast::error_code ec2, std::size_t) mutable {
                                 if (!ec2) {
                                     auto http_session = std::make_shared<HttpSession>(std::move(self->socket), self->message_bus,
-                                        std::make_shared<http::request<http::string_body>>(self->parser->get()), self->buffer);
+                                        std::make_shared<http::request<http::string_body>>(self->parser->get()), self->buffer,
+                                        self->server->replay_);
                                     http_session->start();
                                 }
                                 self->server->do_accept();
@@ -257,13 +860,13 @@ private:
 
     void do_accept() {
         acceptor_.async_accept(
-            [this](beast::error_code ec, tcp::socket socket) {
-                std::cout << "[HttpServer] do_accept lambda called" << std::endl;
+            [this](beast::error_code ec, socket_type socket) {
+                LOG_DEBUG("[HttpServer] do_accept lambda called");
                 if (!ec) {
                     // Use SessionHolder to keep socket alive during async_read
                     std::make_shared<SessionHolder>(std::move(socket), message_bus_, this)->start();
                 } else {
-                    std::cerr << "[HttpServer] do_accept error: " << ec.message() << std::endl;
+                    LOG_WARN("[HttpServer] do_accept error: " << ec.message());
                     do_accept();
                 }
             });
@@ -271,27 +874,29 @@ private:
 
     class HttpSession : public std::enable_shared_from_this<HttpSession> {
     public:
-        HttpSession(tcp::socket socket, std::shared_ptr<lockfree::MessageBus> message_bus, std::shared_ptr<http::request<http::string_body>> req, std::shared_ptr<beast::flat_buffer> buffer)
+        HttpSession(socket_type socket, std::shared_ptr<lockfree::MessageBus> message_bus, std::shared_ptr<http::request<http::string_body>> req, std::shared_ptr<beast::flat_buffer> buffer,
+                    std::shared_ptr<ReplayController> replay)
             : socket_(std::move(socket))
             , buffer_(std::move(buffer))
             , req_(std::move(req))
             , res_()
-            , message_bus_(message_bus) {
-            std::cout << "[HttpSession] Constructor called" << std::endl;
+            , message_bus_(message_bus)
+            , replay_(std::move(replay)) {
+            LOG_DEBUG("[HttpSession] Constructor called");
         }
 
         void start() {
-            std::cout << "[HttpSession] start() called" << std::endl;
+            LOG_DEBUG("[HttpSession] start() called");
             try {
                 handle_request();
             } catch (const std::exception& e) {
-                std::cerr << "[HttpSession] Exception in start: " << e.what() << std::endl;
+                LOG_ERROR("[HttpSession] Exception in start: " << e.what());
             }
         }
 
     private:
         void handle_request() {
-            std::cout << "[HttpSession] handle_request for target: " << req_->target() << std::endl;
+            LOG_DEBUG("[HttpSession] handle_request for target: " << req_->target());
             try {
                 res_.version(req_->version());
                 res_.keep_alive(false);
@@ -315,15 +920,29 @@ private:
                         handle_publish();
                     } else if (req_->target() == "/api/publish_bulk") {
                         handle_publish_bulk();
+                    } else if (req_->target().starts_with("/api/stream")) {
+                        // GET is served by SseSession before the body is read
+                        res_.result(http::status::method_not_allowed);
+                        res_.set(http::field::content_type, "application/json");
+                        res_.body() = json{{"error", "Method not allowed"}}.dump();
+                    } else if (req_->target().starts_with("/api/ingest")) {
+                        // POST bodies are streamed by IngestSession; anything else lands here
+                        res_.result(http::status::method_not_allowed);
+                        res_.set(http::field::content_type, "application/json");
+                        res_.body() = json{{"error", "Method not allowed"}}.dump();
                     } else if (req_->target().starts_with("/api/processing_delay")) {
                         handle_processing_delay();
                     } else if (req_->target() == "/api/reset_counters") {
                         handle_reset_counters();
+                    } else if (req_->target().starts_with("/api/replay/")) {
+                        handle_replay();
                     } else {
                         res_.result(http::status::not_found);
                         res_.set(http::field::content_type, "application/json");
                         res_.body() = json{{"error", "Not found"}}.dump();
                     }
+                } else if (req_->target() == "/metrics") {
+                    handle_metrics();
                 } else {
                     res_.result(http::status::not_found);
                     res_.set(http::field::content_type, "text/plain");
@@ -331,7 +950,7 @@ private:
                 }
                 write_response();
             } catch (const std::exception& e) {
-                std::cerr << "[HttpSession] Exception in handle_request: " << e.what() << std::endl;
+                LOG_ERROR("[HttpSession] Exception in handle_request: " << e.what());
             }
         }
 
@@ -339,18 +958,38 @@ private:
             res_.result(http::status::ok);
             res_.set(http::field::content_type, "application/json");
             
-            json stats = {
-                {"buffer_size", message_bus_->get_size()},
-                {"buffer_capacity", message_bus_->get_capacity()},
-                {"is_full", message_bus_->is_full()},
-                {"is_empty", message_bus_->is_empty()},
-                {"published_count", message_bus_->get_published_count()},
-                {"processed_count", message_bus_->get_processed_count()},
-                {"dropped_count", message_bus_->get_dropped_count()},
-                {"processing_delay_ms", message_bus_->get_processing_delay_ms()}
+            res_.body() = stats_json(*message_bus_).dump();
+            res_.prepare_payload();
+        }
+
+        // Prometheus text exposition: bus counters plus the per-stage latency histograms
+        void handle_metrics() {
+            std::string out;
+            out.reserve(16 * 1024);
+            const struct {
+                const char* name;
+                const char* type;
+                const char* help;
+                uint64_t value;
+            } bus_metrics[] = {
+                {"bus_published_total", "counter", "Messages accepted by MessageBus::publish", message_bus_->get_published_count()},
+                {"bus_processed_total", "counter", "Messages delivered to subscribers", message_bus_->get_processed_count()},
+                {"bus_dropped_total", "counter", "Messages rejected because the ring buffer was full", message_bus_->get_dropped_count()},
+                {"bus_backpressure_waits_total", "counter", "Blocking publishes that found the ring buffer full and waited", message_bus_->get_backpressure_waits()},
+                {"bus_ring_buffer_size", "gauge", "Messages waiting in the ring buffer", message_bus_->get_size()},
+                {"bus_ring_buffer_capacity", "gauge", "Ring buffer capacity", message_bus_->get_capacity()},
+                {"bus_source_overflow_total", "counter", "Messages from sources beyond the 255-entry source table, sent as the empty source", lockfree::SourceRegistry::instance().overflow_count()},
             };
-            
-            res_.body() = stats.dump();
+            for (const auto& metric : bus_metrics) {
+                out += std::string("# HELP ") + metric.name + " " + metric.help + "\n";
+                out += std::string("# TYPE ") + metric.name + " " + metric.type + "\n";
+                out += std::string(metric.name) + " " + std::to_string(metric.value) + "\n";
+            }
+            lockfree::PipelineMetrics::instance().write_prometheus(out);
+
+            res_.result(http::status::ok);
+            res_.set(http::field::content_type, "text/plain; version=0.0.4");
+            res_.body() = std::move(out);
             res_.prepare_payload();
         }
 
@@ -363,27 +1002,37 @@ private:
                 return;
             }
 
+            // The body has been read in full; that is the ingest point for this tick
+            const int64_t ingest_ns = lockfree::monotonic_ns();
             try {
-                std::cout << "[HttpSession] handle_publish: raw body length=" << req_->body().size() << std::endl;
+                LOG_DEBUG("[HttpSession] handle_publish: raw body length=" << req_->body().size());
                 json data = json::parse(req_->body());
-                std::cout << "[HttpSession] handle_publish: parsed JSON ok" << std::endl;
-                
-                lockfree::MarketData market_data;
-                strncpy(market_data.symbol, data["symbol"].get<std::string>().c_str(), sizeof(market_data.symbol) - 1);
-                market_data.symbol[sizeof(market_data.symbol) - 1] = '\0';
-                market_data.price = data["price"].get<double>();
-                market_data.volume = data["volume"].get<double>();
-                market_data.timestamp = time_point_to_int64(std::chrono::system_clock::now());
-                strncpy(market_data.source, "HTTP_API", sizeof(market_data.source) - 1);
-                market_data.source[sizeof(market_data.source) - 1] = '\0';
-
-                if (message_bus_->publish("market_data", market_data)) {
-                    std::cout << "[HttpSession] handle_publish: publish success" << std::endl;
+                LOG_DEBUG("[HttpSession] handle_publish: parsed JSON ok");
+
+                bool published = false;
+                if (data.value("type", std::string("market_data")) != "market_data") {
+                    lockfree::WireRecord record{};
+                    typed_record_from_json(data, record);
+                    published = message_bus_->publish_record("market_data", record, ingest_ns);
+                } else {
+                    lockfree::MarketData market_data;
+                    strncpy(market_data.symbol, data["symbol"].get<std::string>().c_str(), sizeof(market_data.symbol) - 1);
+                    market_data.symbol[sizeof(market_data.symbol) - 1] = '\0';
+                    market_data.price = data["price"].get<double>();
+                    market_data.volume = data["volume"].get<double>();
+                    market_data.timestamp = time_point_to_int64(std::chrono::system_clock::now());
+                    strncpy(market_data.source, "HTTP_API", sizeof(market_data.source) - 1);
+                    market_data.source[sizeof(market_data.source) - 1] = '\0';
+                    published = message_bus_->publish("market_data", market_data, ingest_ns);
+                }
+
+                if (published) {
+                    LOG_DEBUG("[HttpSession] handle_publish: publish success");
                     res_.result(http::status::ok);
                     res_.set(http::field::content_type, "application/json");
                     res_.body() = json{{"status", "success"}}.dump();
                 } else {
-                    std::cout << "[HttpSession] handle_publish: buffer full" << std::endl;
+                    LOG_DEBUG("[HttpSession] handle_publish: buffer full");
                     res_.result(http::status::service_unavailable);
                     res_.set(http::field::content_type, "application/json");
                     res_.body() = json{{"error", "Buffer full"}}.dump();
@@ -394,7 +1043,7 @@ private:
                 res_.set(http::field::content_type, "application/json");
                 res_.body() = json{{"error", e.what()}}.dump();
                 res_.prepare_payload();
-                std::cerr << "[HttpSession] handle_publish exception: " << e.what() << std::endl;
+                LOG_WARN("[HttpSession] handle_publish exception: " << e.what());
             }
         }
 
@@ -410,17 +1059,21 @@ private:
                 json data = json::parse(req_->body());
                 const int count = data.value("count", 100);
                 const std::string symbol = data.value("symbol", std::string("BULK"));
-                const double base_price = data.value("price", 100.0);
+                const lockfree::FixedPrice base_price =
+                    lockfree::InstrumentTable::instance().to_price(symbol.c_str(), data.value("price", 100.0));
                 const double base_volume = data.value("volume", 1.0);
+                // Seeded so a bulk load is the same on every run
+                lockfree::Xoshiro256 rng(data.value("seed", uint64_t{1}));
                 int success = 0;
                 int dropped = 0;
                 for (int i = 0; i < count; ++i) {
                     lockfree::MarketData md{};
                     strncpy(md.symbol, symbol.c_str(), sizeof(md.symbol) - 1);
-                    // Add small jitter to price and volume for realism
-                    double jitter = ((std::rand() % 201) - 100) / 10000.0; // +/-1.00%
-                    md.price = base_price * (1.0 + jitter);
-                    md.volume = std::max(1.0, base_volume + (std::rand() % 5));
+                    // Add small jitter to price and volume for realism; price moves in whole ticks
+                    const int64_t jitter_bp = static_cast<int64_t>(rng.next() % 201) - 100; // +/-1.00%
+                    md.price = lockfree::FixedPrice(base_price.ticks() + base_price.ticks() * jitter_bp / 10000,
+                                                    base_price.decimals()).to_double();
+                    md.volume = std::max(1.0, base_volume + static_cast<double>(rng.next() % 5));
                     md.timestamp = time_point_to_int64(std::chrono::system_clock::now());
                     strncpy(md.source, "HTTP_API", sizeof(md.source) - 1);
                     if (message_bus_->publish("market_data", md)) success++; else dropped++;
@@ -440,11 +1093,10 @@ private:
         void handle_processing_delay() {
             try {
                 // /api/processing_delay?ms=100
-                auto target = std::string(req_->target());
-                auto pos = target.find("ms=");
+                const auto value = lockfree::query_param(req_->target(), "ms");
                 int ms = 0;
-                if (pos != std::string::npos) {
-                    ms = std::stoi(target.substr(pos + 3));
+                if (value) {
+                    ms = std::stoi(*value);
                 }
                 message_bus_->set_processing_delay_ms(ms);
                 res_.result(http::status::ok);
@@ -473,9 +1125,80 @@ private:
             res_.prepare_payload();
         }
 
+        // /api/replay/{status,start,stop,pause,resume,seek,speed}; timestamps are
+        // milliseconds since the epoch, speeds a multiplier or "max". start also
+        // takes "workers" and "barrier_ms" for a replay sharded by symbol.
+        void handle_replay() {
+            const std::string action = std::string(req_->target().substr(std::string_view("/api/replay/").size()));
+            auto respond = [this](http::status status, const json& body) {
+                res_.result(status);
+                res_.set(http::field::content_type, "application/json");
+                res_.body() = body.dump();
+                res_.prepare_payload();
+            };
+            if (action == "status") {
+                respond(http::status::ok, replay_->status_json());
+                return;
+            }
+            if (req_->method() != http::verb::post) {
+                respond(http::status::method_not_allowed, json{{"error", "Method not allowed"}});
+                return;
+            }
+            try {
+                const json body = req_->body().empty() ? json::object() : json::parse(req_->body());
+                auto speed_of = [&body](double fallback) {
+                    if (!body.contains("speed")) {
+                        return fallback;
+                    }
+                    const auto& speed = body["speed"];
+                    return ReplayController::parse_speed(speed.is_string() ? speed.get<std::string>() : speed.dump());
+                };
+                auto& engine = replay_->engine();
+                if (action == "start") {
+                    std::vector<std::string> files;
+                    if (body.contains("files")) {
+                        files = body["files"].get<std::vector<std::string>>();
+                    } else if (body.contains("file")) {
+                        files.push_back(body["file"].get<std::string>());
+                    }
+                    const auto from = body.contains("from") ? int64_to_time_point(body["from"].get<int64_t>())
+                                                            : ReplayController::TimePoint::min();
+                    const auto to = body.contains("to") ? int64_to_time_point(body["to"].get<int64_t>())
+                                                        : ReplayController::TimePoint::max();
+                    const size_t workers = body.value("workers", size_t{1});
+                    const auto barrier = std::chrono::microseconds(
+                        static_cast<int64_t>(body.value("barrier_ms", 0.0) * 1000));
+                    if (!replay_->start(files, speed_of(1.0), from, to, workers, barrier)) {
+                        respond(http::status::bad_request, json{{"error", "Replay failed to start"}});
+                        return;
+                    }
+                } else if (action == "stop") {
+                    replay_->stop();
+                } else if (replay_->parallel() &&
+                           (action == "pause" || action == "resume" || action == "seek" || action == "speed")) {
+                    respond(http::status::conflict, json{{"error", "Not supported by a parallel replay"}});
+                    return;
+                } else if (action == "pause") {
+                    engine.pause();
+                } else if (action == "resume") {
+                    engine.resume();
+                } else if (action == "seek") {
+                    engine.seek(int64_to_time_point(body.at("timestamp").get<int64_t>()));
+                } else if (action == "speed") {
+                    engine.set_speed(speed_of(engine.get_speed()));
+                } else {
+                    respond(http::status::not_found, json{{"error", "Not found"}});
+                    return;
+                }
+                respond(http::status::ok, replay_->status_json());
+            } catch (const std::exception& e) {
+                respond(http::status::bad_request, json{{"error", e.what()}});
+            }
+        }
+
         void write_response() {
-            auto self = shared_from_this();
-            std::cout << "[HttpSession] write_response called" << std::endl;
+            auto self = this->shared_from_this();
+            LOG_DEBUG("[HttpSession] write_response called");
             try {
                 // Ensure content-length is set for string bodies
                 if (res_.need_eof()) {
@@ -483,62 +1206,217 @@ private:
                 }
                 http::async_write(socket_, res_,
                     [self](beast::error_code ec, std::size_t) {
-                        std::cout << "[HttpSession] async_write completed, shutting down socket" << std::endl;
-                        self->socket_.shutdown(tcp::socket::shutdown_both, ec);
+                        LOG_DEBUG("[HttpSession] async_write completed, shutting down socket");
+                        self->socket_.shutdown(net::socket_base::shutdown_both, ec);
                     });
             } catch (const std::exception& e) {
-                std::cerr << "[HttpSession] Exception in write_response: " << e.what() << std::endl;
+                LOG_ERROR("[HttpSession] Exception in write_response: " << e.what());
             }
         }
 
-        tcp::socket socket_;
+        socket_type socket_;
         std::shared_ptr<beast::flat_buffer> buffer_;
         std::shared_ptr<http::request<http::string_body>> req_;
         http::response<http::string_body> res_;
         std::shared_ptr<lockfree::MessageBus> message_bus_;
+        std::shared_ptr<ReplayController> replay_;
     };
 
-    tcp::acceptor acceptor_;
+    typename Protocol::acceptor acceptor_;
     std::shared_ptr<lockfree::MessageBus> message_bus_;
+    std::shared_ptr<lockfree::StreamHub> hub_;
+    std::shared_ptr<ReplayController> replay_;
+};
+
+// The bus consumer's visitor: everything goes to the StreamHub, and ticks and
+// trades are also handed to the capture recorder when CAPTURE_DIR is set
+struct BusConsumer {
+    lockfree::StreamHub& hub;
+    market_data::CaptureRecorder* recorder = nullptr;
+
+    template<typename Body>
+    auto operator()(const lockfree::WireRecord& record, const Body& body, const lockfree::PipelineStamps& stamps)
+        -> decltype(hub(record, body, stamps)) {
+        if constexpr (std::is_invocable_v<market_data::CaptureRecorder&, const lockfree::WireRecord&, const Body&,
+                                          const lockfree::PipelineStamps&>) {
+            if (recorder) {
+                (*recorder)(record, body, stamps);
+            }
+        }
+        return hub(record, body, stamps);
+    }
 };
 
 int main() {
-    std::cout << "[main] Starting main()" << std::endl;
+    LOG_INFO("[main] Starting main()");
     try {
-        std::cout << "[main] Creating MessageBus..." << std::endl;
+        // Per-instrument price scales must be in place before anything publishes
+        if (const char* price_decimals = std::getenv("PRICE_DECIMALS")) {
+            if (!lockfree::InstrumentTable::instance().configure(price_decimals)) {
+                LOG_WARN("[main] Ignoring malformed PRICE_DECIMALS entries: " << price_decimals);
+            }
+        }
+
+        // Symbol ids are shared with other processes (recorders, replayers) via /market_data_symbols
+        lockfree::SymbolRegistry::use_shared_memory("market_data_symbols");
+
+        // Pipeline latency stamps use the TSC when it is invariant
+        if (lockfree::TscClock::calibrate()) {
+            LOG_INFO("[main] Latency clock: TSC at " << lockfree::TscClock::frequency_hz() / 1e6 << " MHz");
+        } else {
+            LOG_INFO("[main] Latency clock: steady_clock (no invariant TSC)");
+        }
+
+        LOG_INFO("[main] Creating MessageBus...");
         auto message_bus = std::make_shared<lockfree::MessageBus>("market_data_bus", 256 * 1024);
-        std::cout << "[main] MessageBus created" << std::endl;
+        LOG_INFO("[main] MessageBus created");
+
+        // Single fan-out for WebSocket and SSE clients; it is the consumer's visitor,
+        // so every message type reaches it
+        auto hub = std::make_shared<lockfree::StreamHub>();
 
-        std::cout << "[main] Starting message processing thread..." << std::endl;
+        // Live capture of ticks and trades to rolling tick files: CAPTURE_DIR=dir, with
+        // CAPTURE_ROLL_MB, CAPTURE_ROLL_SECONDS and CAPTURE_SYNC_MS to tune it
+        std::unique_ptr<market_data::CaptureRecorder> recorder;
+        const char* capture_dir = std::getenv("CAPTURE_DIR");
+        if (capture_dir && *capture_dir) {
+            market_data::CaptureRecorder::Options options;
+            options.directory = capture_dir;
+            if (const char* roll_mb = std::getenv("CAPTURE_ROLL_MB")) {
+                options.roll_bytes = std::max<uint64_t>(std::strtoull(roll_mb, nullptr, 10), 1) << 20;
+            }
+            if (const char* roll_seconds = std::getenv("CAPTURE_ROLL_SECONDS")) {
+                options.roll_interval = std::chrono::seconds(std::max(std::atol(roll_seconds), 1L));
+            }
+            if (const char* sync_ms = std::getenv("CAPTURE_SYNC_MS")) {
+                options.sync_interval = std::chrono::milliseconds(std::max(std::atol(sync_ms), 1L));
+            }
+            recorder = std::make_unique<market_data::CaptureRecorder>(std::move(options));
+        }
+
+        LOG_INFO("[main] Starting message processing thread...");
         std::atomic<bool> should_continue{true};
-        std::thread message_thread([&message_bus, &should_continue]() {
-            message_bus->process_messages(should_continue);
+        std::thread message_thread([&message_bus, &hub, &recorder, &should_continue]() {
+            BusConsumer consumer{*hub, recorder.get()};
+            message_bus->process_messages(should_continue, consumer);
         });
-        std::cout << "[main] Message processing thread started" << std::endl;
+        LOG_INFO("[main] Message processing thread started");
+
+        // Historical replay into the bus: REPLAY_FILE=ticks.bin (comma-separated files are
+        // merged by timestamp, "synthetic:seed=42,..." generates ticks), REPLAY_SPEED=N
+        // (default 1) or "max" to publish as fast as the consumer drains the ring,
+        // REPLAY_WORKERS=N to shard by symbol over N threads and REPLAY_BARRIER_MS=M to
+        // keep them in timestamp order every M ms of data.
+        // Also controlled through /api/replay/*.
+        auto replay = std::make_shared<ReplayController>(message_bus, should_continue);
+        const char* replay_file = std::getenv("REPLAY_FILE");
+        if (replay_file && *replay_file) {
+            const char* speed_env = std::getenv("REPLAY_SPEED");
+            std::vector<std::string> files;
+            if (std::string_view(replay_file).substr(0, market_data::SyntheticSource::PREFIX.size()) ==
+                market_data::SyntheticSource::PREFIX) {
+                files.push_back(replay_file);  // The spec has commas of its own
+            } else {
+                std::stringstream list(replay_file);
+                for (std::string file; std::getline(list, file, ',');) {
+                    if (!file.empty()) {
+                        files.push_back(file);
+                    }
+                }
+            }
+            const char* workers_env = std::getenv("REPLAY_WORKERS");
+            const char* barrier_env = std::getenv("REPLAY_BARRIER_MS");
+            const size_t workers = workers_env ? std::strtoul(workers_env, nullptr, 10) : 1;
+            const auto barrier = std::chrono::microseconds(
+                barrier_env ? static_cast<int64_t>(std::strtod(barrier_env, nullptr) * 1000) : 0);
+            try {
+                if (!replay->start(files, speed_env && *speed_env ? ReplayController::parse_speed(speed_env) : 1.0,
+                                   ReplayController::TimePoint::min(), ReplayController::TimePoint::max(),
+                                   workers, barrier)) {
+                    LOG_ERROR("[main] Replay of " << replay_file << " failed to start");
+                }
+            } catch (const std::exception& e) {
+                LOG_ERROR("[main] Invalid REPLAY_SPEED " << speed_env << ": " << e.what());
+            }
+        }
 
-        std::cout << "[main] Creating io_context and HttpServer..." << std::endl;
+        LOG_INFO("[main] Creating io_context and HttpServer...");
         net::io_context ioc;
         // Keep io_context alive even when there are brief gaps with no pending async operations
         auto work_guard = net::make_work_guard(ioc);
-        HttpServer server(ioc, "0.0.0.0", 8080, message_bus);
-        std::cout << "[main] HttpServer created" << std::endl;
+        // Shut down cleanly on SIGINT/SIGTERM so capture files are finished
+        net::signal_set signals(ioc, SIGINT, SIGTERM);
+        signals.async_wait([&ioc](const beast::error_code& ec, int signal) {
+            if (!ec) {
+                LOG_INFO("[main] Signal " << signal << ", shutting down");
+                ioc.stop();
+            }
+        });
+        HttpServer<tcp> server(ioc, tcp::endpoint(net::ip::make_address("0.0.0.0"), 8080), message_bus, hub, replay);
+        LOG_INFO("[main] HttpServer created");
         server.start();
 
-        std::cout << "Server started on port 8080" << std::endl;
+        LOG_INFO("Server started on port 8080");
+
+        // Same HTTP/WebSocket API on a Unix domain socket for same-host clients
+        std::unique_ptr<HttpServer<local_stream>> local_server;
+        const char* unix_socket_path = std::getenv("UNIX_SOCKET_PATH");
+        if (unix_socket_path && *unix_socket_path) {
+            // A stale socket file from a previous run would make bind() fail
+            if (!remove_stale_socket(unix_socket_path)) {
+                LOG_ERROR("Not listening on unix socket " << unix_socket_path
+                          << ": the path exists and is not a socket");
+            } else {
+                local_server = std::make_unique<HttpServer<local_stream>>(
+                    ioc, local_stream::endpoint(unix_socket_path), message_bus, hub, replay);
+                local_server->start();
+                LOG_INFO("Server listening on unix socket " << unix_socket_path);
+            }
+        }
+
+        // Stats frames on /ws and /api/stream (STATS_INTERVAL_MS=0 disables)
+        const char* stats_interval_env = std::getenv("STATS_INTERVAL_MS");
+        const int stats_interval_ms = stats_interval_env ? std::atoi(stats_interval_env) : 250;
+        StatsPublisher stats_publisher(ioc, message_bus, hub, std::chrono::milliseconds(std::max(1, stats_interval_ms)));
+        if (stats_interval_ms > 0) {
+            stats_publisher.start();
+        }
+
+        // Binary producer gateway (INGEST_PORT=0 disables it)
+        std::unique_ptr<lockfree::IngestGateway> ingest_gateway;
+        const char* ingest_port_env = std::getenv("INGEST_PORT");
+        const int ingest_port = ingest_port_env ? std::atoi(ingest_port_env) : 9000;
+        if (ingest_port > 0) {
+            ingest_gateway = std::make_unique<lockfree::IngestGateway>(
+                message_bus, "0.0.0.0", static_cast<unsigned short>(ingest_port));
+            ingest_gateway->start();
+            LOG_INFO("Binary ingest gateway started on port " << ingest_port);
+        }
 
         // Run the I/O service
         ioc.run();
-        std::cout << "[main] io_context finished running" << std::endl;
+        LOG_INFO("[main] io_context finished running");
 
         // Cleanup
+        if (local_server) {
+            remove_stale_socket(unix_socket_path);
+        }
+        if (ingest_gateway) {
+            ingest_gateway->stop();
+        }
+        // Before the consumer stops, so the replay is not left waiting on a full ring
+        replay->stop();
         should_continue = false;
         if (message_thread.joinable()) {
             message_thread.join();
         }
-        std::cout << "[main] Exiting main() normally" << std::endl;
+        if (recorder) {
+            recorder->stop();
+        }
+        LOG_INFO("[main] Exiting main() normally");
 
     } catch (const std::exception& e) {
-        std::cerr << "[main] Exception: " << e.what() << std::endl;
+        LOG_ERROR("[main] Exception: " << e.what());
         return 1;
     }
 
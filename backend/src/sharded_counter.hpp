@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "ring_buffer.hpp"
+
+namespace lockfree {
+
+namespace detail {
+// Round-robin source for per-thread shard slots, shared by every ShardedCounter
+inline std::atomic<std::size_t> next_counter_slot{0};
+
+inline std::size_t counter_slot() {
+    thread_local const std::size_t slot = next_counter_slot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+} // namespace detail
+
+// Statistics counter split into cache-line-sized shards. Each thread increments
+// its own shard, so producers never bounce a shared line; reads sum the shards.
+// Totals are exact once writers are quiescent and monotonic while they run.
+template<std::size_t Shards = 16>
+class ShardedCounter {
+public:
+    static_assert(Shards > 0 && ((Shards & (Shards - 1)) == 0), "Shards must be a power of 2");
+
+    void add(uint64_t n = 1) {
+        shards_[detail::counter_slot() & (Shards - 1)].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t load() const {
+        uint64_t total = 0;
+        for (const auto& shard : shards_) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void reset() {
+        for (auto& shard : shards_) {
+            shard.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    CacheAligned<std::atomic<uint64_t>> shards_[Shards] = {};
+};
+
+} // namespace lockfree
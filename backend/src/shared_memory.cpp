@@ -4,20 +4,38 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdexcept>
-#include <iostream>
+#include "logger.hpp"
 #include <cerrno>
 #include <cstring>
 #include <atomic>
 
 namespace lockfree {
 
-SharedMemory::SharedMemory(const std::string& name, std::size_t size)
-    : name_("/" + name), size_(size), data_(nullptr), fd_(-1) {
+SharedMemory::SharedMemory(const std::string& name, std::size_t size, Mode mode)
+    : name_("/" + name), size_(size), data_(nullptr), fd_(-1), mode_(mode) {
     
-    std::cout << "\n=== Creating SharedMemory ===" << std::endl;
-    std::cout << "Name: " << name_ << std::endl;
-    std::cout << "Size: " << size_ << " bytes" << std::endl;
+    LOG_DEBUG("=== Creating SharedMemory ===");
+    LOG_DEBUG("Name: " << name_);
+    LOG_DEBUG("Size: " << size_ << " bytes");
     
+    if (mode_ == Mode::ATTACH) {
+        fd_ = shm_open(name_.c_str(), O_RDWR, 0);
+        if (fd_ == -1) {
+            throw std::runtime_error("Failed to open shared memory " + name_ + ": " + std::string(strerror(errno)));
+        }
+        struct stat st;
+        if (fstat(fd_, &st) == -1 || static_cast<std::size_t>(st.st_size) < size_) {
+            close(fd_);
+            throw std::runtime_error("Shared memory " + name_ + " is smaller than expected");
+        }
+        data_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (data_ == MAP_FAILED) {
+            close(fd_);
+            throw std::runtime_error("Failed to map shared memory: " + std::string(strerror(errno)));
+        }
+        return;
+    }
+
     try {
         // Try to remove existing shared memory first
         shm_unlink(name_.c_str());
@@ -44,26 +62,26 @@ SharedMemory::SharedMemory(const std::string& name, std::size_t size)
         // Zero out the memory
         std::memset(data_, 0, size_);
         
-        std::cout << "Shared memory created successfully:" << std::endl;
-        std::cout << "  fd: " << fd_ << std::endl;
-        std::cout << "  address: " << data_ << std::endl;
-        std::cout << "=== SharedMemory creation complete ===\n" << std::endl;
+        LOG_DEBUG("Shared memory created successfully:");
+        LOG_DEBUG("  fd: " << fd_);
+        LOG_DEBUG("  address: " << data_);
+        LOG_DEBUG("=== SharedMemory creation complete ===");
         
     } catch (const std::exception& e) {
-        std::cerr << "Error creating shared memory: " << e.what() << std::endl;
+        LOG_ERROR("Error creating shared memory: " << e.what());
         throw;
     }
 }
 
 SharedMemory::~SharedMemory() {
-    std::cout << "\n=== Destroying SharedMemory ===" << std::endl;
-    std::cout << "Name: " << name_ << std::endl;
+    LOG_DEBUG("=== Destroying SharedMemory ===");
+    LOG_DEBUG("Name: " << name_);
     
     try {
         // Unmap memory
         if (data_ != nullptr && data_ != MAP_FAILED) {
             if (munmap(data_, size_) == -1) {
-                std::cerr << "Failed to unmap shared memory: " << strerror(errno) << std::endl;
+                LOG_ERROR("Failed to unmap shared memory: " << strerror(errno));
             }
             data_ = nullptr;
         }
@@ -71,28 +89,28 @@ SharedMemory::~SharedMemory() {
         // Close file descriptor
         if (fd_ != -1) {
             if (close(fd_) == -1) {
-                std::cerr << "Failed to close shared memory fd: " << strerror(errno) << std::endl;
+                LOG_ERROR("Failed to close shared memory fd: " << strerror(errno));
             }
             fd_ = -1;
         }
         
-        // Remove shared memory object
-        if (shm_unlink(name_.c_str()) == -1) {
-            std::cerr << "Failed to unlink shared memory: " << strerror(errno) << std::endl;
+        // Remove shared memory object (the owner's job)
+        if (mode_ == Mode::CREATE && shm_unlink(name_.c_str()) == -1) {
+            LOG_ERROR("Failed to unlink shared memory: " << strerror(errno));
         }
         
-        std::cout << "Shared memory destroyed successfully" << std::endl;
-        std::cout << "=== SharedMemory destruction complete ===\n" << std::endl;
+        LOG_DEBUG("Shared memory destroyed successfully");
+        LOG_DEBUG("=== SharedMemory destruction complete ===");
         
     } catch (const std::exception& e) {
-        std::cerr << "Error destroying shared memory: " << e.what() << std::endl;
+        LOG_ERROR("Error destroying shared memory: " << e.what());
     }
 }
 
 void SharedMemory::remove(const std::string& name) {
-    std::cout << "Removing shared memory: " << name << std::endl;
+    LOG_DEBUG("Removing shared memory: " << name);
     if (shm_unlink(name.c_str()) == -1 && errno != ENOENT) {
-        std::cerr << "Failed to remove shared memory: " << std::strerror(errno) << std::endl;
+        LOG_ERROR("Failed to remove shared memory: " << std::strerror(errno));
     }
 }
 
@@ -8,7 +8,12 @@ namespace lockfree {
 
 class SharedMemory {
 public:
-    SharedMemory(const std::string& name, std::size_t size);
+    enum class Mode {
+        CREATE,  // Owner: (re)create and zero the segment, unlink it on destruction
+        ATTACH   // Reader: map an existing segment as-is and leave it in place
+    };
+
+    SharedMemory(const std::string& name, std::size_t size, Mode mode = Mode::CREATE);
     ~SharedMemory();
 
     void* get_data() const { return data_; }
@@ -21,6 +26,7 @@ private:
     std::size_t size_;
     void* data_;
     int fd_;
+    Mode mode_;
 };
 
 } // namespace lockfree 
\ No newline at end of file
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "message_bus.hpp"
+#include "metrics.hpp"
+
+namespace lockfree {
+
+// One bus message, serialized once and shared by every streaming session.
+struct StreamEvent {
+    uint64_t seq;
+    std::string json;   // WebSocket text frame payload
+    std::string sse;    // Same payload framed as a Server-Sent Event ("id:/data:")
+    PipelineStamps stamps;  // Carried from the bus so sessions can close out end-to-end latency
+};
+
+using StreamEventPtr = std::shared_ptr<const StreamEvent>;
+
+// Session queue entry; the enqueue stamp feeds the write-queue wait histogram
+struct QueuedEvent {
+    StreamEventPtr event;
+    int64_t enqueued_ns;
+    bool replayed = false;  // Resent from history; excluded from end-to-end latency
+};
+
+// Implemented by WebSocket and SSE sessions. deliver() is called on the bus
+// consumer thread and must only hand the event over to the session's executor.
+class StreamSubscriber {
+public:
+    virtual ~StreamSubscriber() = default;
+    virtual void deliver(const StreamEventPtr& event) = 0;
+};
+
+// Fan-out point between the MessageBus and streaming clients. Subscribes to the
+// bus once, serializes each message once, and keeps a short history so
+// reconnecting clients can resume from the last sequence they saw.
+class StreamHub {
+public:
+    static constexpr std::size_t DEFAULT_HISTORY = 4096;
+    // Events a slow session may have queued before it starts dropping
+    static constexpr std::size_t MAX_SESSION_QUEUE = 8192;
+
+    explicit StreamHub(std::size_t history_size = DEFAULT_HISTORY)
+        : history_size_(history_size) {}
+
+    // Must be called before the bus consumer thread starts. Only MARKET_DATA
+    // ticks reach subscribe() callbacks; run the bus with the hub as its visitor
+    // (process_messages(should_continue, hub)) to stream the typed messages too.
+    void attach_to(MessageBus& message_bus) {
+        message_bus.subscribe_traced("market_data",
+            [this](const MarketData& data, const PipelineStamps& stamps) { publish(data, stamps); });
+    }
+
+    // Register a session. When last_seq is set, returns the retained events newer
+    // than it; registration and the history snapshot happen atomically so the
+    // session sees neither gaps nor duplicates.
+    std::vector<StreamEventPtr> add(std::weak_ptr<StreamSubscriber> subscriber,
+                                    std::optional<uint64_t> last_seq = std::nullopt) {
+        std::vector<StreamEventPtr> backlog;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (last_seq) {
+            // Concurrent producers can interleave sequence numbers slightly, so filter
+            // rather than binary search
+            for (const auto& event : history_) {
+                if (event->seq > *last_seq) {
+                    backlog.push_back(event);
+                }
+            }
+        }
+        subscribers_.push_back(std::move(subscriber));
+        return backlog;
+    }
+
+    void publish(const MarketData& data, const PipelineStamps& stamps = PipelineStamps()) {
+        const int64_t start_ns = monotonic_ns();
+        nlohmann::json message = {
+            {"type", "market_data"},
+            {"symbol", data.symbol},
+            {"price", data.price},
+            {"volume", data.volume},
+            {"seq", data.seq},
+            {"timestamp", data.timestamp},
+            {"source", data.source}
+        };
+        auto event = make_event(data.seq, message.dump(), std::string(), stamps);
+        PipelineMetrics::instance().stream_serialization.record(monotonic_ns() - start_ns);
+        broadcast(event);
+    }
+
+    // MessageBus visitor overloads. Heartbeats have none: they only matter to feed
+    // handlers and are not streamed to clients.
+    void operator()(const WireRecord& record, const TickBody&, const PipelineStamps& stamps) {
+        MarketData data;
+        from_wire(record, data);
+        publish(data, stamps);
+    }
+
+    void operator()(const WireRecord& record, const Trade& trade, const PipelineStamps& stamps) {
+        const int64_t start_ns = monotonic_ns();
+        nlohmann::json message = header_json(record);
+        message["price"] = record.fixed_price(trade.price).to_double();
+        message["size"] = from_fixed(trade.size, WireRecord::VOLUME_SCALE);
+        message["aggressor"] = side_name(trade.aggressor);
+        if (trade.trade_id != 0) {
+            message["trade_id"] = trade.trade_id;
+        }
+        publish_json(record.seq, message, stamps, start_ns);
+    }
+
+    void operator()(const WireRecord& record, const Quote& quote, const PipelineStamps& stamps) {
+        const int64_t start_ns = monotonic_ns();
+        nlohmann::json message = header_json(record);
+        message["bid_price"] = record.fixed_price(quote.bid_price).to_double();
+        message["bid_size"] = from_fixed(quote.bid_size, WireRecord::VOLUME_SCALE);
+        message["ask_price"] = record.fixed_price(quote.ask_price).to_double();
+        message["ask_size"] = from_fixed(quote.ask_size, WireRecord::VOLUME_SCALE);
+        publish_json(record.seq, message, stamps, start_ns);
+    }
+
+    void operator()(const WireRecord& record, const BookDelta& delta, const PipelineStamps& stamps) {
+        const int64_t start_ns = monotonic_ns();
+        nlohmann::json message = header_json(record);
+        message["side"] = side_name(delta.side);
+        message["action"] = book_action_name(delta.action);
+        message["level"] = delta.level;
+        message["price"] = record.fixed_price(delta.price).to_double();
+        message["size"] = from_fixed(delta.size, WireRecord::VOLUME_SCALE);
+        publish_json(record.seq, message, stamps, start_ns);
+    }
+
+    void operator()(const WireRecord& record, const Status& status, const PipelineStamps& stamps) {
+        const int64_t start_ns = monotonic_ns();
+        nlohmann::json message = header_json(record);
+        message["status"] = market_status_name(status.status);
+        message["reason"] = std::string(status.reason, strnlen(status.reason, sizeof(status.reason)));
+        publish_json(record.seq, message, stamps, start_ns);
+    }
+
+    // seq == 0 marks events that are not part of the resumable market data stream.
+    // A non-empty sse_event names the SSE event type so EventSource.onmessage skips it.
+    static StreamEventPtr make_event(uint64_t seq, std::string json, const std::string& sse_event = std::string(),
+                                     const PipelineStamps& stamps = PipelineStamps()) {
+        auto event = std::make_shared<StreamEvent>();
+        event->seq = seq;
+        event->stamps = stamps;
+        event->sse.reserve(json.size() + 32);
+        if (seq != 0) {
+            event->sse += "id: " + std::to_string(seq) + "\n";
+        }
+        if (!sse_event.empty()) {
+            event->sse += "event: " + sse_event + "\n";
+        }
+        event->sse += "data: " + json + "\n\n";
+        event->json = std::move(json);
+        return event;
+    }
+
+    void broadcast(const StreamEventPtr& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (event->seq != 0 && history_size_ > 0) {
+            history_.push_back(event);
+            if (history_.size() > history_size_) {
+                history_.pop_front();
+            }
+        }
+        // Deliver and prune sessions that have gone away
+        auto alive = subscribers_.begin();
+        for (auto it = subscribers_.begin(); it != subscribers_.end(); ++it) {
+            if (auto subscriber = it->lock()) {
+                subscriber->deliver(event);
+                if (alive != it) {
+                    *alive = std::move(*it);
+                }
+                ++alive;
+            }
+        }
+        subscribers_.erase(alive, subscribers_.end());
+    }
+
+    std::size_t subscriber_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return subscribers_.size();
+    }
+
+private:
+    static nlohmann::json header_json(const WireRecord& record) {
+        return {
+            {"type", message_type_name(record.type)},
+            {"symbol", SymbolRegistry::instance().name(record.symbol_id)},
+            {"seq", record.seq},
+            {"timestamp", record.timestamp_ns / 1000000},
+            {"source", SourceRegistry::instance().name(record.source_id)}
+        };
+    }
+
+    void publish_json(uint64_t seq, const nlohmann::json& message, const PipelineStamps& stamps, int64_t start_ns) {
+        auto event = make_event(seq, message.dump(), std::string(), stamps);
+        PipelineMetrics::instance().stream_serialization.record(monotonic_ns() - start_ns);
+        broadcast(event);
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::weak_ptr<StreamSubscriber>> subscribers_;
+    std::deque<StreamEventPtr> history_;
+    std::size_t history_size_;
+};
+
+} // namespace lockfree
@@ -0,0 +1,150 @@
+#include "symbol_registry.hpp"
+#include "logger.hpp"
+#include "price.hpp"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace lockfree {
+
+namespace {
+
+std::unique_ptr<SymbolRegistry>& global_registry() {
+    static std::unique_ptr<SymbolRegistry> registry;
+    return registry;
+}
+
+std::once_flag& global_registry_once() {
+    static std::once_flag once;
+    return once;
+}
+
+std::size_t symbol_length(const char* symbol) {
+    std::size_t length = 0;
+    while (length < SymbolRegistry::NAME_SIZE - 1 && symbol[length] != '\0') {
+        ++length;
+    }
+    return length;
+}
+
+} // namespace
+
+SymbolRegistry::SymbolRegistry(Layout* layout, std::unique_ptr<SharedMemory> shm, std::unique_ptr<Layout> heap)
+    : layout_(layout), shm_(std::move(shm)), heap_(std::move(heap)) {}
+
+SymbolRegistry::~SymbolRegistry() = default;
+
+SymbolRegistry::Layout* SymbolRegistry::init_layout(void* memory) {
+    // Memory is zeroed (fresh heap/shm), which is the empty table; just stamp it
+    auto* layout = static_cast<Layout*>(memory);
+    layout->magic = MAGIC;
+    return layout;
+}
+
+SymbolRegistry& SymbolRegistry::instance() {
+    std::call_once(global_registry_once(), [] {
+        auto heap = std::unique_ptr<Layout>(new Layout());
+        Layout* layout = init_layout(heap.get());
+        global_registry().reset(new SymbolRegistry(layout, nullptr, std::move(heap)));
+    });
+    return *global_registry();
+}
+
+void SymbolRegistry::use_shared_memory(const std::string& name) {
+    bool created = false;
+    std::call_once(global_registry_once(), [&] {
+        global_registry() = create(name);
+        created = true;
+    });
+    if (!created) {
+        throw std::logic_error("SymbolRegistry::use_shared_memory(\"" + name +
+                               "\") called after the registry was first used");
+    }
+    LOG_INFO("[SymbolRegistry] Shared symbol table /" << name << " (" << sizeof(Layout) / 1024 << " KiB)");
+}
+
+std::unique_ptr<SymbolRegistry> SymbolRegistry::create(const std::string& name) {
+    auto shm = std::make_unique<SharedMemory>(name, sizeof(Layout));
+    Layout* layout = init_layout(shm->get_data());
+    return std::unique_ptr<SymbolRegistry>(new SymbolRegistry(layout, std::move(shm), nullptr));
+}
+
+std::unique_ptr<SymbolRegistry> SymbolRegistry::attach(const std::string& name) {
+    auto shm = std::make_unique<SharedMemory>(name, sizeof(Layout), SharedMemory::Mode::ATTACH);
+    auto* layout = static_cast<Layout*>(shm->get_data());
+    if (layout->magic != MAGIC) {
+        throw std::runtime_error("Shared memory /" + name + " is not a symbol registry");
+    }
+    return std::unique_ptr<SymbolRegistry>(new SymbolRegistry(layout, std::move(shm), nullptr));
+}
+
+uint32_t SymbolRegistry::hash(const char* symbol, std::size_t length) {
+    // FNV-1a: symbols are short, so this beats anything fancier
+    uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < length; ++i) {
+        h ^= static_cast<unsigned char>(symbol[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Returns the id stored for symbol, or INVALID_ID with slot set to the empty slot that ended the probe
+uint32_t SymbolRegistry::probe(const char* symbol, std::size_t length, uint32_t& slot) const {
+    slot = hash(symbol, length) & (INDEX_SLOTS - 1);
+    for (;;) {
+        const uint32_t id = layout_->index[slot].load(std::memory_order_acquire);
+        if (id == INVALID_ID) {
+            return INVALID_ID;
+        }
+        const char* name = layout_->entries[id - 1].name;
+        if (std::strncmp(name, symbol, length) == 0 && name[length] == '\0') {
+            return id;
+        }
+        slot = (slot + 1) & (INDEX_SLOTS - 1);
+    }
+}
+
+uint32_t SymbolRegistry::find(const char* symbol) const {
+    const std::size_t length = symbol_length(symbol);
+    if (length == 0) {
+        return INVALID_ID;
+    }
+    uint32_t slot;
+    return probe(symbol, length, slot);
+}
+
+uint32_t SymbolRegistry::intern(const char* symbol) {
+    const std::size_t length = symbol_length(symbol);
+    if (length == 0) {
+        return INVALID_ID;
+    }
+    uint32_t slot;
+    uint32_t id = probe(symbol, length, slot);
+    if (id != INVALID_ID) {
+        return id;
+    }
+
+    std::lock_guard<std::mutex> lock(insert_mutex_);
+    // Another thread may have inserted it while we waited
+    id = probe(symbol, length, slot);
+    if (id != INVALID_ID) {
+        return id;
+    }
+    const uint32_t count = layout_->count.load(std::memory_order_relaxed);
+    if (count >= MAX_SYMBOLS) {
+        LOG_WARN_RATE_LIMITED(1000, "[SymbolRegistry] Table full, cannot intern " << std::string(symbol, length));
+        return INVALID_ID;
+    }
+
+    // Fill the entry, then publish the count and finally the index slot that makes it findable
+    Entry& entry = layout_->entries[count];
+    std::memset(&entry, 0, sizeof(entry));
+    std::memcpy(entry.name, symbol, length);
+    entry.price_decimals = InstrumentTable::instance().price_decimals(entry.name);
+    id = count + 1;
+    layout_->count.store(id, std::memory_order_release);
+    layout_->index[slot].store(id, std::memory_order_release);
+    return id;
+}
+
+} // namespace lockfree
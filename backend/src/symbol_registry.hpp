@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "shared_memory.hpp"
+
+namespace lockfree {
+
+// Interns instrument symbols to dense 32-bit ids (1, 2, 3, ...; 0 is invalid),
+// so per-symbol state can live in flat arrays and records can carry an id
+// instead of a string.
+//
+// The table is a fixed-size region: an open-addressing index of ids followed
+// by the dense entry array. Lookups are lock-free (acquire loads of published
+// slots); inserts are serialized by a process-local mutex, so exactly one
+// process may intern while others attach() read-only to resolve ids.
+class SymbolRegistry {
+public:
+    static constexpr uint32_t INVALID_ID = 0;
+    static constexpr uint32_t MAX_SYMBOLS = 65535;  // Ids fit 16 bits on the wire
+    static constexpr std::size_t NAME_SIZE = 16;
+
+    ~SymbolRegistry();
+
+    // Process-wide registry, created on first use: in the segment named by
+    // use_shared_memory() if that came first, otherwise on the heap. It is
+    // never replaced, so references and ids stay valid.
+    static SymbolRegistry& instance();
+
+    // Create the process-wide registry in the named shared memory segment.
+    // Call at startup before anything uses instance(); throws
+    // std::logic_error once the registry exists.
+    static void use_shared_memory(const std::string& name);
+
+    // A fresh registry of its own in the named shared memory segment
+    static std::unique_ptr<SymbolRegistry> create(const std::string& name);
+
+    // Map a registry owned by another process
+    static std::unique_ptr<SymbolRegistry> attach(const std::string& name);
+
+    // Id for symbol, assigning the next one on first sight; INVALID_ID when full or empty
+    uint32_t intern(const char* symbol);
+
+    // Id for symbol without inserting; INVALID_ID if unknown
+    uint32_t find(const char* symbol) const;
+
+    // "" for ids that are not (yet) assigned
+    const char* name(uint32_t id) const {
+        return id != INVALID_ID && id <= size() ? layout_->entries[id - 1].name : "";
+    }
+
+    // Price scale captured from the InstrumentTable when the symbol was interned
+    uint8_t price_decimals(uint32_t id) const {
+        return id != INVALID_ID && id <= size() ? layout_->entries[id - 1].price_decimals : 0;
+    }
+
+    uint32_t size() const { return layout_->count.load(std::memory_order_acquire); }
+
+private:
+    static constexpr uint64_t MAGIC = 0x53594d424f4c5331ull;  // "SYMBOLS1"
+    static constexpr uint32_t INDEX_SLOTS = 131072;  // Power of two, load factor <= 0.5
+
+    struct Entry {
+        char name[NAME_SIZE];
+        uint8_t price_decimals;
+        uint8_t reserved[15];
+    };
+
+    struct Layout {
+        uint64_t magic;
+        std::atomic<uint32_t> count;
+        std::atomic<uint32_t> index[INDEX_SLOTS];  // 0 = empty, else id
+        Entry entries[MAX_SYMBOLS];
+    };
+
+    SymbolRegistry(Layout* layout, std::unique_ptr<SharedMemory> shm, std::unique_ptr<Layout> heap);
+
+    static Layout* init_layout(void* memory);
+    static uint32_t hash(const char* symbol, std::size_t length);
+    uint32_t probe(const char* symbol, std::size_t length, uint32_t& slot) const;
+
+    Layout* layout_;
+    std::unique_ptr<SharedMemory> shm_;
+    std::unique_ptr<Layout> heap_;
+    std::mutex insert_mutex_;
+};
+
+} // namespace lockfree
@@ -0,0 +1,213 @@
+#include "synthetic_feed.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include "price.hpp"
+
+namespace lockfree {
+
+namespace {
+
+constexpr double SECONDS_PER_YEAR = 365.25 * 24 * 3600;
+constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+} // namespace
+
+Xoshiro256::Xoshiro256(uint64_t seed) {
+    for (auto& word : state_) {
+        word = splitmix64(seed);
+    }
+}
+
+double Xoshiro256::normal() {
+    if (has_spare_) {
+        has_spare_ = false;
+        return spare_;
+    }
+    double u;
+    double v;
+    double s;
+    do {
+        u = 2.0 * uniform() - 1.0;
+        v = 2.0 * uniform() - 1.0;
+        s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+    const double scale = std::sqrt(-2.0 * std::log(s) / s);
+    spare_ = v * scale;
+    has_spare_ = true;
+    return u * scale;
+}
+
+bool SyntheticFeedConfig::parse(const std::string& spec, SyntheticFeedConfig& config, std::string& error) {
+    std::stringstream entries(spec);
+    for (std::string entry; std::getline(entries, entry, ',');) {
+        if (entry.empty()) {
+            continue;
+        }
+        const auto eq = entry.find('=');
+        const std::string key = entry.substr(0, eq);
+        const std::string text = eq == std::string::npos ? std::string() : entry.substr(eq + 1);
+        char* end = nullptr;
+        const double value = std::strtod(text.c_str(), &end);
+        if (text.empty() || *end != '\0' || !std::isfinite(value)) {
+            error = "bad value for " + key + ": '" + text + "'";
+            return false;
+        }
+        if (key == "seed") {
+            config.seed = static_cast<uint64_t>(std::strtoull(text.c_str(), nullptr, 10));
+        } else if (key == "symbols" && value >= 1 && value <= 65535) {
+            config.symbols = static_cast<uint32_t>(value);
+        } else if (key == "rows" && value >= 0) {
+            config.rows = static_cast<uint64_t>(value);
+        } else if (key == "rate" && value > 0) {
+            config.rate = value;
+        } else if (key == "zipf" && value >= 0) {
+            config.zipf = value;
+        } else if (key == "bursts" && value >= 0) {
+            config.bursts_per_second = value;
+        } else if (key == "burst_ms" && value >= 0) {
+            config.burst_ms = value;
+        } else if (key == "burst_x" && value > 0) {
+            config.burst_multiplier = value;
+        } else if (key == "vol" && value >= 0) {
+            config.volatility = value;
+        } else if (key == "drift") {
+            config.drift = value;
+        } else if (key == "price" && value > 0) {
+            config.price = value;
+        } else if (key == "volume" && value > 0) {
+            config.volume = value;
+        } else if (key == "start_ms") {
+            config.start_ns = static_cast<int64_t>(value) * 1'000'000;
+        } else {
+            error = "unknown key or out-of-range value: " + entry;
+            return false;
+        }
+    }
+    return true;
+}
+
+SyntheticFeed::SyntheticFeed(const SyntheticFeedConfig& config)
+    : config_(config)
+    , rng_(config.seed) {
+    const uint32_t n = std::max<uint32_t>(config_.symbols, 1);
+    symbols_.reserve(n);
+    decimals_.reserve(n);
+    scales_.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        char name[16];
+        std::snprintf(name, sizeof(name), "SYN%04u", i);
+        symbols_.emplace_back(name);
+        decimals_.push_back(InstrumentTable::instance().price_decimals(name));
+        scales_.push_back(std::pow(10.0, decimals_.back()));
+    }
+
+    // Vose's alias method: split the scaled weights into one column per
+    // symbol, each holding the symbol itself up to alias_probability_ and its
+    // alias above that
+    std::vector<double> scaled(n);
+    double total = 0.0;
+    for (uint32_t i = 0; i < n; ++i) {
+        scaled[i] = 1.0 / std::pow(static_cast<double>(i + 1), config_.zipf);
+        total += scaled[i];
+    }
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; ++i) {
+        scaled[i] *= n / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    alias_probability_.assign(n, 1.0);
+    alias_.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        alias_[i] = i;
+    }
+    while (!small.empty() && !large.empty()) {
+        const uint32_t s = small.back();
+        small.pop_back();
+        const uint32_t l = large.back();
+        alias_probability_[s] = scaled[s];
+        alias_[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    reset();
+}
+
+void SyntheticFeed::reset() {
+    rng_ = Xoshiro256(config_.seed);
+    generated_ = 0;
+    clock_ns_ = 0.0;
+    log_prices_.resize(symbols_.size());
+    last_tick_ns_.assign(symbols_.size(), 0.0);
+    for (auto& log_price : log_prices_) {
+        log_price = std::log(config_.price) + 0.5 * rng_.normal();
+    }
+    schedule_burst();
+}
+
+void SyntheticFeed::schedule_burst() {
+    if (config_.bursts_per_second <= 0) {
+        burst_start_ns_ = burst_end_ns_ = NEVER;
+        return;
+    }
+    burst_start_ns_ = clock_ns_ - std::log(rng_.uniform_open()) / config_.bursts_per_second * 1e9;
+    burst_end_ns_ = burst_start_ns_ + config_.burst_ms * 1e6;
+}
+
+uint32_t SyntheticFeed::draw_symbol() {
+    const double column = rng_.uniform() * static_cast<double>(symbols_.size());
+    const auto index = static_cast<uint32_t>(column);
+    return column - index < alias_probability_[index] ? index : alias_[index];
+}
+
+bool SyntheticFeed::next(SyntheticTick& tick) {
+    if (config_.rows != 0 && generated_ >= config_.rows) {
+        return false;
+    }
+    // Exponential gaps at the current rate. A gap that crosses a burst edge is
+    // cut there and redrawn at the new rate, which is exact for a Poisson process.
+    for (;;) {
+        const bool in_burst = clock_ns_ >= burst_start_ns_;
+        const double rate = in_burst ? config_.rate * config_.burst_multiplier : config_.rate;
+        const double gap_ns = -std::log(rng_.uniform_open()) / rate * 1e9;
+        const double edge_ns = in_burst ? burst_end_ns_ : burst_start_ns_;
+        if (clock_ns_ + gap_ns < edge_ns) {
+            clock_ns_ += gap_ns;
+            break;
+        }
+        clock_ns_ = edge_ns;
+        if (in_burst) {
+            schedule_burst();
+        }
+    }
+
+    const uint32_t symbol = draw_symbol();
+    const double dt = (clock_ns_ - last_tick_ns_[symbol]) * 1e-9 / SECONDS_PER_YEAR;
+    last_tick_ns_[symbol] = clock_ns_;
+    double& log_price = log_prices_[symbol];
+    log_price += (config_.drift - 0.5 * config_.volatility * config_.volatility) * dt +
+                 config_.volatility * std::sqrt(dt) * rng_.normal();
+
+    tick.timestamp_ns = config_.start_ns + static_cast<int64_t>(clock_ns_);
+    tick.symbol = symbol;
+    tick.price_ticks = std::llround(std::exp(log_price) * scales_[symbol]);
+    tick.volume = std::max(1.0, std::round(-std::log(rng_.uniform_open()) * config_.volume));
+    ++generated_;
+    return true;
+}
+
+} // namespace lockfree
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lockfree {
+
+// xoshiro256** (Blackman & Vigna), seeded through splitmix64. Small, fast
+// and reproducible across platforms, unlike std::rand().
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed = 1);
+
+    uint64_t next() {
+        const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+    uint64_t operator()() { return next(); }
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    // Uniform in [0, 1), 53 bits
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+    // Uniform in (0, 1], safe to take the log of
+    double uniform_open() { return static_cast<double>((next() >> 11) + 1) * 0x1.0p-53; }
+    // Standard normal (Marsaglia polar method; the second value is cached)
+    double normal();
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t state_[4];
+    double spare_ = 0.0;
+    bool has_spare_ = false;
+};
+
+// Shape of a synthetic tick stream. The same config (seed included) always
+// yields the same ticks.
+struct SyntheticFeedConfig {
+    uint64_t seed = 1;
+    uint32_t symbols = 100;
+    uint64_t rows = 10'000'000;        // 0 for an endless feed
+    double rate = 1'000'000.0;         // Mean ticks per second of data time, all symbols
+    double zipf = 1.0;                 // Symbol popularity skew: weight of rank k is 1/k^zipf (0 = uniform)
+    double bursts_per_second = 0.5;    // Poisson arrivals of bursts
+    double burst_ms = 100.0;           // Length of a burst
+    double burst_multiplier = 10.0;    // Tick rate during a burst
+    double volatility = 0.5;           // Annualised, of each symbol's geometric random walk
+    double drift = 0.0;                // Annualised
+    double price = 100.0;              // Median starting price; symbols are spread around it
+    double volume = 100.0;             // Mean trade size
+    int64_t start_ns = 1'700'000'000'000'000'000;  // Feed clock at zero; the first tick follows
+
+    // Parse "key=value,..." with keys seed, symbols, rows, rate, zipf, bursts,
+    // burst_ms, burst_x, vol, drift, price, volume and start_ms; unset keys
+    // keep their value. Returns false and sets error on an unknown key or a
+    // bad value.
+    static bool parse(const std::string& spec, SyntheticFeedConfig& config, std::string& error);
+};
+
+struct SyntheticTick {
+    int64_t timestamp_ns;
+    uint32_t symbol;     // Index into SyntheticFeed::symbol(); 0 is the most popular
+    int64_t price_ticks;  // In price_decimals(symbol)
+    double volume;
+};
+
+// Seeded synthetic market: ticks arrive as a Poisson process whose rate jumps
+// by burst_multiplier during bursts (themselves Poisson arrivals), each tick
+// goes to a symbol drawn from a Zipf distribution (alias table, O(1)), and
+// each symbol's price follows a geometric random walk over the time since its
+// previous tick. Prices are in the symbol's InstrumentTable scale, read at
+// construction.
+class SyntheticFeed {
+public:
+    explicit SyntheticFeed(const SyntheticFeedConfig& config);
+
+    // Next tick; false once config.rows ticks have been generated
+    bool next(SyntheticTick& tick);
+    // Back to the first tick
+    void reset();
+
+    const SyntheticFeedConfig& config() const { return config_; }
+    uint64_t generated() const { return generated_; }
+    // "SYN0000", "SYN0001", ...
+    const std::string& symbol(uint32_t index) const { return symbols_[index]; }
+    uint8_t price_decimals(uint32_t index) const { return decimals_[index]; }
+
+private:
+    uint32_t draw_symbol();
+    void schedule_burst();
+
+    SyntheticFeedConfig config_;
+    std::vector<std::string> symbols_;
+    std::vector<uint8_t> decimals_;
+    std::vector<double> scales_;           // 10^decimals
+    // Vose alias table over symbol weights
+    std::vector<double> alias_probability_;
+    std::vector<uint32_t> alias_;
+
+    Xoshiro256 rng_;
+    uint64_t generated_ = 0;
+    double clock_ns_ = 0.0;                // Since start_ns, fractional so gaps do not round away
+    double burst_start_ns_ = 0.0;
+    double burst_end_ns_ = 0.0;
+    std::vector<double> log_prices_;
+    std::vector<double> last_tick_ns_;
+};
+
+} // namespace lockfree
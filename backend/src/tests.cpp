@@ -1,11 +1,34 @@
 #include "message_bus.hpp"
+#include "ingest_gateway.hpp"
+#include "ndjson_ingest.hpp"
+#include "query_string.hpp"
+#include "stream_hub.hpp"
 #include "ring_buffer.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "sharded_counter.hpp"
+#include "symbol_registry.hpp"
+#include "tick_codec.hpp"
+#include "synthetic_feed.hpp"
+#include "market_data/capture_recorder.hpp"
+#include "market_data/pacing.hpp"
+#include "market_data/parallel_replay.hpp"
+#include "market_data/replay_engine.hpp"
+#include "market_data/replay_publisher.hpp"
+#include "market_data/tick_file.hpp"
+#include "market_data/tick_loader.hpp"
 #include <gtest/gtest.h>
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <map>
+#include <optional>
 #include <vector>
 #include <mutex>
+#include <unistd.h>
 
 using namespace lockfree;
 
@@ -814,6 +837,1773 @@ TEST_F(MessageBusTest, MessageOrdering) {
     std::cout << "=== MessageOrdering test completed ===\n" << std::endl;
 }
 
+// Compile-time visitor: one overload per handled kind, heartbeats deliberately unhandled
+struct TypedVisitor {
+    std::vector<MessageType> seen;
+    Quote quote{};
+    Trade trade{};
+    std::string tick_symbol;
+
+    void operator()(const WireRecord& record, const TickBody&, const PipelineStamps&) {
+        MarketData data;
+        from_wire(record, data);
+        tick_symbol = data.symbol;
+        seen.push_back(record.type);
+    }
+    void operator()(const WireRecord& record, const Quote& body, const PipelineStamps& stamps) {
+        EXPECT_NE(stamps.ring_read_ns, 0);
+        quote = body;
+        seen.push_back(record.type);
+    }
+    void operator()(const WireRecord& record, const Trade& body, const PipelineStamps&) {
+        trade = body;
+        seen.push_back(record.type);
+    }
+};
+
+TEST_F(MessageBusTest, DispatchesTypedMessagesToVisitorOverloads) {
+    WireRecord record{};
+    set_header(record, "TEST_QUOTE", "TEST_FEED", 1700000000000000000);
+    record.set_body(Quote{encode_price(record, 99.5), 3 * WireRecord::VOLUME_SCALE,
+                          encode_price(record, 99.75), 4 * WireRecord::VOLUME_SCALE});
+    ASSERT_TRUE(bus_->publish_record("market_data", record));
+    record.set_body(Heartbeat{7});
+    ASSERT_TRUE(bus_->publish_record("market_data", record));
+    record.set_body(Trade{encode_price(record, 99.75), WireRecord::VOLUME_SCALE / 2, 12345, Side::BUY});
+    ASSERT_TRUE(bus_->publish_record("market_data", record));
+    MarketData tick{};
+    std::strncpy(tick.symbol, "TEST_TICK", sizeof(tick.symbol) - 1);
+    tick.price = 1.0;
+    ASSERT_TRUE(bus_->publish(tick));
+
+    TypedVisitor visitor;
+    std::atomic<bool> should_continue{true};
+    std::thread consumer([&] { bus_->process_messages(should_continue, visitor); });
+    for (int i = 0; i < 200 && bus_->get_processed_count() < 4; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    should_continue = false;
+    consumer.join();
+
+    EXPECT_EQ(bus_->get_processed_count(), 4u);
+    const std::vector<MessageType> expected = {MessageType::QUOTE, MessageType::TRADE, MessageType::MARKET_DATA};
+    EXPECT_EQ(visitor.seen, expected);
+    EXPECT_EQ(FixedPrice(visitor.quote.ask_price, record.price_decimals()), FixedPrice::from_double(99.75, 2));
+    EXPECT_EQ(visitor.quote.bid_size, 3 * WireRecord::VOLUME_SCALE);
+    EXPECT_EQ(visitor.trade.trade_id, 12345u);
+    EXPECT_EQ(visitor.trade.aggressor, Side::BUY);
+    EXPECT_EQ(visitor.tick_symbol, "TEST_TICK");
+}
+
+TEST_F(MessageBusTest, PublishBatchAcceptsAPrefix) {
+    std::vector<MarketData> ticks(bus_->get_capacity() + 100);
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        std::strncpy(ticks[i].symbol, "TEST_BATCH", sizeof(ticks[i].symbol) - 1);
+        ticks[i].price = 10.0;
+        ticks[i].volume = static_cast<double>(i);
+    }
+    // Fill all but 10 slots, then offer 50: the first 10 go in, the rest are dropped once
+    const size_t first = bus_->get_capacity() - 10;
+    EXPECT_EQ(bus_->publish_batch("market_data", ticks.data(), first), first);
+    EXPECT_EQ(bus_->publish_batch("market_data", ticks.data() + first, 50), 10u);
+    EXPECT_EQ(bus_->get_dropped_count(), 40u);
+    EXPECT_EQ(bus_->get_published_count(), bus_->get_capacity());
+
+    std::vector<double> volumes;
+    std::atomic<bool> should_continue{true};
+    auto visitor = [&](const WireRecord& record, const TickBody& body, const PipelineStamps&) {
+        EXPECT_EQ(record.seq, volumes.size() + 1);
+        volumes.push_back(from_fixed(body.volume, WireRecord::VOLUME_SCALE));
+        if (volumes.size() == bus_->get_capacity()) {
+            should_continue = false;
+        }
+    };
+    bus_->process_messages(should_continue, visitor);
+    for (size_t i = 0; i < volumes.size(); ++i) {
+        ASSERT_EQ(volumes[i], static_cast<double>(i));
+    }
+
+    // Only claimed records took a seq, so the next one follows without a gap
+    ASSERT_EQ(bus_->publish_batch("market_data", ticks.data(), 1), 1u);
+    should_continue = true;
+    auto next_visitor = [&](const WireRecord& record, const TickBody&, const PipelineStamps&) {
+        EXPECT_EQ(record.seq, bus_->get_capacity() + 1);
+        should_continue = false;
+    };
+    bus_->process_messages(should_continue, next_visitor);
+}
+
+TEST(RingBufferTest, MultiProducerNoLossOrTearing) {
+    constexpr int num_producers = 4;
+    constexpr uint64_t per_producer = 50000;
+    auto ring = std::make_unique<RingBuffer<uint64_t, 1024>>();
+    std::atomic<bool> start{false};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p]() {
+            while (!start) {}
+            for (uint64_t i = 0; i < per_producer; ++i) {
+                // Encode producer id in the high bits so the consumer can check per-producer order
+                const uint64_t value = (static_cast<uint64_t>(p) << 32) | i;
+                while (!ring->write(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint64_t> next_expected(num_producers, 0);
+    uint64_t received = 0;
+    bool in_order = true;
+    start = true;
+    while (received < num_producers * per_producer) {
+        uint64_t value;
+        if (!ring->read(value)) {
+            continue;
+        }
+        const auto producer = static_cast<std::size_t>(value >> 32);
+        const uint64_t index = value & 0xffffffffu;
+        ASSERT_LT(producer, next_expected.size());
+        if (index != next_expected[producer]) {
+            in_order = false;
+        }
+        next_expected[producer] = index + 1;
+        received++;
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_TRUE(in_order) << "Per-producer FIFO order violated";
+    EXPECT_TRUE(ring->is_empty());
+    for (uint64_t n : next_expected) {
+        EXPECT_EQ(n, per_producer);
+    }
+}
+
+TEST(RingBufferTest, ProducersNeverSeeFullWhileConsumerKeepsPace) {
+    // Producers keep the ring at most half full, so every write must succeed;
+    // a failure means a stale write position was mistaken for a full ring
+    constexpr int num_producers = 4;
+    constexpr uint64_t per_producer = 20000;
+    auto ring = std::make_unique<RingBuffer<uint64_t, 64>>();
+    std::atomic<bool> start{false};
+    std::atomic<uint64_t> failed{0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p]() {
+            while (!start) {}
+            for (uint64_t i = 0; i < per_producer; ++i) {
+                while (ring->size() > ring->capacity() / 2) {
+                    std::this_thread::yield();
+                }
+                if (!ring->write(i)) {
+                    failed.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (i % 2 == 0 && !ring->write_batch(1, [i](std::size_t) { return i; })) {
+                    failed.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    const uint64_t expected = num_producers * (per_producer + per_producer / 2);
+    uint64_t received = 0;
+    start = true;
+    while (received + failed.load(std::memory_order_relaxed) < expected) {
+        uint64_t value;
+        if (ring->read(value)) {
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(failed.load(), 0u);
+    EXPECT_EQ(received, expected);
+}
+
+TEST(RingBufferTest, WriteBatchClaimsAPrefix) {
+    auto ring = std::make_unique<RingBuffer<uint64_t, 16>>();
+    uint64_t next = 0;
+    auto item = [&next](std::size_t) { return next++; };
+    EXPECT_EQ(ring->write_batch(10, item), 10u);
+    EXPECT_EQ(ring->write_batch(10, item), 5u);  // Only the first 5 fit
+    EXPECT_EQ(ring->write_batch(10, item), 0u);
+    EXPECT_TRUE(ring->is_full());
+    for (uint64_t expected = 0; expected < 15; ++expected) {
+        uint64_t value;
+        ASSERT_TRUE(ring->read(value));
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_TRUE(ring->is_empty());
+}
+
+TEST(LoggerTest, RateLimiterSuppressesWithinInterval) {
+    RateLimiter limiter(std::chrono::milliseconds(50));
+    uint64_t suppressed = 0;
+
+    EXPECT_TRUE(limiter.allow(suppressed));
+    EXPECT_EQ(suppressed, 0u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(limiter.allow(suppressed));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_TRUE(limiter.allow(suppressed));
+    EXPECT_EQ(suppressed, 10u);
+}
+
+TEST(MetricsTest, LatencyHistogramPercentilesWithinBucketError) {
+    LatencyHistogram histogram;
+    for (int64_t v = 1; v <= 100000; ++v) {
+        histogram.record(v);
+    }
+    EXPECT_EQ(histogram.count(), 100000u);
+
+    // Log-linear buckets keep the reported upper bound within ~1/16 of the true value
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        const double expected = q * 100000;
+        const double actual = static_cast<double>(histogram.percentile(q));
+        EXPECT_GE(actual, expected * 0.99) << "q=" << q;
+        EXPECT_LE(actual, expected * 1.07) << "q=" << q;
+    }
+
+    for (uint64_t v : {0ull, 15ull, 16ull, 1000ull, 123456789ull}) {
+        EXPECT_LE(v, LatencyHistogram::bucket_upper_bound(LatencyHistogram::bucket_index(v)));
+    }
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.percentile(0.5), 0u);
+}
+
+TEST(MetricsTest, TscClockTracksSteadyClock) {
+    TscClock::calibrate(std::chrono::milliseconds(10));
+
+    int64_t previous = monotonic_ns();
+    for (int i = 0; i < 1000; ++i) {
+        const int64_t now = monotonic_ns();
+        EXPECT_GE(now, previous);
+        previous = now;
+    }
+
+    // Whichever source is active, it must agree with steady_clock over a short interval
+    const int64_t steady_start = TscClock::steady_ns();
+    const int64_t start = monotonic_ns();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const int64_t elapsed = monotonic_ns() - start;
+    const int64_t steady_elapsed = TscClock::steady_ns() - steady_start;
+    EXPECT_NEAR(static_cast<double>(elapsed), static_cast<double>(steady_elapsed), steady_elapsed * 0.01 + 100000);
+}
+
+TEST(ShardedCounterTest, ConcurrentAddsSumExactly) {
+    ShardedCounter<> counter;
+    constexpr int num_threads = 8;
+    constexpr uint64_t per_thread = 100000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&counter]() {
+            for (uint64_t i = 0; i < per_thread; ++i) {
+                counter.add();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.load(), num_threads * per_thread);
+
+    counter.reset();
+    EXPECT_EQ(counter.load(), 0u);
+}
+
+TEST(WireRecordTest, RoundTripsThroughCompactLayout) {
+    static_assert(sizeof(WireRecord) == 64, "one cache line");
+
+    MarketData in{};
+    std::strncpy(in.symbol, "BTCUSDT", sizeof(in.symbol) - 1);
+    in.price = 43123.45678901;
+    in.volume = 0.125;
+    in.seq = 42;
+    in.timestamp = 1700000000123;
+    std::strncpy(in.source, "BINANCE", sizeof(in.source) - 1);
+
+    WireRecord record;
+    to_wire(in, record);
+    record.ring_write_ns = 1000000;
+    record.set_ingest_ns(999000);
+    EXPECT_EQ(record.ingest_ns(), 999000);
+    record.set_ingest_ns(-10000000000);  // Older than the 32-bit offset can hold
+    EXPECT_EQ(record.ingest_delta_ns, UINT32_MAX);
+
+    MarketData out{};
+    from_wire(record, out);
+    EXPECT_STREQ(out.symbol, "BTCUSDT");
+    EXPECT_DOUBLE_EQ(out.price, in.price);
+    EXPECT_DOUBLE_EQ(out.volume, in.volume);
+    EXPECT_EQ(out.seq, 42u);
+    EXPECT_EQ(out.timestamp, in.timestamp);
+    EXPECT_STREQ(out.source, "BINANCE");
+    EXPECT_EQ(SourceRegistry::instance().intern("BINANCE"), record.source_id);
+}
+
+TEST(PriceTest, FixedPriceArithmeticIsExact) {
+    const FixedPrice a = FixedPrice::from_double(0.1, 2);
+    const FixedPrice b = FixedPrice::from_double(0.2, 2);
+    EXPECT_EQ(a + b, FixedPrice(30, 2));
+    EXPECT_EQ((a + b).to_string(), "0.30");
+    EXPECT_EQ(FixedPrice(-1872300, 4).to_string(), "-187.2300");
+
+    // Mixed scales compare on the finer one
+    EXPECT_EQ(FixedPrice(15, 1), FixedPrice(150, 2));
+    EXPECT_LT(FixedPrice(149, 2), FixedPrice(15, 1));
+    EXPECT_EQ(FixedPrice(12345, 3).rescale(1), FixedPrice(123, 1));
+    EXPECT_EQ(FixedPrice(-12350, 3).rescale(1), FixedPrice(-124, 1));
+}
+
+TEST(PriceTest, InstrumentTableScalesPerSymbol) {
+    auto& table = InstrumentTable::instance();
+    ASSERT_TRUE(table.configure("TEST_EQ=2,TEST_FX=5"));
+    EXPECT_FALSE(table.configure("BROKEN"));
+    EXPECT_EQ(table.price_decimals("TEST_EQ"), 2);
+    EXPECT_EQ(table.price_decimals("TEST_FX"), 5);
+    EXPECT_EQ(table.price_decimals("TEST_UNLISTED"), InstrumentTable::DEFAULT_DECIMALS);
+
+    MarketData in{};
+    std::strncpy(in.symbol, "TEST_FX", sizeof(in.symbol) - 1);
+    in.price = 1.08765;
+    WireRecord record;
+    to_wire(in, record);
+    EXPECT_EQ(record.tick.price, 108765);
+    EXPECT_EQ(record.price_decimals(), 5);
+}
+
+TEST(SymbolRegistryTest, InternsDenseIdsVisibleToAttachedReaders) {
+    auto owner = SymbolRegistry::create("test_symbol_registry");
+    auto& registry = *owner;
+
+    const uint32_t aapl = registry.intern("TEST_AAPL");
+    const uint32_t msft = registry.intern("TEST_MSFT");
+    EXPECT_EQ(aapl, 1u);
+    EXPECT_EQ(msft, 2u);
+    EXPECT_EQ(registry.intern("TEST_AAPL"), aapl);
+    EXPECT_EQ(registry.find("TEST_MSFT"), msft);
+    EXPECT_EQ(registry.find("TEST_NVDA"), SymbolRegistry::INVALID_ID);
+    EXPECT_EQ(registry.intern(""), SymbolRegistry::INVALID_ID);
+    EXPECT_STREQ(registry.name(msft), "TEST_MSFT");
+    EXPECT_STREQ(registry.name(99), "");
+
+    // Concurrent first sightings of the same symbols agree on one id each
+    std::vector<std::thread> threads;
+    std::vector<uint32_t> ids(4 * 100);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 100; ++i) {
+                ids[t * 100 + i] = registry.intern(("SYM" + std::to_string(i)).c_str());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(ids[i], ids[100 + i]);
+        EXPECT_EQ(ids[i], ids[300 + i]);
+    }
+    EXPECT_EQ(registry.size(), 102u);
+
+    auto reader = SymbolRegistry::attach("test_symbol_registry");
+    EXPECT_EQ(reader->find("TEST_AAPL"), aapl);
+    EXPECT_STREQ(reader->name(registry.find("SYM42")), "SYM42");
+    EXPECT_EQ(reader->size(), 102u);
+}
+
+TEST(SymbolRegistryTest, ProcessRegistryIsNeverReplaced) {
+    auto& registry = SymbolRegistry::instance();
+    const uint32_t id = registry.intern("TEST_KEEP");
+    EXPECT_THROW(SymbolRegistry::use_shared_memory("test_symbol_registry_late"), std::logic_error);
+    EXPECT_EQ(&SymbolRegistry::instance(), &registry);
+    EXPECT_STREQ(SymbolRegistry::instance().name(id), "TEST_KEEP");
+}
+
+TEST(TickCodecTest, RoundTripsInterleavedSymbols) {
+    constexpr std::size_t rows = 1000;
+    std::vector<int64_t> ts(rows), prices(rows), volumes(rows);
+    std::vector<uint16_t> ids(rows);
+    int64_t t = 1700000000000000000;
+    for (std::size_t i = 0; i < rows; ++i) {
+        ids[i] = static_cast<uint16_t>(i % 3 == 0 ? 0 : i % 7);
+        t += i % 50 == 0 ? 1234567 : 1000000;  // Mostly steady, with gaps
+        ts[i] = t;
+        prices[i] = 4312345 * (ids[i] + 1) + static_cast<int64_t>(i % 11) - 5;
+        volumes[i] = i == 500 ? -1 : static_cast<int64_t>(i * 125000);
+    }
+    // Swings whose deltas and delta-of-deltas overflow int64_t; the codec
+    // computes them modulo 2^64 through uint64_t, so they still round-trip
+    ts[rows - 4] = -4000000000000000000;
+    ts[rows - 3] = 4000000000000000000;
+    ts[rows - 2] = -4000000000000000000;
+    ts[rows - 1] = INT64_MAX;
+    prices[rows - 1] = INT64_MIN;
+    ids[rows - 1] = UINT16_MAX;
+
+    std::vector<uint8_t> encoded{0xAB};  // Encoding appends
+    encode_tick_block({ts.data(), prices.data(), volumes.data(), ids.data(), rows}, encoded);
+    EXPECT_EQ(encoded[0], 0xAB);
+    EXPECT_LT(encoded.size(), rows * 26 / 3);
+
+    std::vector<int64_t> ts_out(rows), prices_out(rows), volumes_out(rows);
+    std::vector<uint16_t> ids_out(rows);
+    ASSERT_TRUE(decode_tick_block(encoded.data() + 1, encoded.size() - 1, rows,
+                                  ts_out.data(), prices_out.data(), volumes_out.data(), ids_out.data()));
+    EXPECT_EQ(ts_out, ts);
+    EXPECT_EQ(prices_out, prices);
+    EXPECT_EQ(volumes_out, volumes);
+    EXPECT_EQ(ids_out, ids);
+
+    // Truncated or padded blocks are rejected
+    EXPECT_FALSE(decode_tick_block(encoded.data() + 1, encoded.size() - 2, rows,
+                                   ts_out.data(), prices_out.data(), volumes_out.data(), ids_out.data()));
+    encoded.push_back(0);
+    EXPECT_FALSE(decode_tick_block(encoded.data() + 1, encoded.size() - 1, rows,
+                                   ts_out.data(), prices_out.data(), volumes_out.data(), ids_out.data()));
+}
+
+TEST(SyntheticFeedTest, SeededAndZipfSkewed) {
+    SyntheticFeedConfig config;
+    config.seed = 7;
+    config.symbols = 50;
+    config.rows = 20000;
+    SyntheticFeed a(config);
+    SyntheticFeed b(config);
+    config.seed = 8;
+    SyntheticFeed other(config);
+
+    std::vector<uint64_t> counts(50);
+    SyntheticTick ta{}, tb{}, to{};
+    int64_t last_ts = INT64_MIN;
+    size_t differing = 0;
+    while (a.next(ta)) {
+        ASSERT_TRUE(b.next(tb));
+        ASSERT_TRUE(other.next(to));
+        EXPECT_EQ(ta.timestamp_ns, tb.timestamp_ns);
+        EXPECT_EQ(ta.symbol, tb.symbol);
+        EXPECT_EQ(ta.price_ticks, tb.price_ticks);
+        EXPECT_EQ(ta.volume, tb.volume);
+        differing += ta.price_ticks != to.price_ticks;
+        EXPECT_GE(ta.timestamp_ns, last_ts);
+        EXPECT_GT(ta.price_ticks, 0);
+        last_ts = ta.timestamp_ns;
+        ++counts[ta.symbol];
+    }
+    EXPECT_EQ(a.generated(), 20000u);
+    EXPECT_GT(differing, 19000u);
+    // Weight 1/k: the top symbol ticks about ten times as often as the tenth
+    EXPECT_GT(counts[0], 6 * counts[9]);
+    EXPECT_LT(counts[0], 15 * counts[9]);
+
+    // reset() replays the same ticks
+    a.reset();
+    b.reset();
+    ASSERT_TRUE(a.next(ta));
+    ASSERT_TRUE(b.next(tb));
+    EXPECT_EQ(ta.price_ticks, tb.price_ticks);
+
+    std::string error;
+    ASSERT_TRUE(SyntheticFeedConfig::parse("seed=42,symbols=500,rate=2e6,rows=0", config, error));
+    EXPECT_EQ(config.seed, 42u);
+    EXPECT_EQ(config.symbols, 500u);
+    EXPECT_EQ(config.rate, 2e6);
+    EXPECT_EQ(config.rows, 0u);
+    EXPECT_FALSE(SyntheticFeedConfig::parse("symbols=0", config, error));
+    EXPECT_FALSE(SyntheticFeedConfig::parse("speed=2", config, error));
+}
+
+namespace {
+
+// Replay test rows; the volume doubles as a row id
+struct TickRow {
+    std::string symbol;
+    int64_t timestamp_ns;
+    double volume;
+};
+
+constexpr int64_t REPLAY_BASE_NS = 1700000000000000000;
+
+int64_t at_ms(double ms) {
+    return REPLAY_BASE_NS + static_cast<int64_t>(ms * 1e6);
+}
+
+market_data::ReplayEngine::TimePoint time_point(int64_t timestamp_ns) {
+    return market_data::ReplayEngine::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(timestamp_ns)));
+}
+
+// count rows of one symbol, step_ms apart, ids 0..count-1
+std::vector<TickRow> sequential_rows(size_t count, double step_ms) {
+    std::vector<TickRow> rows;
+    for (size_t i = 0; i < count; ++i) {
+        rows.push_back({"TEST_SEQ", at_ms(i * step_ms), static_cast<double>(i)});
+    }
+    return rows;
+}
+
+// Tick file under /tmp, removed again on destruction. Small blocks so seeks
+// cross block boundaries.
+class TempTickFile {
+public:
+    TempTickFile(const std::string& name, const std::vector<TickRow>& rows, uint32_t block_rows = 4)
+        : path_("/tmp/" + name + ".bin") {
+        market_data::TickFileWriter writer(path_, block_rows);
+        for (const auto& row : rows) {
+            writer.add(row.symbol, FixedPrice::from_double(100.0, 2), row.volume, row.timestamp_ns);
+        }
+        writer.finish();
+    }
+    ~TempTickFile() { ::unlink(path_.c_str()); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+template<typename Done>
+bool wait_for(Done done, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// Collects the ids replayed by an engine
+struct ReplayRecorder {
+    std::mutex mutex;
+    std::vector<int> ids;
+    std::vector<std::chrono::steady_clock::time_point> times;
+
+    size_t record(const market_data::NormalizedMarketData& row) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids.push_back(static_cast<int>(row.volume));
+        times.push_back(std::chrono::steady_clock::now());
+        return ids.size();
+    }
+};
+
+bool start_engine(market_data::ReplayEngine& engine, const std::string& path, bool streaming, double speed) {
+    if (streaming) {
+        return engine.start_streaming_replay(path, speed);
+    }
+    if (!engine.load_historical_data(path)) {
+        return false;
+    }
+    engine.start_replay(speed);
+    return engine.is_replaying();
+}
+
+} // namespace
+
+TEST(ReplayEngineTest, SeeksForwardAndBackward) {
+    TempTickFile file("test_replay_seek", sequential_rows(20, 1));
+    for (const bool streaming : {true, false}) {
+        SCOPED_TRACE(streaming ? "tick file source" : "in memory");
+        ReplayRecorder recorder;
+        market_data::ReplayEngine engine({}, [&](const market_data::NormalizedMarketData& row) {
+            // Hold the replay at known rows so each seek lands at a known point
+            const size_t replayed = recorder.record(row);
+            if (replayed == 6 || replayed == 9) {
+                engine.pause();
+            }
+        });
+        ASSERT_TRUE(start_engine(engine, file.path(), streaming, market_data::ReplayEngine::AS_FAST_AS_POSSIBLE));
+
+        ASSERT_TRUE(wait_for([&] { return engine.get_current_index() == 6; }));
+        engine.seek(time_point(at_ms(15)));  // Forward, past the next blocks
+        engine.resume();
+        ASSERT_TRUE(wait_for([&] { return engine.get_current_index() == 9; }));
+        engine.seek(time_point(at_ms(3.5)));  // Backward, between rows 3 and 4
+        engine.resume();
+        ASSERT_TRUE(wait_for([&] { return !engine.is_replaying(); }));
+        engine.stop_replay();
+
+        std::vector<int> expected = {0, 1, 2, 3, 4, 5, 15, 16, 17};
+        for (int id = 4; id < 20; ++id) {
+            expected.push_back(id);
+        }
+        EXPECT_EQ(recorder.ids, expected);
+        EXPECT_EQ(engine.get_position(), time_point(at_ms(19)));
+    }
+}
+
+TEST(ReplayEngineTest, RangeStopsBeforeTo) {
+    TempTickFile file("test_replay_range", sequential_rows(20, 1));
+    for (const bool streaming : {true, false}) {
+        SCOPED_TRACE(streaming ? "tick file source" : "in memory");
+        ReplayRecorder recorder;
+        market_data::ReplayEngine engine({}, [&](const market_data::NormalizedMarketData& row) { recorder.record(row); });
+        // to is exclusive: the row stamped exactly at_ms(10) ends the replay
+        engine.set_range(time_point(at_ms(3)), time_point(at_ms(10)));
+        ASSERT_TRUE(start_engine(engine, file.path(), streaming, market_data::ReplayEngine::AS_FAST_AS_POSSIBLE));
+        ASSERT_TRUE(wait_for([&] { return !engine.is_replaying(); }));
+        engine.stop_replay();
+
+        EXPECT_EQ(recorder.ids, (std::vector<int>{3, 4, 5, 6, 7, 8, 9}));
+    }
+}
+
+TEST(ReplayEngineTest, PauseKeepsPendingRow) {
+    TempTickFile file("test_replay_pause", sequential_rows(3, 200));
+    ReplayRecorder recorder;
+    market_data::ReplayEngine engine({}, [&](const market_data::NormalizedMarketData& row) { recorder.record(row); });
+    ASSERT_TRUE(engine.start_streaming_replay(file.path(), 1.0));
+
+    // Pause while row 1 waits for its deadline, and stay paused past it
+    ASSERT_TRUE(wait_for([&] { return engine.get_current_index() == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    engine.pause();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(engine.get_current_index(), 1u);
+
+    const auto resumed = std::chrono::steady_clock::now();
+    engine.resume();
+    ASSERT_TRUE(wait_for([&] { return !engine.is_replaying(); }));
+    engine.stop_replay();
+
+    // The held row goes out first, on a fresh schedule rather than late
+    ASSERT_EQ(recorder.ids, (std::vector<int>{0, 1, 2}));
+    EXPECT_LT(recorder.times[1] - resumed, std::chrono::milliseconds(100));
+    EXPECT_GE(recorder.times[2] - recorder.times[1], std::chrono::milliseconds(190));
+}
+
+TEST(ReplayEngineTest, SpeedChangeReanchorsOnLastRow) {
+    TempTickFile file("test_replay_speed", sequential_rows(4, 1000));
+    ReplayRecorder recorder;
+    market_data::ReplayEngine engine({}, [&](const market_data::NormalizedMarketData& row) {
+        if (recorder.record(row) == 2) {
+            engine.set_speed(10.0);
+        }
+    });
+    ASSERT_TRUE(engine.start_streaming_replay(file.path(), 1000.0));
+    ASSERT_TRUE(wait_for([&] { return !engine.is_replaying(); }));
+    engine.stop_replay();
+
+    // Rows 0 and 1 are 1 ms apart at 1000x. After the change each second of
+    // data takes 100 ms from row 1's deadline; keeping the original anchor
+    // would put row 2 at 200 ms instead.
+    ASSERT_EQ(recorder.ids, (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_LT(recorder.times[1] - recorder.times[0], std::chrono::milliseconds(50));
+    EXPECT_GE(recorder.times[2] - recorder.times[1], std::chrono::milliseconds(90));
+    EXPECT_LT(recorder.times[2] - recorder.times[1], std::chrono::milliseconds(180));
+    EXPECT_GE(recorder.times[3] - recorder.times[2], std::chrono::milliseconds(90));
+    EXPECT_LT(recorder.times[3] - recorder.times[2], std::chrono::milliseconds(180));
+}
+
+namespace {
+
+// rows of eight symbols round-robin, one per millisecond, split over two files
+// by parity so the reader also merges
+struct ParallelReplayRows {
+    static constexpr size_t ROWS = 400;
+    static constexpr size_t SYMBOLS = 8;
+    std::vector<TickRow> even, odd;
+
+    ParallelReplayRows() {
+        for (size_t i = 0; i < ROWS; ++i) {
+            TickRow row{"TEST_PAR" + std::to_string(i % SYMBOLS), at_ms(static_cast<double>(i)),
+                        static_cast<double>(i)};
+            (i % 2 == 0 ? even : odd).push_back(row);
+        }
+    }
+};
+
+} // namespace
+
+TEST(ParallelReplayTest, KeepsSymbolOrderAndEpochBarriers) {
+    const ParallelReplayRows rows;
+    TempTickFile even("test_parallel_even", rows.even, 16);
+    TempTickFile odd("test_parallel_odd", rows.odd, 16);
+
+    struct Delivery {
+        size_t worker;
+        std::string symbol;
+        int64_t timestamp_ns;
+        int id;
+    };
+    std::mutex mutex;
+    std::vector<Delivery> deliveries;  // In delivery order over all workers
+    market_data::ParallelReplay replay([&](size_t worker) {
+        market_data::ParallelReplay::Sink sink;
+        sink.on_message = [&, worker](const market_data::NormalizedMarketData& row) {
+            std::lock_guard<std::mutex> lock(mutex);
+            deliveries.push_back({worker, row.symbol,
+                                  std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      row.timestamp.time_since_epoch()).count(),
+                                  static_cast<int>(row.volume)});
+        };
+        return sink;
+    });
+
+    constexpr int64_t interval_ns = 10000000;  // 10 rows per epoch
+    ASSERT_TRUE(replay.start({even.path(), odd.path()}, 3, market_data::ReplayEngine::AS_FAST_AS_POSSIBLE,
+                             std::chrono::nanoseconds(interval_ns)));
+    ASSERT_TRUE(wait_for([&] { return !replay.is_replaying(); }));
+    replay.stop();
+
+    ASSERT_EQ(deliveries.size(), ParallelReplayRows::ROWS);
+    EXPECT_EQ(replay.get_barriers(), ParallelReplayRows::ROWS / 10 - 1);
+    std::map<std::string, int> last_id;
+    std::map<std::string, size_t> worker_of;
+    int64_t epoch = 0;
+    for (const auto& delivery : deliveries) {
+        // Each symbol stays on one worker, in file order
+        const auto last = last_id.find(delivery.symbol);
+        if (last != last_id.end()) {
+            EXPECT_GT(delivery.id, last->second) << delivery.symbol;
+            EXPECT_EQ(delivery.worker, worker_of[delivery.symbol]) << delivery.symbol;
+        }
+        last_id[delivery.symbol] = delivery.id;
+        worker_of.emplace(delivery.symbol, delivery.worker);
+        // No row of epoch k+1 goes out before every row of epoch k
+        const int64_t row_epoch = (delivery.timestamp_ns - at_ms(0)) / interval_ns;
+        EXPECT_GE(row_epoch, epoch) << "row " << delivery.id;
+        epoch = std::max(epoch, row_epoch);
+    }
+    EXPECT_EQ(last_id.size(), ParallelReplayRows::SYMBOLS);
+    const auto per_worker = replay.get_worker_messages();
+    ASSERT_EQ(per_worker.size(), 3u);
+    EXPECT_EQ(per_worker[0] + per_worker[1] + per_worker[2], ParallelReplayRows::ROWS);
+}
+
+TEST(ParallelReplayTest, StopReleasesWorkersAtBarrier) {
+    const ParallelReplayRows rows;
+    TempTickFile even("test_parallel_stop", rows.even, 16);
+
+    // Worker 0 holds its first row until released, so the other workers
+    // reach the end of the first epoch and wait there for it
+    std::atomic<bool> release{false};
+    std::vector<std::atomic<int>> flushes(3);
+    market_data::ParallelReplay replay([&](size_t worker) {
+        market_data::ParallelReplay::Sink sink;
+        sink.on_message = [&, worker](const market_data::NormalizedMarketData&) {
+            while (worker == 0 && !release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        };
+        // Unpaced workers flush only before a barrier and when they finish
+        sink.flush = [&, worker] { ++flushes[worker]; };
+        return sink;
+    });
+    // Let worker 0 go however the test ends, or the destructor's stop() would wait on it
+    struct Release {
+        std::atomic<bool>& flag;
+        ~Release() { flag = true; }
+    } release_on_exit{release};
+    ASSERT_TRUE(replay.start({even.path()}, 3, market_data::ReplayEngine::AS_FAST_AS_POSSIBLE,
+                             std::chrono::milliseconds(10)));
+    ASSERT_TRUE(wait_for([&] { return flushes[1] == 1 && flushes[2] == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(replay.get_barriers(), 0u);
+
+    auto stopped = std::async(std::launch::async, [&] { replay.stop(); });
+    EXPECT_TRUE(wait_for([&] { return !replay.is_replaying(); }));
+    // The waiting workers leave the barrier and finish without worker 0
+    EXPECT_TRUE(wait_for([&] { return flushes[1] == 2 && flushes[2] == 2; }));
+    EXPECT_EQ(replay.get_barriers(), 0u);
+    release = true;
+    EXPECT_EQ(stopped.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_GT(replay.get_worker_messages()[1] + replay.get_worker_messages()[2], 0u);
+}
+
+TEST(MergedSourceTest, MergesByTimestampThenFileThenPosition) {
+    // ids are file * 10 + position in the file
+    TempTickFile a("test_merge_a", {{"TEST_A", at_ms(1), 0}, {"TEST_A", at_ms(3), 1}, {"TEST_A", at_ms(3), 2},
+                                    {"TEST_A", at_ms(5), 3}}, 2);
+    TempTickFile b("test_merge_b", {{"TEST_B", at_ms(2), 10}, {"TEST_B", at_ms(3), 11}, {"TEST_B", at_ms(6), 12}}, 2);
+    TempTickFile c("test_merge_c", {{"TEST_C", at_ms(3), 20}, {"TEST_C", at_ms(4), 21}}, 2);
+    std::vector<std::unique_ptr<market_data::ReplaySource>> sources;
+    for (const auto* file : {&a, &b, &c}) {
+        sources.push_back(std::make_unique<market_data::TickFileSource>(file->path()));
+    }
+    market_data::MergedSource merged(std::move(sources));
+    EXPECT_EQ(merged.total_rows(), 9u);
+
+    auto read = [&merged](size_t limit) {
+        std::vector<int> ids;
+        market_data::NormalizedMarketData row;
+        while (ids.size() < limit && merged.next(row)) {
+            ids.push_back(static_cast<int>(row.volume));
+        }
+        return ids;
+    };
+    // Ties at 3 ms go to the earlier file, then the earlier row in the file
+    EXPECT_EQ(read(SIZE_MAX), (std::vector<int>{0, 10, 1, 2, 11, 20, 21, 3, 12}));
+
+    // Seeking rebuilds the heap from every input, backwards and forwards
+    merged.seek(at_ms(3));
+    EXPECT_EQ(read(3), (std::vector<int>{1, 2, 11}));
+    merged.seek(at_ms(4.5));
+    EXPECT_EQ(read(SIZE_MAX), (std::vector<int>{3, 12}));
+    merged.seek(at_ms(0));
+    EXPECT_EQ(read(2), (std::vector<int>{0, 10}));
+    merged.seek(at_ms(7));
+    EXPECT_EQ(read(SIZE_MAX), std::vector<int>{});
+}
+
+namespace {
+
+// Text file under /tmp, removed again on destruction
+class TempTextFile {
+public:
+    TempTextFile(const std::string& name, const std::string& content) : path_("/tmp/" + name) {
+        std::ofstream(path_) << content;
+    }
+    ~TempTextFile() { ::unlink(path_.c_str()); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+std::string ndjson_row(const std::string& symbol, double price, int volume, int64_t timestamp_ms) {
+    return "{\"symbol\":\"" + symbol + "\",\"price\":" + std::to_string(price) + ",\"volume\":" +
+           std::to_string(volume) + ",\"timestamp\":" + std::to_string(timestamp_ms) + "}\n";
+}
+
+} // namespace
+
+TEST(TickLoaderTest, StreamsNdjsonAndJsonArrays) {
+    TempTextFile ndjson("test_loader.ndjson",
+                        ndjson_row("TEST_LOAD", 101.25, 0, 1700000000000) +
+                        "{\"symbol\":\"TEST_LOAD\",\"price\":\n" +                       // Malformed line
+                        "{\"symbol\":\"TEST_LOAD\",\"volume\":1,\"timestamp\":1}\n" +     // No price
+                        "\n" +
+                        "{\"symbol\":\"TEST_LOAD\",\"price\":102.5,\"volume\":2,\"timestamp\":1700000000001,"
+                        "\"source\":\"FEED\",\"extra\":{\"price\":1}}\n");
+    std::vector<market_data::NormalizedMarketData> rows;
+    auto result = market_data::TickLoader::load(ndjson.path(), [&](market_data::NormalizedMarketData& row) {
+        rows.push_back(row);
+        return true;
+    });
+    EXPECT_TRUE(result.ok);
+    EXPECT_EQ(result.loaded, 2u);
+    EXPECT_EQ(result.rejected, 2u);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0].symbol, "TEST_LOAD");
+    EXPECT_DOUBLE_EQ(rows[0].price.to_double(), 101.25);
+    EXPECT_EQ(rows[0].source, "REPLAY");
+    EXPECT_EQ(rows[0].timestamp, time_point(1700000000000000000));
+    EXPECT_DOUBLE_EQ(rows[1].price.to_double(), 102.5);  // Nested fields are ignored
+    EXPECT_EQ(rows[1].volume, 2.0);
+    EXPECT_EQ(rows[1].source, "FEED");
+
+    TempTextFile array("test_loader.json",
+                       "  [" + ndjson_row("TEST_LOAD", 1.5, 0, 1) + "," + ndjson_row("TEST_LOAD", 2.5, 1, 2) + "," +
+                       ndjson_row("TEST_LOAD", 3.5, 2, 3) + "]");
+    rows.clear();
+    result = market_data::TickLoader::load(array.path(), [&](market_data::NormalizedMarketData& row) {
+        rows.push_back(row);
+        return rows.size() < 2;  // Stop early
+    });
+    EXPECT_TRUE(result.ok);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_DOUBLE_EQ(rows[1].price.to_double(), 2.5);
+
+    result = market_data::TickLoader::load("/tmp/test_loader_missing.ndjson",
+                                           [](market_data::NormalizedMarketData&) { return true; });
+    EXPECT_FALSE(result.ok);
+}
+
+TEST(TextFileSourceTest, StreamsWithBoundedReadAheadAndSeeks) {
+    constexpr int rows = 1000;
+    std::string content;
+    for (int i = 0; i < rows; ++i) {
+        content += ndjson_row("TEST_TEXT", 100.0, i, 1700000000000 + i);
+    }
+    TempTextFile file("test_text_source.ndjson", content);
+    auto source = market_data::ReplaySource::open(file.path(), 8);
+    ASSERT_NE(source, nullptr);
+
+    // The loader runs at most read_ahead rows ahead of the reader
+    ASSERT_TRUE(wait_for([&] { return source->total_rows() >= 8; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_LE(source->total_rows(), 9u);
+
+    auto next_id = [&source] {
+        market_data::NormalizedMarketData row;
+        return source->next(row) ? static_cast<int>(row.volume) : -1;
+    };
+    for (int i = 0; i < 500; ++i) {
+        ASSERT_EQ(next_id(), i);
+    }
+    // Backwards re-parses from the start; forwards keeps reading. Either way
+    // the caller skips rows before the target.
+    source->seek(at_ms(100));
+    EXPECT_EQ(next_id(), 0);
+    source->seek(at_ms(900));
+    EXPECT_EQ(next_id(), 1);
+    int id = next_id();
+    while (id >= 0 && id < 998) {
+        id = next_id();
+    }
+    EXPECT_EQ(id, 998);
+    EXPECT_EQ(next_id(), 999);
+    EXPECT_EQ(next_id(), -1);
+    EXPECT_FALSE(source->loading());
+    EXPECT_EQ(source->total_rows(), static_cast<size_t>(rows));
+    source->close();
+}
+
+TEST(TickFileTest, RoundTripsRawAndCompressedBlocks) {
+    const std::vector<std::pair<std::string, uint8_t>> symbols = {{"TEST_TF2", 2}, {"TEST_TF4", 4}, {"TEST_TF0", 0}};
+    std::vector<market_data::NormalizedMarketData> rows(1000);
+    int64_t timestamp_ns = REPLAY_BASE_NS;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& [symbol, decimals] = symbols[i * 7 % symbols.size()];
+        timestamp_ns += i % 100 == 0 ? 3000000000 : 250000;
+        rows[i].symbol = symbol;
+        rows[i].price = FixedPrice(1000000 + static_cast<int64_t>(i % 17) - 8, decimals);
+        rows[i].volume = i * 0.5;
+        rows[i].timestamp = time_point(timestamp_ns);
+        rows[i].source = "REPLAY";
+    }
+
+    uint64_t block_bytes[2] = {};
+    for (const auto encoding : {market_data::tick_file::BlockEncoding::RAW,
+                                market_data::tick_file::BlockEncoding::COMPRESSED}) {
+        const std::string path = "/tmp/test_tick_file.bin";
+        {
+            market_data::TickFileWriter writer(path, 64, encoding);
+            for (const auto& row : rows) {
+                writer.add(row);
+            }
+            EXPECT_TRUE(writer.sorted());
+            writer.finish();
+        }
+        {
+            market_data::TickFile file(path);
+            EXPECT_TRUE(file.sorted());
+            EXPECT_EQ(file.row_count(), rows.size());
+            EXPECT_EQ(file.block_count(), (rows.size() + 63) / 64);
+            EXPECT_EQ(file.symbol_count(), symbols.size());
+            EXPECT_EQ(file.first_timestamp_ns(), std::chrono::nanoseconds(rows.front().timestamp.time_since_epoch()).count());
+            EXPECT_EQ(file.last_timestamp_ns(), timestamp_ns);
+            block_bytes[encoding == market_data::tick_file::BlockEncoding::COMPRESSED] = file.block_bytes();
+        }
+
+        market_data::TickFileSource source(path);
+        market_data::NormalizedMarketData row;
+        for (const auto& expected : rows) {
+            ASSERT_TRUE(source.next(row));
+            EXPECT_EQ(row.symbol, expected.symbol);
+            EXPECT_EQ(row.price, expected.price);
+            EXPECT_EQ(row.volume, expected.volume);
+            EXPECT_EQ(row.timestamp, expected.timestamp);
+        }
+        EXPECT_FALSE(source.next(row));
+
+        // Seeks land on the first row at or after the target, inside a block
+        source.seek(std::chrono::nanoseconds(rows[500].timestamp.time_since_epoch()).count() - 1);
+        ASSERT_TRUE(source.next(row));
+        EXPECT_EQ(row.volume, rows[500].volume);
+        source.seek(timestamp_ns + 1);
+        EXPECT_FALSE(source.next(row));
+        ::unlink(path.c_str());
+    }
+    EXPECT_LT(block_bytes[1] * 3, block_bytes[0]);
+}
+
+TEST(TickFileTest, FlagsOutOfOrderRowsAndSeeksByScan) {
+    // Timestamps in file order, ids 0..6
+    const std::vector<double> order_ms = {5, 1, 7, 3, 9, 2, 8};
+    std::vector<TickRow> rows;
+    for (size_t i = 0; i < order_ms.size(); ++i) {
+        rows.push_back({"TEST_UNSORTED", at_ms(order_ms[i]), static_cast<double>(i)});
+    }
+    TempTickFile file("test_tick_unsorted", rows, 2);
+    {
+        market_data::TickFile tick_file(file.path());
+        EXPECT_FALSE(tick_file.sorted());
+        EXPECT_EQ(tick_file.first_timestamp_ns(), at_ms(1));
+        EXPECT_EQ(tick_file.last_timestamp_ns(), at_ms(9));
+    }
+
+    // A seek returns the first row in file order at or after the target
+    market_data::TickFileSource source(file.path());
+    market_data::NormalizedMarketData row;
+    for (const auto& [target_ms, id] : std::vector<std::pair<double, int>>{{6, 2}, {4, 0}, {8.5, 4}, {1, 0}}) {
+        source.seek(at_ms(target_ms));
+        ASSERT_TRUE(source.next(row)) << target_ms;
+        EXPECT_EQ(static_cast<int>(row.volume), id) << target_ms;
+    }
+    source.seek(at_ms(10));
+    EXPECT_FALSE(source.next(row));
+}
+
+TEST(TickFileTest, DiscardLeavesNoFile) {
+    const std::string path = "/tmp/test_tick_discard.bin";
+    market_data::TickFileWriter writer(path);
+    writer.add("TEST_DISCARD", FixedPrice::from_double(1.0, 2), 1.0, REPLAY_BASE_NS);
+    writer.discard();
+    EXPECT_NE(::access(path.c_str(), F_OK), 0);
+    EXPECT_FALSE(market_data::TickFile::is_tick_file(path));
+}
+
+TEST(TickFileTest, RejectsOversizedBlocks) {
+    TempTickFile file("test_tick_bounds", sequential_rows(10, 1), 4);
+    market_data::tick_file::Header header{};
+    {
+        std::ifstream in(file.path(), std::ios::binary);
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    auto rewrite = [&](std::streamoff offset, auto value) {
+        std::fstream out(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(offset);
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    const auto row_count_offset = static_cast<std::streamoff>(
+        header.index_offset + offsetof(market_data::tick_file::BlockIndexEntry, row_count));
+    const auto header_rows_offset = static_cast<std::streamoff>(offsetof(market_data::tick_file::Header, row_count));
+
+    // The last block's entry claims more rows than a block holds, with the
+    // header total to match; that would size the decode buffers from
+    // untrusted input
+    const auto last_row_count_offset = static_cast<std::streamoff>(
+        row_count_offset + (header.block_count - 1) * sizeof(market_data::tick_file::BlockIndexEntry));
+    rewrite(last_row_count_offset, uint32_t{5000000});
+    rewrite(header_rows_offset, uint64_t{10 - 2 + 5000000});
+    EXPECT_THROW(market_data::TickFile{file.path()}, std::runtime_error);
+    rewrite(last_row_count_offset, uint32_t{2});
+    rewrite(header_rows_offset, uint64_t{10});
+    EXPECT_NO_THROW(market_data::TickFile{file.path()});
+    rewrite(static_cast<std::streamoff>(offsetof(market_data::tick_file::Header, block_rows)), UINT32_MAX);
+    EXPECT_THROW(market_data::TickFile{file.path()}, std::runtime_error);
+}
+
+TEST(TickFileTest, RejectsWrappingOffsetsAndMissingSymbols) {
+    TempTickFile file("test_tick_wrap", sequential_rows(10, 1), 4);
+    using market_data::tick_file::Header;
+    using market_data::tick_file::BlockIndexEntry;
+    Header header{};
+    BlockIndexEntry first_block{};
+    {
+        std::ifstream in(file.path(), std::ios::binary);
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        in.seekg(static_cast<std::streamoff>(header.index_offset));
+        in.read(reinterpret_cast<char*>(&first_block), sizeof(first_block));
+    }
+    auto rewrite = [&](std::streamoff offset, auto value) {
+        std::fstream out(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(offset);
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    // Offsets this close to 2^64 wrap back into the file once the section size is added
+    const auto symbols_offset = static_cast<std::streamoff>(offsetof(Header, symbols_offset));
+    rewrite(symbols_offset, uint64_t{0} - header.symbol_count * sizeof(market_data::tick_file::SymbolEntry));
+    EXPECT_THROW(market_data::TickFile{file.path()}, std::runtime_error);
+    rewrite(symbols_offset, header.symbols_offset);
+
+    const auto block_offset = static_cast<std::streamoff>(header.index_offset + offsetof(BlockIndexEntry, offset));
+    const auto block_size = static_cast<std::streamoff>(header.index_offset + offsetof(BlockIndexEntry, encoded_size));
+    rewrite(block_offset, uint64_t{0} - market_data::tick_file::ALIGNMENT);
+    rewrite(block_size, uint32_t{2 * market_data::tick_file::ALIGNMENT});
+    EXPECT_THROW(market_data::TickFile{file.path()}, std::runtime_error);
+    rewrite(block_offset, first_block.offset);
+    rewrite(block_size, first_block.encoded_size);
+    EXPECT_NO_THROW(market_data::TickFile{file.path()});
+
+    // Rows need a symbol to resolve to
+    rewrite(static_cast<std::streamoff>(offsetof(Header, symbol_count)), uint32_t{0});
+    EXPECT_THROW(market_data::TickFile{file.path()}, std::runtime_error);
+}
+
+namespace {
+
+// Empty directory under /tmp for a CaptureRecorder, removed on destruction
+class TempCaptureDir {
+public:
+    explicit TempCaptureDir(const std::string& name) : path_("/tmp/" + name) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directory(path_);
+    }
+    ~TempCaptureDir() { std::filesystem::remove_all(path_); }
+
+    const std::string& path() const { return path_; }
+
+    // Names in the directory ending in suffix, sorted
+    std::vector<std::string> files(const std::string& suffix) const {
+        std::vector<std::string> names;
+        for (const auto& entry : std::filesystem::directory_iterator(path_)) {
+            const std::string name = entry.path().filename().string();
+            if (name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                names.push_back(name);
+            }
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+private:
+    std::string path_;
+};
+
+market_data::CaptureRecorder::Options capture_options(const TempCaptureDir& dir) {
+    market_data::CaptureRecorder::Options options;
+    options.directory = dir.path();
+    options.prefix = "test";
+    options.block_rows = 4;
+    return options;
+}
+
+// Hand one tick to the recorder as the bus consumer would; the volume doubles as a row id
+void capture_tick(market_data::CaptureRecorder& recorder, const char* symbol, int64_t timestamp_ns, double volume) {
+    WireRecord record{};
+    set_header(record, symbol, "TEST_FEED", timestamp_ns);
+    recorder(record, TickBody{encode_price(record, 100.25), to_fixed(volume, WireRecord::VOLUME_SCALE)},
+             PipelineStamps{});
+}
+
+uint64_t file_rows(const TempCaptureDir& dir, const std::vector<std::string>& names) {
+    uint64_t rows = 0;
+    for (const auto& name : names) {
+        rows += market_data::TickFile(dir.path() + "/" + name).row_count();
+    }
+    return rows;
+}
+
+} // namespace
+
+TEST(CaptureRecorderTest, RollsBySizeIntoFinishedFiles) {
+    TempCaptureDir dir("test_capture_size");
+    auto options = capture_options(dir);
+    options.roll_bytes = 1;  // Any row fills a file
+    market_data::CaptureRecorder recorder(options);
+    for (int i = 0; i < 5; ++i) {
+        capture_tick(recorder, "TEST_CAP", at_ms(i), i);
+    }
+    recorder.stop();
+
+    EXPECT_EQ(recorder.recorded(), 5u);
+    EXPECT_EQ(recorder.dropped(), 0u);
+    EXPECT_EQ(recorder.files(), 5u);
+    // Every .part was renamed once finished
+    EXPECT_TRUE(dir.files(".part").empty());
+    const auto names = dir.files(".bin");
+    ASSERT_EQ(names.size(), 5u);
+    for (const auto& name : names) {
+        EXPECT_EQ(market_data::TickFile(dir.path() + "/" + name).row_count(), 1u) << name;
+    }
+}
+
+TEST(CaptureRecorderTest, RollsByAgeWhileRunning) {
+    TempCaptureDir dir("test_capture_age");
+    auto options = capture_options(dir);
+    options.roll_interval = std::chrono::seconds(0);  // Roll after every write
+    market_data::CaptureRecorder recorder(options);
+
+    // Finished without stop(): the writer rolls on age alone
+    for (int i = 0; i < 3; ++i) {
+        capture_tick(recorder, "TEST_CAP", at_ms(i), i);
+    }
+    ASSERT_TRUE(wait_for([&] { return recorder.files() == 1; }));
+    EXPECT_EQ(dir.files(".bin").size(), 1u);
+    EXPECT_EQ(file_rows(dir, dir.files(".bin")), 3u);
+
+    capture_tick(recorder, "TEST_CAP", at_ms(3), 3);
+    ASSERT_TRUE(wait_for([&] { return recorder.files() == 2; }));
+    recorder.stop();
+    EXPECT_EQ(recorder.files(), 2u);
+    EXPECT_EQ(file_rows(dir, dir.files(".bin")), 4u);
+    EXPECT_TRUE(dir.files(".part").empty());
+}
+
+TEST(CaptureRecorderTest, NeverReplacesExistingFiles) {
+    TempCaptureDir dir("test_capture_existing");
+    // Take the first name of every millisecond around now, as .bin and as .part
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<std::string> taken;
+    for (int64_t ms = now_ms; ms < now_ms + 500; ++ms) {
+        taken.push_back(dir.path() + "/test-" + std::to_string(ms) + "-0.bin" + (ms % 2 ? ".part" : ""));
+        std::ofstream(taken.back()) << "keep";
+    }
+
+    auto options = capture_options(dir);
+    options.roll_bytes = 1;
+    market_data::CaptureRecorder recorder(options);
+    capture_tick(recorder, "TEST_CAP", at_ms(0), 0);
+    capture_tick(recorder, "TEST_CAP", at_ms(1), 1);
+    recorder.stop();
+
+    EXPECT_EQ(recorder.files(), 2u);
+    EXPECT_EQ(recorder.dropped(), 0u);
+    for (const auto& path : taken) {
+        std::ifstream in(path);
+        std::string content;
+        in >> content;
+        EXPECT_EQ(content, "keep") << path;
+    }
+    EXPECT_EQ(dir.files(".bin").size(), 250u + 2);
+}
+
+TEST(CaptureRecorderTest, DropsRowsBeyondMaxPendingAndAfterStop) {
+    TempCaptureDir dir("test_capture_pending");
+    auto options = capture_options(dir);
+    options.max_pending = 5;
+    market_data::CaptureRecorder recorder(options);
+    // Far faster than the writer's poll, so most find the pending buffer full
+    for (int i = 0; i < 1000; ++i) {
+        capture_tick(recorder, "TEST_CAP", at_ms(i), i);
+    }
+    recorder.stop();
+    EXPECT_GT(recorder.dropped(), 0u);
+    EXPECT_EQ(recorder.recorded() + recorder.dropped(), 1000u);
+    EXPECT_EQ(file_rows(dir, dir.files(".bin")), recorder.recorded());
+
+    const uint64_t dropped = recorder.dropped();
+    capture_tick(recorder, "TEST_CAP", at_ms(1000), 1000);
+    EXPECT_EQ(recorder.dropped(), dropped + 1);
+}
+
+TEST(CaptureRecorderTest, CaptureReplaysThroughReplayEngine) {
+    TempCaptureDir dir("test_capture_replay");
+    market_data::CaptureRecorder recorder(capture_options(dir));
+    for (int i = 0; i < 50; ++i) {
+        capture_tick(recorder, i % 2 ? "TEST_CAP_B" : "TEST_CAP_A", at_ms(i), i);
+    }
+    recorder.stop();
+    const auto names = dir.files(".bin");
+    ASSERT_EQ(names.size(), 1u);
+
+    ReplayRecorder replayed;
+    std::vector<std::string> symbols;
+    market_data::ReplayEngine engine({}, [&](const market_data::NormalizedMarketData& row) {
+        std::lock_guard<std::mutex> lock(replayed.mutex);
+        replayed.ids.push_back(static_cast<int>(row.volume));
+        symbols.push_back(row.symbol);
+        EXPECT_EQ(row.price, FixedPrice::from_double(100.25, row.price.decimals()));
+        EXPECT_EQ(row.timestamp, time_point(at_ms(row.volume)));
+    });
+    ASSERT_TRUE(start_engine(engine, dir.path() + "/" + names.front(), true,
+                             market_data::ReplayEngine::AS_FAST_AS_POSSIBLE));
+    ASSERT_TRUE(wait_for([&] {
+        std::lock_guard<std::mutex> lock(replayed.mutex);
+        return replayed.ids.size() == 50;
+    }));
+    engine.stop_replay();
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(replayed.ids[i], i);
+        EXPECT_EQ(symbols[i], i % 2 ? "TEST_CAP_B" : "TEST_CAP_A");
+    }
+}
+
+TEST(PacingTest, WaitsUntilDeadlineOrInterrupt) {
+    using Clock = std::chrono::steady_clock;
+    auto never = [] { return false; };
+
+    // Long waits sleep in slices and spin the last stretch: never early
+    const auto deadline = Clock::now() + std::chrono::milliseconds(120);
+    EXPECT_TRUE(market_data::pacing::wait_until(deadline, never));
+    const auto woke = Clock::now();
+    EXPECT_GE(woke, deadline);
+    EXPECT_LT(woke - deadline, std::chrono::milliseconds(20));
+
+    // Deadlines already passed return at once
+    const auto start = Clock::now();
+    EXPECT_TRUE(market_data::pacing::wait_until(start - std::chrono::seconds(1), never));
+    EXPECT_LT(Clock::now() - start, std::chrono::milliseconds(5));
+
+    // An interrupt is seen within one sleep slice, however far the deadline
+    std::atomic<bool> interrupted{false};
+    std::thread interrupter([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        interrupted = true;
+    });
+    const auto interrupted_at = Clock::now();
+    EXPECT_FALSE(market_data::pacing::wait_until(interrupted_at + std::chrono::seconds(10),
+                                                 [&] { return interrupted.load(); }));
+    EXPECT_LT(Clock::now() - interrupted_at, std::chrono::milliseconds(20) + market_data::pacing::MAX_SLEEP * 2);
+    interrupter.join();
+}
+
+TEST(ReplayEngineTest, PacesRowsAgainstAbsoluteDeadlines) {
+    // 50 rows 2 ms apart at real time: the last row is due 98 ms after the
+    // first, and per-row sleep error must not add up. Times are taken after
+    // the first row's own (small) drift, hence the slack.
+    TempTickFile file("test_replay_pacing", sequential_rows(50, 2), 16);
+    ReplayRecorder recorder;
+    market_data::ReplayEngine engine({}, [&](const market_data::NormalizedMarketData& row) { recorder.record(row); });
+    ASSERT_TRUE(engine.start_streaming_replay(file.path(), 1.0));
+    ASSERT_TRUE(wait_for([&] { return !engine.is_replaying(); }));
+    engine.stop_replay();
+
+    ASSERT_EQ(recorder.ids.size(), 50u);
+    const auto elapsed = recorder.times.back() - recorder.times.front();
+    const auto slack = std::chrono::microseconds(100);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(98) - slack);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(115));
+    for (size_t i = 1; i < recorder.times.size(); ++i) {
+        EXPECT_GE(recorder.times[i] - recorder.times.front(), std::chrono::milliseconds(2 * i) - slack) << i;
+    }
+    const auto stats = engine.get_pacing_stats();
+    EXPECT_EQ(stats.messages, 50u);
+    EXPECT_LT(stats.mean_drift_ns, 2000000);
+}
+
+namespace {
+
+// Bus for replay publishing tests, removed again on destruction
+class ReplayBus {
+public:
+    static constexpr const char* NAME = "test_replay_bus";
+
+    ReplayBus() {
+        SharedMemory::remove(NAME);
+        const size_t ring_buffer_size = sizeof(RingBuffer<MessageWrapper, MessageBus::DEFAULT_RING_BUFFER_SIZE>);
+        bus = std::make_shared<MessageBus>(NAME, (ring_buffer_size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE);
+    }
+    ~ReplayBus() {
+        bus.reset();
+        SharedMemory::remove(NAME);
+    }
+
+    std::shared_ptr<MessageBus> bus;
+};
+
+// Collects tick ids (volumes) in ring order
+struct TickIdVisitor {
+    std::vector<int> ids;
+
+    void operator()(const WireRecord&, const TickBody& body, const PipelineStamps&) {
+        ids.push_back(static_cast<int>(body.volume / WireRecord::VOLUME_SCALE));
+    }
+};
+
+} // namespace
+
+TEST(ReplayPublisherTest, UnpacedReplayWaitsForRingSpaceWithoutLoss) {
+    constexpr size_t rows = 5000;  // Several times the ring
+    TempTickFile file("test_publish_replay", sequential_rows(rows, 0.01), 256);
+    ReplayBus replay_bus;
+    std::atomic<bool> should_continue{true};
+    std::atomic<bool> stopping{false};
+    market_data::ReplayPublisher publisher(replay_bus.bus, should_continue, stopping, 64);
+    market_data::ReplayEngine engine({}, [&](const market_data::NormalizedMarketData& row) { publisher(row); });
+    engine.set_flush_callback([&] { publisher.flush(); });
+    ASSERT_TRUE(engine.start_streaming_replay(file.path(), market_data::ReplayEngine::AS_FAST_AS_POSSIBLE));
+
+    // With no consumer yet the ring fills and the replay waits instead of dropping
+    ASSERT_TRUE(wait_for([&] { return replay_bus.bus->get_backpressure_waits() > 0; }));
+    EXPECT_TRUE(engine.is_replaying());
+
+    TickIdVisitor visitor;
+    std::thread consumer([&] { replay_bus.bus->process_messages(should_continue, visitor); });
+    ASSERT_TRUE(wait_for([&] { return !engine.is_replaying(); }));
+    engine.stop_replay();
+    EXPECT_TRUE(wait_for([&] { return replay_bus.bus->get_processed_count() == rows; }));
+    should_continue = false;
+    consumer.join();
+
+    EXPECT_EQ(publisher.published(), rows);
+    EXPECT_EQ(replay_bus.bus->get_dropped_count(), 0u);
+    ASSERT_EQ(visitor.ids.size(), rows);
+    for (size_t i = 0; i < rows; ++i) {
+        ASSERT_EQ(visitor.ids[i], static_cast<int>(i));
+    }
+}
+
+TEST(ReplayPublisherTest, StoppingReleasesPublisherBlockedOnFullRing) {
+    TempTickFile file("test_publish_stop", sequential_rows(3000, 0.01), 256);
+    ReplayBus replay_bus;
+    std::atomic<bool> should_continue{true};  // The consumer is alive but stalled
+    std::atomic<bool> stopping{false};
+    market_data::ReplayPublisher publisher(replay_bus.bus, should_continue, stopping, 64);
+    market_data::ReplayEngine engine({}, [&](const market_data::NormalizedMarketData& row) { publisher(row); });
+    engine.set_flush_callback([&] { publisher.flush(); });
+    ASSERT_TRUE(engine.start_streaming_replay(file.path(), market_data::ReplayEngine::AS_FAST_AS_POSSIBLE));
+    ASSERT_TRUE(wait_for([&] { return replay_bus.bus->get_backpressure_waits() > 0; }));
+
+    stopping = true;
+    auto stopped = std::async(std::launch::async, [&] { engine.stop_replay(); });
+    EXPECT_EQ(stopped.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    should_continue = false;  // Lets a stuck publisher go so a failure does not hang
+    stopped.wait();
+    EXPECT_EQ(publisher.published(), replay_bus.bus->get_capacity());
+    EXPECT_EQ(replay_bus.bus->get_size(), replay_bus.bus->get_capacity());
+}
+
+namespace {
+
+// Blocking producer for IngestGateway tests; reads time out instead of hanging
+class IngestClient {
+public:
+    explicit IngestClient(unsigned short port) : socket_(ioc_) {
+        socket_.connect({boost::asio::ip::make_address("127.0.0.1"), port});
+        socket_.set_option(boost::asio::ip::tcp::no_delay(true));
+    }
+
+    // chunk > 0 writes the bytes that many at a time, pausing in between so
+    // the gateway sees the frames split across reads
+    void send(const std::vector<char>& bytes, size_t chunk = 0) {
+        if (chunk == 0) {
+            boost::asio::write(socket_, boost::asio::buffer(bytes));
+            return;
+        }
+        for (size_t offset = 0; offset < bytes.size(); offset += chunk) {
+            boost::asio::write(socket_, boost::asio::buffer(bytes.data() + offset, std::min(chunk, bytes.size() - offset)));
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    // Next CREDIT frame, or nullopt if none arrives in time
+    std::optional<wire::CreditGrant> read_credit(std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) {
+        char frame[sizeof(wire::FrameHeader) + sizeof(wire::CreditGrant)];
+        bool done = false;
+        boost::system::error_code error;
+        boost::asio::async_read(socket_, boost::asio::buffer(frame), [&](boost::system::error_code ec, size_t) {
+            error = ec;
+            done = true;
+        });
+        ioc_.restart();
+        ioc_.run_for(timeout);
+        if (!done) {
+            socket_.cancel();
+            ioc_.restart();
+            ioc_.run();
+            return std::nullopt;
+        }
+        wire::FrameHeader header;
+        wire::CreditGrant grant;
+        std::memcpy(&header, frame, sizeof(header));
+        std::memcpy(&grant, frame + sizeof(header), sizeof(grant));
+        if (error || header.type != static_cast<uint16_t>(wire::FrameType::CREDIT)) {
+            return std::nullopt;
+        }
+        return grant;
+    }
+
+private:
+    boost::asio::io_context ioc_;
+    boost::asio::ip::tcp::socket socket_;
+};
+
+// One frame of count records with ids first_id.. (carried in the volume)
+std::vector<char> ingest_frame(uint64_t seq, uint16_t count, int first_id) {
+    wire::FrameHeader header{};
+    header.type = static_cast<uint16_t>(count == 1 ? wire::FrameType::TICK : wire::FrameType::BATCH);
+    header.count = count;
+    header.length = count * sizeof(MarketData);
+    header.seq = seq;
+    std::vector<char> bytes(sizeof(header) + header.length);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    for (uint16_t i = 0; i < count; ++i) {
+        MarketData md{};
+        std::strncpy(md.symbol, "TEST_INGEST", sizeof(md.symbol) - 1);
+        md.price = 10.0;
+        md.volume = first_id + i;
+        md.seq = seq + i;
+        md.timestamp = REPLAY_BASE_NS;
+        std::memcpy(bytes.data() + sizeof(header) + i * sizeof(MarketData), &md, sizeof(md));
+    }
+    return bytes;
+}
+
+// Bus plus a gateway on an ephemeral loopback port
+struct IngestFixture {
+    ReplayBus replay_bus;
+    IngestGateway gateway{replay_bus.bus, "127.0.0.1", 0};
+
+    IngestFixture() { gateway.start(); }
+    ~IngestFixture() { gateway.stop(); }
+
+    // Ids of the next count records on the ring
+    std::vector<int> consume(size_t count) {
+        TickIdVisitor visitor;
+        std::atomic<bool> should_continue{true};
+        auto stop_at_count = [&](const WireRecord& record, const TickBody& body, const PipelineStamps& stamps) {
+            visitor(record, body, stamps);
+            if (visitor.ids.size() == count) {
+                should_continue = false;
+            }
+        };
+        replay_bus.bus->process_messages(should_continue, stop_at_count);
+        return visitor.ids;
+    }
+};
+
+} // namespace
+
+TEST(IngestGatewayTest, ParsesFramesSplitAcrossReads) {
+    IngestFixture fixture;
+    IngestClient client(fixture.gateway.port());
+    ASSERT_TRUE(client.read_credit());
+
+    // Two ticks and a batch, written a few bytes at a time so headers and
+    // payloads both straddle reads
+    std::vector<char> bytes = ingest_frame(0, 1, 0);
+    for (const auto& frame : {ingest_frame(1, 1, 1), ingest_frame(2, 5, 2)}) {
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+    }
+    client.send(bytes, 7);
+    ASSERT_TRUE(wait_for([&] { return fixture.gateway.get_received_count() == 7; }));
+    ASSERT_TRUE(wait_for([&] { return fixture.replay_bus.bus->get_published_count() == 7; }));
+    EXPECT_EQ(fixture.consume(7), (std::vector<int>{0, 1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(fixture.gateway.get_sequence_gaps(), 0u);
+    EXPECT_EQ(fixture.gateway.get_over_credit_count(), 0u);
+}
+
+TEST(IngestGatewayTest, GrantsShareTheFreeRing) {
+    IngestFixture fixture;
+    const uint64_t max_window = fixture.gateway.max_window();
+    const uint64_t capacity = fixture.replay_bus.bus->get_capacity();
+    // Leave less free room than one full window
+    const uint64_t free_slots = max_window / 2;
+    MarketData md{};
+    std::strncpy(md.symbol, "TEST_INGEST", sizeof(md.symbol) - 1);
+    for (uint64_t i = 0; i < capacity - free_slots; ++i) {
+        ASSERT_TRUE(fixture.replay_bus.bus->publish(md));
+    }
+
+    // The first producer gets all of it, the second nothing until the ring drains
+    IngestClient first(fixture.gateway.port());
+    const auto first_grant = first.read_credit();
+    ASSERT_TRUE(first_grant);
+    EXPECT_EQ(first_grant->credit_limit, free_slots);
+    IngestClient second(fixture.gateway.port());
+    ASSERT_TRUE(wait_for([&] { return fixture.gateway.get_connection_count() == 2; }));
+    EXPECT_EQ(fixture.gateway.available_window(), 0u);
+    EXPECT_FALSE(second.read_credit(std::chrono::milliseconds(50)));
+
+    // Drained, the second is granted at most a window out of its half of the unpromised slots
+    fixture.consume(capacity - free_slots);
+    const auto second_grant = second.read_credit();
+    ASSERT_TRUE(second_grant);
+    EXPECT_EQ(second_grant->credit_limit, std::min(max_window, (capacity - free_slots) / 2));
+}
+
+TEST(IngestGatewayTest, DropsRecordsBeyondTheCreditLimit) {
+    IngestFixture fixture;
+    IngestClient client(fixture.gateway.port());
+    const auto grant = client.read_credit();
+    ASSERT_TRUE(grant);
+
+    // Nothing consumes, so no grant can exceed the ring; overrun it on purpose
+    const uint64_t capacity = fixture.replay_bus.bus->get_capacity();
+    const uint64_t sent = capacity + 100;
+    for (uint64_t seq = 0; seq < sent; seq += 100) {
+        const auto count = static_cast<uint16_t>(std::min<uint64_t>(100, sent - seq));
+        client.send(ingest_frame(seq, count, static_cast<int>(seq)));
+    }
+    ASSERT_TRUE(wait_for([&] { return fixture.gateway.get_received_count() == sent; }));
+    const uint64_t published = fixture.replay_bus.bus->get_published_count();
+    EXPECT_LE(published, capacity);
+    EXPECT_GE(fixture.gateway.get_over_credit_count(), 100u);
+    EXPECT_EQ(published + fixture.gateway.get_over_credit_count(), sent);
+    // Credited records always fit, so the ring itself dropped nothing
+    EXPECT_EQ(fixture.replay_bus.bus->get_dropped_count(), 0u);
+    EXPECT_EQ(fixture.gateway.get_sequence_gaps(), 0u);
+}
+
+TEST(IngestGatewayTest, CountsSequenceGaps) {
+    IngestFixture fixture;
+    IngestClient client(fixture.gateway.port());
+    ASSERT_TRUE(client.read_credit());
+
+    // The first frame sets the start; 3 follows 1 + 1, 10 skips 8..9, and 4 goes backwards
+    for (const auto& [seq, count] : std::vector<std::pair<uint64_t, uint16_t>>{
+             {1, 1}, {2, 1}, {3, 5}, {10, 1}, {11, 2}, {4, 1}}) {
+        client.send(ingest_frame(seq, count, 0));
+    }
+    ASSERT_TRUE(wait_for([&] { return fixture.gateway.get_received_count() == 11; }));
+    EXPECT_EQ(fixture.gateway.get_sequence_gaps(), 2u);
+}
+
+namespace {
+
+void feed_text(NdjsonIngestor& ingestor, const std::string& text) {
+    ingestor.feed(text.data(), text.size());
+}
+
+} // namespace
+
+TEST(NdjsonIngestorTest, JoinsLinesSplitAcrossFeeds) {
+    ReplayBus replay_bus;
+    NdjsonIngestor ingestor(replay_bus.bus);
+    const std::string line = ndjson_row("TEST_NDJ", 1.5, 0, 1700000000000) + ndjson_row("TEST_NDJ", 1.5, 1, 1700000000001);
+    // Every split point, including inside the newline pair between the rows
+    for (size_t split = 0; split <= line.size(); ++split) {
+        feed_text(ingestor, line.substr(0, split));
+        feed_text(ingestor, line.substr(split));
+    }
+    ingestor.finish();
+    EXPECT_EQ(ingestor.rejected(), 0u) << ingestor.first_error();
+    EXPECT_EQ(ingestor.accepted(), 2 * (line.size() + 1));
+}
+
+TEST(NdjsonIngestorTest, ToleratesCrlfAndBlankLines) {
+    ReplayBus replay_bus;
+    NdjsonIngestor ingestor(replay_bus.bus);
+    std::string row = ndjson_row("TEST_NDJ", 1.5, 0, 1700000000000);
+    row.insert(row.size() - 1, "\r");
+    feed_text(ingestor, "\n\r\n" + row + " \t\r\n\n" + row);
+    ingestor.finish();
+    EXPECT_EQ(ingestor.rejected(), 0u) << ingestor.first_error();
+    EXPECT_EQ(ingestor.accepted(), 2u);
+}
+
+TEST(NdjsonIngestorTest, CountsAnOversizedLineOnce) {
+    ReplayBus replay_bus;
+    NdjsonIngestor ingestor(replay_bus.bus);
+    // Several chunks past the limit before the newline ends the line
+    const std::string chunk(4096, 'x');
+    for (size_t fed = 0; fed < 4 * NdjsonIngestor::MAX_LINE_LENGTH; fed += chunk.size()) {
+        feed_text(ingestor, chunk);
+    }
+    feed_text(ingestor, "x\n" + ndjson_row("TEST_NDJ", 1.5, 0, 1700000000000));
+    ingestor.finish();
+    EXPECT_EQ(ingestor.rejected(), 1u);
+    EXPECT_EQ(ingestor.first_error(), "line exceeds maximum length");
+    EXPECT_EQ(ingestor.accepted(), 1u);
+}
+
+TEST(NdjsonIngestorTest, FinishParsesAnUnterminatedLastLine) {
+    ReplayBus replay_bus;
+    NdjsonIngestor ingestor(replay_bus.bus);
+    std::string row = ndjson_row("TEST_NDJ", 1.5, 0, 1700000000000);
+    row.pop_back();
+    feed_text(ingestor, row);
+    EXPECT_EQ(replay_bus.bus->get_published_count(), 0u);
+    ingestor.finish();
+    EXPECT_EQ(ingestor.accepted(), 1u);
+    EXPECT_EQ(replay_bus.bus->get_published_count(), 1u);
+}
+
+TEST(NdjsonIngestorTest, ReportsAcceptedAndDroppedPerBatch) {
+    ReplayBus replay_bus;
+    const size_t capacity = replay_bus.bus->get_capacity();
+    MarketData md{};
+    std::strncpy(md.symbol, "TEST_NDJ", sizeof(md.symbol) - 1);
+    // Leave room for one full batch and half of the next
+    for (size_t i = 0; i < capacity - 6; ++i) {
+        ASSERT_TRUE(replay_bus.bus->publish(md));
+    }
+
+    NdjsonIngestor ingestor(replay_bus.bus, "market_data", 4);
+    for (int i = 0; i < 10; ++i) {
+        feed_text(ingestor, ndjson_row("TEST_NDJ", 1.5, i, 1700000000000 + i));
+    }
+    ingestor.finish();
+    ASSERT_EQ(ingestor.batches().size(), 3u);
+    EXPECT_EQ(ingestor.batches()[0].accepted, 4u);
+    EXPECT_EQ(ingestor.batches()[0].dropped, 0u);
+    EXPECT_EQ(ingestor.batches()[1].accepted, 2u);
+    EXPECT_EQ(ingestor.batches()[1].dropped, 2u);
+    EXPECT_EQ(ingestor.batches()[2].accepted, 0u);
+    EXPECT_EQ(ingestor.batches()[2].dropped, 2u);
+    EXPECT_EQ(ingestor.accepted(), 6u);
+    EXPECT_EQ(ingestor.dropped(), 4u);
+}
+
+namespace {
+
+// Records the seq of every event delivered to it
+struct SeqSubscriber : StreamSubscriber {
+    std::vector<uint64_t> seqs;
+
+    void deliver(const StreamEventPtr& event) override { seqs.push_back(event->seq); }
+};
+
+std::vector<uint64_t> event_seqs(const std::vector<StreamEventPtr>& events) {
+    std::vector<uint64_t> seqs;
+    for (const auto& event : events) {
+        seqs.push_back(event->seq);
+    }
+    return seqs;
+}
+
+void broadcast_seqs(StreamHub& hub, uint64_t first, uint64_t last) {
+    for (uint64_t seq = first; seq <= last; ++seq) {
+        hub.broadcast(StreamHub::make_event(seq, "{}"));
+    }
+}
+
+} // namespace
+
+TEST(StreamHubTest, ResumesAfterLastEventId) {
+    StreamHub hub(16);
+    broadcast_seqs(hub, 1, 5);
+    auto resumed = std::make_shared<SeqSubscriber>();
+    EXPECT_EQ(event_seqs(hub.add(resumed, 3)), (std::vector<uint64_t>{4, 5}));
+    EXPECT_EQ(event_seqs(hub.add(std::make_shared<SeqSubscriber>(), 5)), std::vector<uint64_t>{});
+    // No Last-Event-ID: live events only
+    auto fresh = std::make_shared<SeqSubscriber>();
+    EXPECT_TRUE(hub.add(fresh).empty());
+
+    broadcast_seqs(hub, 6, 6);
+    EXPECT_EQ(resumed->seqs, std::vector<uint64_t>{6});
+    EXPECT_EQ(fresh->seqs, std::vector<uint64_t>{6});
+}
+
+TEST(StreamHubTest, KeepsOnlyTheLatestHistory) {
+    StreamHub hub(3);
+    broadcast_seqs(hub, 1, 10);
+    EXPECT_EQ(event_seqs(hub.add(std::make_shared<SeqSubscriber>(), 0)), (std::vector<uint64_t>{8, 9, 10}));
+
+    StreamHub no_history(0);
+    broadcast_seqs(no_history, 1, 3);
+    EXPECT_TRUE(no_history.add(std::make_shared<SeqSubscriber>(), 0).empty());
+}
+
+TEST(StreamHubTest, SeqZeroEventsAreLiveOnly) {
+    StreamHub hub(16);
+    auto live = std::make_shared<SeqSubscriber>();
+    hub.add(live);
+    broadcast_seqs(hub, 1, 2);
+    hub.broadcast(StreamHub::make_event(0, "{}", "stats"));
+    broadcast_seqs(hub, 3, 3);
+
+    EXPECT_EQ(live->seqs, (std::vector<uint64_t>{1, 2, 0, 3}));
+    EXPECT_EQ(event_seqs(hub.add(std::make_shared<SeqSubscriber>(), 0)), (std::vector<uint64_t>{1, 2, 3}));
+    // Not resumable, so no SSE id line that would overwrite the client's Last-Event-ID
+    EXPECT_EQ(StreamHub::make_event(0, "{}", "stats")->sse, "event: stats\ndata: {}\n\n");
+}
+
+TEST(StreamHubTest, PrunesExpiredSubscribers) {
+    StreamHub hub;
+    auto kept = std::make_shared<SeqSubscriber>();
+    auto gone = std::make_shared<SeqSubscriber>();
+    hub.add(gone);
+    hub.add(kept);
+    EXPECT_EQ(hub.subscriber_count(), 2u);
+
+    gone.reset();
+    broadcast_seqs(hub, 1, 1);
+    EXPECT_EQ(hub.subscriber_count(), 1u);
+    EXPECT_EQ(kept->seqs, std::vector<uint64_t>{1});
+}
+
+TEST(QueryStringTest, MatchesWholeKeys) {
+    EXPECT_EQ(query_param("/stream?last_event_id=42", "last_event_id"), "42");
+    EXPECT_EQ(query_param("/stream?x_last_event_id=1&last_event_id=7", "last_event_id"), "7");
+    EXPECT_EQ(query_param("/stream?a=1&last_event_id=&b=2", "last_event_id"), "");
+    EXPECT_EQ(query_param("/stream?last_event_id", "last_event_id"), "");
+    EXPECT_EQ(query_param("/stream?last_event_id_x=3", "last_event_id"), std::nullopt);
+    EXPECT_EQ(query_param("/stream?a=1#last_event_id=3", "last_event_id"), std::nullopt);
+    EXPECT_EQ(query_param("/stream", "last_event_id"), std::nullopt);
+    EXPECT_EQ(query_param("/api/ingest?batch=512", "batch"), "512");
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
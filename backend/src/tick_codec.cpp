@@ -0,0 +1,132 @@
+#include "tick_codec.hpp"
+
+namespace lockfree {
+
+namespace {
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline uint8_t* put_varint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+// Returns nullptr on truncation or an over-long encoding
+inline const uint8_t* get_varint(const uint8_t* in, const uint8_t* end, uint64_t& value) {
+    // Fast path: one-byte values dominate every stream
+    if (in < end && *in < 0x80) {
+        value = *in;
+        return in + 1;
+    }
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && in < end; shift += 7) {
+        const uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+void encode_tick_block(const TickColumns& columns, std::vector<uint8_t>& out) {
+    const std::size_t rows = columns.rows;
+    const std::size_t start = out.size();
+    out.resize(start + max_encoded_tick_block(rows));
+    uint8_t* p = out.data() + start;
+
+    uint16_t max_id = 0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        p = put_varint(p, columns.symbol_ids[i]);
+        max_id = columns.symbol_ids[i] > max_id ? columns.symbol_ids[i] : max_id;
+    }
+
+    int64_t previous = 0;
+    int64_t previous_delta = 0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        const int64_t ts = columns.timestamps_ns[i];
+        const int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(ts) - static_cast<uint64_t>(previous));
+        const int64_t delta_of_delta =
+            static_cast<int64_t>(static_cast<uint64_t>(delta) - static_cast<uint64_t>(previous_delta));
+        p = put_varint(p, zigzag(i == 0 ? ts : i == 1 ? delta : delta_of_delta));
+        previous = ts;
+        previous_delta = delta;
+    }
+
+    std::vector<int64_t> last_price(static_cast<std::size_t>(max_id) + 1, 0);
+    for (std::size_t i = 0; i < rows; ++i) {
+        int64_t& last = last_price[columns.symbol_ids[i]];
+        p = put_varint(p, zigzag(static_cast<int64_t>(static_cast<uint64_t>(columns.prices[i]) -
+                                                     static_cast<uint64_t>(last))));
+        last = columns.prices[i];
+    }
+
+    for (std::size_t i = 0; i < rows; ++i) {
+        p = put_varint(p, zigzag(columns.volumes[i]));
+    }
+    out.resize(static_cast<std::size_t>(p - out.data()));
+}
+
+bool decode_tick_block(const uint8_t* data, std::size_t size, std::size_t rows,
+                       int64_t* timestamps_ns, int64_t* prices, int64_t* volumes, uint16_t* symbol_ids) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    uint64_t value;
+
+    uint16_t max_id = 0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (!(p = get_varint(p, end, value)) || value > UINT16_MAX) {
+            return false;
+        }
+        symbol_ids[i] = static_cast<uint16_t>(value);
+        max_id = symbol_ids[i] > max_id ? symbol_ids[i] : max_id;
+    }
+
+    uint64_t previous = 0;
+    uint64_t delta = 0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (!(p = get_varint(p, end, value))) {
+            return false;
+        }
+        const uint64_t v = static_cast<uint64_t>(unzigzag(value));
+        if (i == 0) {
+            previous = v;
+        } else {
+            delta = i == 1 ? v : delta + v;
+            previous += delta;
+        }
+        timestamps_ns[i] = static_cast<int64_t>(previous);
+    }
+
+    std::vector<uint64_t> last_price(static_cast<std::size_t>(max_id) + 1, 0);
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (!(p = get_varint(p, end, value))) {
+            return false;
+        }
+        uint64_t& last = last_price[symbol_ids[i]];
+        last += static_cast<uint64_t>(unzigzag(value));
+        prices[i] = static_cast<int64_t>(last);
+    }
+
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (!(p = get_varint(p, end, value))) {
+            return false;
+        }
+        volumes[i] = unzigzag(value);
+    }
+    return p == end;
+}
+
+} // namespace lockfree
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lockfree {
+
+// Block codec for tick columns, shared by the replay tick file and captures.
+//
+// A block of n rows encodes as four varint streams, back to back:
+//   symbol ids   unsigned varint
+//   timestamps   first value, then first delta, then delta-of-delta (zigzag)
+//   prices       delta from the previous price of the same symbol (zigzag)
+//   volumes      zigzag varint
+//
+// Prices are fixed-point ticks, so consecutive prices differ by a few ticks
+// and their deltas take one or two bytes; ticks arriving at a steady rate
+// make most timestamp delta-of-deltas zero (one byte). The row count is not
+// stored; callers keep it alongside the block.
+struct TickColumns {
+    const int64_t* timestamps_ns;
+    const int64_t* prices;
+    const int64_t* volumes;
+    const uint16_t* symbol_ids;
+    std::size_t rows;
+};
+
+// Append the encoded block to out
+void encode_tick_block(const TickColumns& columns, std::vector<uint8_t>& out);
+
+// Decode rows rows from [data, data + size) into the output columns. Returns
+// false if the block is truncated or malformed.
+bool decode_tick_block(const uint8_t* data, std::size_t size, std::size_t rows,
+                       int64_t* timestamps_ns, int64_t* prices, int64_t* volumes, uint16_t* symbol_ids);
+
+// Worst-case encoded size of a block, for sizing buffers
+constexpr std::size_t max_encoded_tick_block(std::size_t rows) {
+    return rows * (3 + 3 * 10);
+}
+
+} // namespace lockfree
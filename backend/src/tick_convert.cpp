@@ -0,0 +1,84 @@
+// Converts JSON/NDJSON tick files (the ReplayEngine text formats) into the
+// binary columnar tick file that replay maps directly:
+//
+//   ./tick_convert ticks.ndjson ticks.bin [--block-rows N] [--raw]
+//
+// Blocks are compressed (see tick_codec.hpp) unless --raw is given.
+// Prices are stored in each symbol's InstrumentTable scale; set PRICE_DECIMALS
+// the same way as for the server.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "market_data/tick_file.hpp"
+#include "market_data/tick_loader.hpp"
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: tick_convert INPUT.{json,ndjson} OUTPUT [--block-rows N] [--raw]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    const std::string input = argv[1];
+    const std::string output = argv[2];
+    uint32_t block_rows = market_data::tick_file::DEFAULT_BLOCK_ROWS;
+    auto encoding = market_data::tick_file::BlockEncoding::COMPRESSED;
+    for (int i = 3; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--block-rows" && i + 1 < argc) {
+            block_rows = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--raw") {
+            encoding = market_data::tick_file::BlockEncoding::RAW;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (const char* price_decimals = std::getenv("PRICE_DECIMALS")) {
+        if (!lockfree::InstrumentTable::instance().configure(price_decimals)) {
+            std::cerr << "Ignoring malformed PRICE_DECIMALS entries: " << price_decimals << "\n";
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<market_data::TickFileWriter> writer;
+    try {
+        writer = std::make_unique<market_data::TickFileWriter>(output, block_rows, encoding);
+        const auto result = market_data::TickLoader::load(input, [&writer](market_data::NormalizedMarketData& row) {
+            writer->add(row);
+            return true;
+        });
+        if (!result.ok) {
+            // No truncated file that would pass for a complete one
+            writer->discard();
+            std::cerr << "tick_convert: " << result.error << "\n";
+            return 1;
+        }
+        writer->finish();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "converted " << writer->rows_written() << " rows in " << seconds << " s";
+        if (result.rejected > 0) {
+            std::cout << " (skipped " << result.rejected << ", first: " << result.error << ")";
+        }
+        if (!writer->sorted()) {
+            std::cout << " (not in timestamp order: replays in file order, seeks scan)";
+        }
+        std::cout << "\n";
+    } catch (const std::exception& e) {
+        if (writer) {
+            writer->discard();
+        }
+        std::cerr << "tick_convert: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "wire_record.hpp"
+#include "logger.hpp"
+
+namespace lockfree {
+
+SourceRegistry& SourceRegistry::instance() {
+    static SourceRegistry registry;
+    return registry;
+}
+
+uint8_t SourceRegistry::intern(const char* name) {
+    if (name == nullptr || name[0] == '\0') {
+        return 0;
+    }
+    // Fast path: a handful of feeds, so a linear scan beats hashing
+    std::size_t count = count_.load(std::memory_order_acquire);
+    for (std::size_t id = 1; id < count; ++id) {
+        if (std::strncmp(names_[id], name, NAME_SIZE - 1) == 0) {
+            return static_cast<uint8_t>(id);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    count = count_.load(std::memory_order_relaxed);
+    for (std::size_t id = 1; id < count; ++id) {
+        if (std::strncmp(names_[id], name, NAME_SIZE - 1) == 0) {
+            return static_cast<uint8_t>(id);
+        }
+    }
+    if (count >= MAX_SOURCES) {
+        if (overflow_count_.fetch_add(1, std::memory_order_relaxed) == 0) {
+            LOG_WARN("[SourceRegistry] more than " << MAX_SOURCES - 1 << " sources; '" << name
+                     << "' and later new sources are sent as the empty source");
+        }
+        return 0;
+    }
+    std::strncpy(names_[count], name, NAME_SIZE - 1);
+    names_[count][NAME_SIZE - 1] = '\0';
+    count_.store(count + 1, std::memory_order_release);
+    return static_cast<uint8_t>(count);
+}
+
+} // namespace lockfree
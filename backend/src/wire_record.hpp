@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include "messages.hpp"
+#include "price.hpp"
+#include "ring_buffer.hpp"
+#include "symbol_registry.hpp"
+
+namespace lockfree {
+
+// Edge representation of a tick, as produced by the HTTP/NDJSON/gateway
+// ingest paths and consumed by subscribers.
+struct MarketData {
+    char symbol[16];
+    double price;
+    double volume;
+    uint64_t seq;     // Monotonic sequence id
+    int64_t timestamp;  // Store as int64_t instead of time_point
+    char source[32];    // Fixed-size array instead of std::string
+};
+
+// Interns feed source names to 8-bit ids so records carry an id instead of a
+// 32-byte string. Lookups are lock-free; only the first sighting of a new name
+// takes the mutex. Id 0 is the empty source and also absorbs overflow.
+//
+// Unlike SymbolRegistry the table is process-local: a source_id only means
+// something inside the process that wrote the record. Other processes attached
+// to the ring resolve symbols through SymbolRegistry::attach() but have no
+// source names.
+class SourceRegistry {
+public:
+    static constexpr std::size_t MAX_SOURCES = 256;
+    static constexpr std::size_t NAME_SIZE = sizeof(MarketData::source);
+
+    static SourceRegistry& instance();
+
+    uint8_t intern(const char* name);
+    const char* name(uint8_t id) const {
+        return id < count_.load(std::memory_order_acquire) ? names_[id] : names_[0];
+    }
+    std::size_t size() const { return count_.load(std::memory_order_acquire); }
+    // Interns of new names that found the table full and got id 0
+    uint64_t overflow_count() const { return overflow_count_.load(std::memory_order_relaxed); }
+
+private:
+    SourceRegistry() { names_[0][0] = '\0'; }
+
+    std::mutex mutex_;
+    std::atomic<std::size_t> count_{1};
+    std::atomic<uint64_t> overflow_count_{0};
+    char names_[MAX_SOURCES][NAME_SIZE] = {};
+};
+
+// Ring buffer record: one cache line per message, a 32-byte header followed by
+// the 32-byte body of its MessageType.
+//
+//   seq | timestamp_ns | ring_write_ns | ingest_delta_ns | symbol_id | source_id | type | body
+//
+// The symbol is a SymbolRegistry id (which also holds the symbol's price
+// scale), the timestamp is nanoseconds since the epoch, and the ingest stamp is
+// stored as a saturating offset from the ring write stamp.
+struct alignas(CACHE_LINE_SIZE) WireRecord {
+    static constexpr int64_t VOLUME_SCALE = 1000000;   // 1e-6 volume units
+
+    uint64_t seq;
+    int64_t timestamp_ns;
+    int64_t ring_write_ns;     // monotonic_ns() when written to the ring
+    uint32_t ingest_delta_ns;  // ring_write_ns - ingest stamp, saturated at UINT32_MAX
+    uint16_t symbol_id;        // SymbolRegistry id
+    uint8_t source_id;         // SourceRegistry id, meaningful only in the writing process
+    MessageType type;
+    union {
+        TickBody tick;
+        Trade trade;
+        Quote quote;
+        BookDelta book_delta;
+        Heartbeat heartbeat;
+        Status status;
+    };
+
+    template<typename Body>
+    const Body& body() const { return member<Body>(*this); }
+
+    template<typename Body>
+    void set_body(const Body& value) {
+        type = Body::TYPE;
+        member<Body>(*this) = value;
+    }
+
+    uint8_t price_decimals() const {
+        return symbol_id != SymbolRegistry::INVALID_ID
+            ? SymbolRegistry::instance().price_decimals(symbol_id)
+            : InstrumentTable::instance().default_decimals();
+    }
+
+    // A body price field in the symbol's scale
+    FixedPrice fixed_price(int64_t ticks) const { return FixedPrice(ticks, price_decimals()); }
+
+    int64_t ingest_ns() const { return ring_write_ns - static_cast<int64_t>(ingest_delta_ns); }
+
+    void set_ingest_ns(int64_t ingest_ns) {
+        const int64_t delta = ring_write_ns - ingest_ns;
+        ingest_delta_ns = delta <= 0 ? 0u
+            : delta >= static_cast<int64_t>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(delta);
+    }
+
+private:
+    template<typename Body, typename Record>
+    static auto& member(Record& record) {
+        static_assert(is_message_body_v<Body>, "not a message body");
+        if constexpr (std::is_same_v<Body, TickBody>) return record.tick;
+        else if constexpr (std::is_same_v<Body, Trade>) return record.trade;
+        else if constexpr (std::is_same_v<Body, Quote>) return record.quote;
+        else if constexpr (std::is_same_v<Body, BookDelta>) return record.book_delta;
+        else if constexpr (std::is_same_v<Body, Heartbeat>) return record.heartbeat;
+        else return record.status;
+    }
+};
+
+static_assert(sizeof(WireRecord) == CACHE_LINE_SIZE, "WireRecord must fill exactly one cache line");
+static_assert(offsetof(WireRecord, tick) == 32, "WireRecord header must be 32 bytes");
+static_assert(SymbolRegistry::MAX_SYMBOLS <= UINT16_MAX, "symbol ids must fit WireRecord::symbol_id");
+static_assert(SourceRegistry::MAX_SOURCES <= UINT8_MAX + 1, "source ids must fit WireRecord::source_id");
+
+inline int64_t to_fixed(double value, int64_t scale) {
+    return std::llround(value * static_cast<double>(scale));
+}
+
+inline double from_fixed(int64_t value, int64_t scale) {
+    return static_cast<double>(value) / static_cast<double>(scale);
+}
+
+// Fill the symbol, source and timestamp of a record; seq and the pipeline
+// stamps are filled in by the bus. Follow with set_body().
+inline void set_header(WireRecord& record, const char* symbol, const char* source, int64_t timestamp_ns) {
+    record.symbol_id = static_cast<uint16_t>(SymbolRegistry::instance().intern(symbol));
+    record.source_id = SourceRegistry::instance().intern(source);
+    record.timestamp_ns = timestamp_ns;
+}
+
+// Ticks for a price in the scale of the record's symbol (call after set_header)
+inline int64_t encode_price(const WireRecord& record, double price) {
+    return FixedPrice::from_double(price, record.price_decimals()).ticks();
+}
+
+// Encode the edge representation; seq and the pipeline stamps are filled in by the bus
+inline void to_wire(const MarketData& data, WireRecord& record) {
+    set_header(record, data.symbol, data.source, data.timestamp * 1000000);
+    record.seq = data.seq;
+    record.set_body(TickBody{encode_price(record, data.price), to_fixed(data.volume, WireRecord::VOLUME_SCALE)});
+}
+
+inline void from_wire(const WireRecord& record, MarketData& data) {
+    std::strncpy(data.symbol, SymbolRegistry::instance().name(record.symbol_id), sizeof(data.symbol) - 1);
+    data.symbol[sizeof(data.symbol) - 1] = '\0';
+    data.price = record.fixed_price(record.tick.price).to_double();
+    data.volume = from_fixed(record.tick.volume, WireRecord::VOLUME_SCALE);
+    data.seq = record.seq;
+    data.timestamp = record.timestamp_ns / 1000000;
+    std::strncpy(data.source, SourceRegistry::instance().name(record.source_id), sizeof(data.source) - 1);
+    data.source[sizeof(data.source) - 1] = '\0';
+}
+
+namespace detail {
+
+template<typename Visitor, typename Body, typename... Args>
+inline bool visit_body(const WireRecord& record, Visitor& visitor, Args&... args) {
+    if constexpr (std::is_invocable_v<Visitor&, const WireRecord&, const Body&, Args&...>) {
+        visitor(record, record.body<Body>(), args...);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+} // namespace detail
+
+// Call visitor(record, body, args...) with the body typed by record.type. The
+// overload is picked at compile time; kinds the visitor has no overload for are
+// skipped and reported by returning false.
+template<typename Visitor, typename... Args>
+inline bool visit(const WireRecord& record, Visitor& visitor, Args&... args) {
+    switch (record.type) {
+        case MessageType::MARKET_DATA: return detail::visit_body<Visitor, TickBody>(record, visitor, args...);
+        case MessageType::TRADE: return detail::visit_body<Visitor, Trade>(record, visitor, args...);
+        case MessageType::QUOTE: return detail::visit_body<Visitor, Quote>(record, visitor, args...);
+        case MessageType::BOOK_DELTA: return detail::visit_body<Visitor, BookDelta>(record, visitor, args...);
+        case MessageType::HEARTBEAT: return detail::visit_body<Visitor, Heartbeat>(record, visitor, args...);
+        case MessageType::STATUS: return detail::visit_body<Visitor, Status>(record, visitor, args...);
+    }
+    return false;
+}
+
+} // namespace lockfree
@@ -11,6 +11,7 @@ function App() {
   const [submitting, setSubmitting] = useState(false);
   const ws = useRef(null);
   const lastMsgKeyRef = useRef('');
+  const lastStatsPushRef = useRef(0); // Date.now() of the last stats frame from the server
 
   // Hydrate messages from localStorage on initial load
   useEffect(() => {
@@ -84,7 +85,10 @@ function App() {
         ws.current.onmessage = (event) => {
           try {
             const data = JSON.parse(event.data);
-            if (data.type === 'market_data') {
+            if (data.type === 'stats') {
+              lastStatsPushRef.current = Date.now();
+              applyStats(data);
+            } else if (data.type === 'market_data') {
               const key = String(data.seq || '')
                 || `${data.symbol}|${data.price}|${data.volume}|${data.timestamp}`;
               if (key !== lastMsgKeyRef.current) {
@@ -141,12 +145,9 @@ function App() {
     // Initial connection
     connectWebSocket();
 
-    // Fetch initial stats
+    // Fetch initial stats; afterwards the server pushes them over the WebSocket
     fetchStats();
 
-    // Set up stats polling
-    const statsInterval = setInterval(fetchStats, config.POLL_INTERVAL);
-
     return () => {
       if (reconnectTimeout) {
         clearTimeout(reconnectTimeout);
@@ -154,21 +155,35 @@ function App() {
       if (ws.current) {
         ws.current.close(1000, 'Component unmounting');
       }
-      clearInterval(statsInterval);
     };
   }, []);
 
+  // Fall back to polling /api/stats whenever no stats frame has arrived
+  // recently: the WebSocket is down, or the server pushes none (STATS_INTERVAL_MS=0)
+  useEffect(() => {
+    const statsInterval = setInterval(() => {
+      if (Date.now() - lastStatsPushRef.current > config.STATS_PUSH_TIMEOUT) {
+        fetchStats();
+      }
+    }, config.POLL_INTERVAL);
+    return () => clearInterval(statsInterval);
+  }, []);
+
+  const applyStats = (data) => {
+    setStats(data);
+    setHistory(prev => {
+      const next = [...prev, data.buffer_size ?? 0].slice(-config.HISTORY_POINTS);
+      return next;
+    });
+  };
+
   const fetchStats = async () => {
     if (fetchStats.inFlight) return;
     fetchStats.inFlight = true;
     try {
       const response = await fetch(`${config.API_URL}/stats`);
       const data = await response.json();
-      setStats(data);
-      setHistory(prev => {
-        const next = [...prev, data.buffer_size ?? 0].slice(-config.HISTORY_POINTS);
-        return next;
-      });
+      applyStats(data);
     } catch (error) {
       console.error('Error fetching stats:', error);
     } finally {
@@ -24,8 +24,12 @@ const config = {
     // HTTP API server URL
     API_URL: RESOLVED_API,
     
-    // Stats polling interval in milliseconds
+    // Stats polling interval in milliseconds (only used while no stats frames
+    // arrive over the WebSocket; otherwise the server pushes them)
     POLL_INTERVAL: 250,
+
+    // Poll once no stats frame has arrived for this many milliseconds
+    STATS_PUSH_TIMEOUT: 1000,
     
     // Maximum number of messages to display
     MAX_MESSAGES: 100,